@@ -16,7 +16,9 @@
 
 #include "openconfig_interfaces.h"
 #include "sys_util.h"
+#include "sys_request.h"
 #include "sc_vpp_operation.h"
+#include "../sc_interface.h"
 
 #include "../bapi/bapi.h"
 #include "../bapi/bapi_interface.h"
@@ -24,6 +26,7 @@
 
 #include <assert.h>
 #include <string.h>
+#include <arpa/inet.h>
 #include <sysrepo/xpath.h>
 #include <sysrepo/values.h>
 
@@ -61,8 +64,9 @@ int openconfig_interfaces_interfaces_interface_config_cb(
     sr_change_oper_t oper;
     sr_val_t *old_val = NULL;
     sr_val_t *new_val = NULL;
-    char *tmp = NULL;
-    char interface_name[XPATH_SIZE] = {0};
+    sys_xpath_keys_t keys;
+    const sys_xpath_key_t *name = NULL;
+    char interface_name[VPP_INTFC_NAME_LEN] = {0};
     int rc = 0;
 
     ARG_CHECK2(SR_ERR_INVAL_ARG, ds, xpath);
@@ -101,19 +105,21 @@ int openconfig_interfaces_interfaces_interface_config_cb(
 
         log_recv_oper(oper, "subtree_change_cb received");
 
-        SRP_LOG_DBG("xpath: %s", new_val->xpath);
+        /* there is no new value of a deleted leaf */
+        const char *change_xpath = (NULL != new_val) ? new_val->xpath :
+                                                       old_val->xpath;
+        SRP_LOG_DBG("xpath: %s", change_xpath);
 
-        sr_xpath_ctx_t state = {0};
-
-        tmp = xpath_find_first_key(new_val->xpath, "name", &state);
-        if (NULL == tmp) {
+        /* the binary API wants the name as a C string */
+        if (0 != xpath_keys_parse(change_xpath, &keys) ||
+            NULL == (name = xpath_keys_find(&keys, "name")) ||
+            0 != xpath_key_copy(name, interface_name, sizeof(interface_name))) {
             SRP_LOG_DBG_MSG("interface_name NOT found.");
+            sr_free_val(old_val);
+            sr_free_val(new_val);
             continue;
         }
 
-        strncpy(interface_name, tmp, XPATH_SIZE);
-        sr_xpath_recover(&state);
-
         switch (oper) {
             case SR_OP_CREATED:
                 if (sr_xpath_node_name_eq(new_val->xpath, "name")) {
@@ -185,8 +191,6 @@ int openconfig_interfaces_interfaces_interface_config_cb(
         }
 
         if (0 != rc) {
-            sr_xpath_recover(&state);
-
             sr_free_val(old_val);
             sr_free_val(new_val);
 
@@ -195,8 +199,6 @@ int openconfig_interfaces_interfaces_interface_config_cb(
             return SR_ERR_OPERATION_FAILED;
         }
 
-        sr_xpath_recover(&state);
-
         sr_free_val(old_val);
         sr_free_val(new_val);
     }
@@ -218,169 +220,147 @@ int openconfig_interface_mod_cb(
 
 typedef struct
 {
-    bool is_subif;
     u32 subinterface_index;
-    sw_interface_details_query_t sw_interface_details_query;
     sysr_values_ctx_t sysr_values_ctx;
 } sys_sw_interface_dump_ctx;
 
 #define NOT_AVAL "NA"
 
+#define OC_INTERFACE_STATE_LEAVES 10
+#define OC_SUBINTERFACE_STATE_LEAVES 6
+
 // XPATH: /openconfig-interfaces:interfaces/interface/state
 
 static int sw_interface_dump_cb_inner(
-    vapi_payload_sw_interface_details * reply,
+    const scVppIntfc *reply,
     sys_sw_interface_dump_ctx * dctx)
 {
-    sr_val_t *vals = NULL;
-    int rc = 0;
-    int vc = 0;
+    sc_vals_t *vals = NULL;
+    sr_val_t *val = NULL;
 
     ARG_CHECK2(SR_ERR_INVAL_ARG, reply, dctx);
 
-    vc = 10;
-
-    /* convenient functions such as this can be found in sysrepo/values.h */
-    rc = sr_new_values(vc, &vals);
-    if (SR_ERR_OK != rc) {
-        return rc;
+    vals = &dctx->sysr_values_ctx.vals;
+    if (SR_ERR_OK != sc_vals_entry(vals, "%s", dctx->sysr_values_ctx.xpath_root)) {
+        return vals->rc;
     }
 
-    const char* interface_name = (const char*)dctx->sw_interface_details_query.sw_interface_details.interface_name;
+    const char* interface_name = reply->interface_name;
 
-    sr_val_build_xpath(&vals[0], "%s/name", dctx->sysr_values_ctx.xpath_root);
-    sr_val_set_str_data(&vals[0], SR_STRING_T, interface_name);
+    sc_vals_leaf_str(vals, "name", SR_STRING_T,
+                     interface_name);
 
-    sr_val_build_xpath(&vals[1], "%s/type", dctx->sysr_values_ctx.xpath_root);
-    sr_val_set_str_data(&vals[1], SR_IDENTITYREF_T, "ianaift:ethernetCsmacd");
+    sc_vals_leaf_str(vals, "type", SR_IDENTITYREF_T,
+                     "ianaift:ethernetCsmacd");
 
-    sr_val_build_xpath(&vals[2], "%s/mtu", dctx->sysr_values_ctx.xpath_root);
-    vals[2].type = SR_UINT16_T;
-    vals[2].data.uint16_val = reply->link_mtu;
+    if (NULL != (val = sc_vals_leaf(vals, "mtu"))) {
+        val->type = SR_UINT16_T;
+        val->data.uint16_val = reply->link_mtu;
+    }
 
-    sr_val_build_xpath(&vals[3], "%s/loopback-mode",
-                       dctx->sysr_values_ctx.xpath_root);
-    vals[3].type = SR_BOOL_T;
-    vals[3].data.bool_val = (0 == strncmp(interface_name, "loop", 4)) ? 1 : 0;
+    if (NULL != (val = sc_vals_leaf(vals, "loopback-mode"))) {
+        val->type = SR_BOOL_T;
+        val->data.bool_val = (0 == strncmp(interface_name, "loop", 4)) ? 1 : 0;
+    }
 
-    sr_val_build_xpath(&vals[4], "%s/description",
-                       dctx->sysr_values_ctx.xpath_root);
-    sr_val_set_str_data(&vals[4], SR_STRING_T, NOT_AVAL);
+    sc_vals_leaf_str(vals, "description", SR_STRING_T,
+                     NOT_AVAL);
 
-    sr_val_build_xpath(&vals[5], "%s/enabled",
-                       dctx->sysr_values_ctx.xpath_root);
-    vals[5].type = SR_BOOL_T;
-    vals[5].data.bool_val = reply->admin_up_down;
+    if (NULL != (val = sc_vals_leaf(vals, "enabled"))) {
+        val->type = SR_BOOL_T;
+        val->data.bool_val = reply->admin_up_down;
+    }
 
-    sr_val_build_xpath(&vals[6], "%s/ifindex",
-                       dctx->sysr_values_ctx.xpath_root);
-    vals[6].type = SR_UINT32_T;
-    vals[6].data.uint32_val = reply->sw_if_index;
+    if (NULL != (val = sc_vals_leaf(vals, "ifindex"))) {
+        val->type = SR_UINT32_T;
+        val->data.uint32_val = reply->sw_if_index;
+    }
 
-    sr_val_build_xpath(&vals[7], "%s/admin-status",
-                       dctx->sysr_values_ctx.xpath_root);
-    sr_val_set_str_data(&vals[7], SR_ENUM_T,
-                        reply->admin_up_down ? "UP" : "DOWN");
+    sc_vals_leaf_str(vals, "admin-status", SR_ENUM_T,
+                     reply->admin_up_down ? "UP" : "DOWN");
 
-    sr_val_build_xpath(&vals[8], "%s/oper-status",
-                       dctx->sysr_values_ctx.xpath_root);
-    sr_val_set_str_data(&vals[8], SR_ENUM_T,
-                        reply->link_up_down ? "UP" : "DOWN");
+    sc_vals_leaf_str(vals, "oper-status", SR_ENUM_T,
+                     reply->link_up_down ? "UP" : "DOWN");
 
     //TODO: Openconfig required this value
-    // sr_val_build_xpath(&vals[9], "%s/last-change", dctx->sysr_values_ctx.xpath_root);
-    // sr_val_set_str_data(&vals[9], YANG INPUT TYPE: oc-types:timeticks64);
-
-    sr_val_build_xpath(&vals[9], "%s/logical",
-                       dctx->sysr_values_ctx.xpath_root);
-    vals[9].type = SR_BOOL_T;
-    vals[9].data.bool_val = true;         //for now, we assume all are logical
+    // sc_vals_leaf(vals, "last-change");
+    // YANG INPUT TYPE: oc-types:timeticks64
 
-    dctx->sysr_values_ctx.values = vals;
-    dctx->sysr_values_ctx.values_cnt = vc;
+    if (NULL != (val = sc_vals_leaf(vals, "logical"))) {
+        val->type = SR_BOOL_T;
+        val->data.bool_val = true;         //for now, we assume all are logical
+    }
 
-    return SR_ERR_OK;
+    return vals->rc;
 }
 
 
 // XPATH: /openconfig-interfaces:interfaces/interface/subinterfaces/subinterface/state
 static int sw_subinterface_dump_cb_inner(
-    vapi_payload_sw_interface_details *reply,
+    const scVppIntfc *reply,
     sys_sw_interface_dump_ctx *dctx)
 {
-    sr_val_t *vals = NULL;
-    int rc = 0;
-    int vc = 0, val_idx = 0;
+    sc_vals_t *vals = NULL;
+    sr_val_t *val = NULL;
 
     ARG_CHECK2(SR_ERR_INVAL_ARG, reply, dctx);
 
-    vc = 6;
-    /* convenient functions such as this can be found in sysrepo/values.h */
-    rc = sr_new_values(vc, &vals);
-    if (SR_ERR_OK != rc) {
-        return rc;
+    vals = &dctx->sysr_values_ctx.vals;
+    if (SR_ERR_OK != sc_vals_entry(vals, "%s", dctx->sysr_values_ctx.xpath_root)) {
+        return vals->rc;
     }
 
-    sr_val_build_xpath(&vals[val_idx], "%s/index",
-                       dctx->sysr_values_ctx.xpath_root);
-    vals[val_idx].type = SR_UINT32_T;
-    vals[val_idx++].data.uint32_val = dctx->subinterface_index;
+    if (NULL != (val = sc_vals_leaf(vals, "index"))) {
+        val->type = SR_UINT32_T;
+        val->data.uint32_val = dctx->subinterface_index;
+    }
 
-    sr_val_build_xpath(&vals[val_idx], "%s/description",
-                       dctx->sysr_values_ctx.xpath_root);
-    sr_val_set_str_data(&vals[val_idx++], SR_STRING_T, NOT_AVAL);
+    sc_vals_leaf_str(vals, "description", SR_STRING_T,
+                     NOT_AVAL);
 
-    sr_val_build_xpath(&vals[val_idx], "%s/enabled",
-                       dctx->sysr_values_ctx.xpath_root);
-    vals[val_idx].type = SR_BOOL_T;
-    vals[val_idx++].data.bool_val = reply->admin_up_down;
+    if (NULL != (val = sc_vals_leaf(vals, "enabled"))) {
+        val->type = SR_BOOL_T;
+        val->data.bool_val = reply->admin_up_down;
+    }
 
     //TODO: Openconfig required this value
-    // sr_val_build_xpath(&vals[val_idx], "%s/name", dctx->sysr_values_ctx.xpath_root);
-    // sr_val_set_str_data(&vals[val_idx++], SR_STRING_T, YANG INPUT TYPE: string);
+    // sc_vals_leaf(vals, "name");  YANG INPUT TYPE: string
+    // sc_vals_leaf(vals, "ifindex");  YANG INPUT TYPE: uint32
 
-    // sr_val_build_xpath(&vals[val_idx], "%s/ifindex", interface_name, subinterface_index);
-    // vals[val_idx].type = SR_UINT32_T;
-    // vals[val_idx++].data.uint32_val = YANG INPUT TYPE: uint32;
+    sc_vals_leaf_str(vals, "admin-status", SR_ENUM_T,
+                     reply->admin_up_down ? "UP" : "DOWN");
 
-    sr_val_build_xpath(&vals[val_idx], "%s/admin-status",
-                       dctx->sysr_values_ctx.xpath_root);
-    sr_val_set_str_data(&vals[val_idx++], SR_ENUM_T,
-                        reply->admin_up_down ? "UP" : "DOWN");
-
-    sr_val_build_xpath(&vals[val_idx], "%s/oper-status",
-                       dctx->sysr_values_ctx.xpath_root);
-    sr_val_set_str_data(&vals[val_idx++], SR_ENUM_T,
-                        reply->admin_up_down ? "UP" : "DOWN");
+    sc_vals_leaf_str(vals, "oper-status", SR_ENUM_T,
+                     reply->admin_up_down ? "UP" : "DOWN");
 
     //TODO: Openconfig required this value
-    // sr_val_build_xpath(&vals[val_idx], "/openconfig-interfaces:interfaces/interface[name='%s']/subinterfaces/subinterface[index='%s']/state/last-change", interface_name, subinterface_index);
-    // sr_val_set_str_data(&vals[val_idx++], YANG INPUT TYPE: oc-types:timeticks64);
-
-    sr_val_build_xpath(&vals[val_idx], "%s/logical",
-                       dctx->sysr_values_ctx.xpath_root);
-    vals[val_idx].type = SR_BOOL_T;
-    vals[val_idx++].data.bool_val = true;         //for now, we assume all are logical
+    // sc_vals_leaf(vals, "last-change");  YANG INPUT TYPE: oc-types:timeticks64
 
-    dctx->sysr_values_ctx.values = vals;
-    dctx->sysr_values_ctx.values_cnt = vc;
+    if (NULL != (val = sc_vals_leaf(vals, "logical"))) {
+        val->type = SR_BOOL_T;
+        val->data.bool_val = true;         //for now, we assume all are logical
+    }
 
-    return SR_ERR_OK;
+    return vals->rc;
 }
 
 static
-bool is_subinterface(const char* subif_name, const char* base_name,
+bool is_subinterface(const char* subif_name, const sys_xpath_key_t *base_name,
                      const u32 subif_index)
 {
     assert(subif_name && base_name);
 
     const char* dot = strchr(subif_name, '.');
+    size_t base_len = (NULL != dot) ? (size_t)(dot - subif_name) : strlen(subif_name);
 
-    if (NULL == dot && 0 == subif_index)
-        return true;                    //subif_index == 0 can pass as a "real" interface
+    if (base_len != base_name->value_len ||
+        0 != memcmp(subif_name, base_name->value, base_len))
+        return false;
 
-    if (dot > subif_name && 0 == strncmp(subif_name, base_name,
-        dot - subif_name))
+    if (NULL == dot)
+        return 0 == subif_index;        //subif_index == 0 can pass as a "real" interface
+
+    if (dot > subif_name)
     {
         char * eptr = NULL;
         u32 si = strtoul(dot + 1, &eptr, 10);
@@ -392,304 +372,268 @@ bool is_subinterface(const char* subif_name, const char* base_name,
     return false;
 }
 
-static vapi_error_e
-sw_interface_dump_vapi_cb(struct vapi_ctx_s *ctx, void *callback_ctx,
-                     vapi_error_e rv, bool is_last,
-                     vapi_payload_sw_interface_details * reply)
-{
-    ARG_CHECK(VAPI_EINVAL, callback_ctx);
-
-    if (is_last)
-    {
-        assert (NULL == reply);
-    }
-    else
-    {
-        assert (NULL != reply);
-        sys_sw_interface_dump_ctx *dctx = callback_ctx;
-
-        const char* const dctx_interface_name = (const char *)dctx->sw_interface_details_query.sw_interface_details.interface_name;
-
-        SRP_LOG_DBG("interface_name: '%s', if_name: '%s'", reply->interface_name, dctx_interface_name);
-
-        if (dctx->is_subif)
-        {
-            if (is_subinterface((const char*)reply->interface_name,
-                dctx_interface_name, dctx->subinterface_index))
-                sw_subinterface_dump_cb_inner(reply, dctx);
-        }
-        else
-        {
-            if (0 == strcmp(dctx_interface_name, (char *)reply->interface_name))
-            {
-                dctx->sw_interface_details_query.sw_interface_details = *reply;
-                dctx->sw_interface_details_query.interface_found = true;
-
-                sw_interface_dump_cb_inner(reply, dctx);
-            }
-        }
-    }
-
-    return VAPI_OK;
-}
-
-static vapi_error_e sysr_sw_interface_dump(sys_sw_interface_dump_ctx * dctx)
-{
-    ARG_CHECK(VAPI_EINVAL, dctx);
-
-    vapi_msg_sw_interface_dump *dump = vapi_alloc_sw_interface_dump(g_vapi_ctx);
-    vapi_error_e rv;
-
-    dump->payload.name_filter_valid = true;
-    strcpy((char*)dump->payload.name_filter, (const char *)dctx->sw_interface_details_query.sw_interface_details.interface_name);
-
-    VAPI_CALL(vapi_sw_interface_dump(g_vapi_ctx, dump, sw_interface_dump_vapi_cb,
-                                     dctx));
-
-    if (VAPI_OK != rv) {
-        SRP_LOG_DBG("vapi_sw_interface_dump error=%d", rv);
-    }
-
-    return rv;
-}
-
+/**
+ * Fill the state of one interface, or of all of them when the request is
+ * not keyed by name, from the interface snapshot of the request.
+ */
 int openconfig_interfaces_interfaces_interface_state_cb(
     const char *xpath, sr_val_t **values,
     size_t *values_cnt, uint64_t request_id,
     __attribute__((unused)) void *private_ctx)
 {
-    sr_xpath_ctx_t state = {0};
-    char *tmp = NULL;
-    char interface_name[XPATH_SIZE] = {0};
+    sys_xpath_keys_t keys;
+    const sys_xpath_key_t *name = NULL;
+    char interface_name[VPP_INTFC_NAME_LEN] = {0};
+    sys_sw_interface_dump_ctx dctx = {0};
+    const sc_sw_interface_dump_ctx *snapshot = NULL;
+    const scVppIntfc *intfc = NULL;
+    sys_request_t *req = NULL;
+    size_t i;
 
     ARG_CHECK3(SR_ERR_INVAL_ARG, xpath, values, values_cnt);
 
-    tmp = xpath_find_first_key(xpath, "name", &state);
-    if (NULL == tmp) {
-        SRP_LOG_DBG_MSG("interface_name not found.");
+    if (0 != xpath_keys_parse(xpath, &keys)) {
         return SR_ERR_INVAL_ARG;
     }
 
-    strncpy(interface_name, tmp, XPATH_SIZE);
-    sr_xpath_recover(&state);
+    name = xpath_keys_find(&keys, "name");
+    if (NULL != name &&
+        0 != xpath_key_copy(name, interface_name, sizeof(interface_name))) {
+        /* longer than any VPP interface name */
+        return SR_ERR_NOT_FOUND;
+    }
 
-    sys_sw_interface_dump_ctx dctx = {
-        .is_subif = false
-    };
-    sw_interface_details_query_set_name(&dctx.sw_interface_details_query,
-                                        interface_name);
+    if (NULL == (req = sys_request_get(request_id))) {
+        return SR_ERR_NOMEM;
+    }
 
-    snprintf(dctx.sysr_values_ctx.xpath_root, XPATH_SIZE,
-             "/openconfig-interfaces:interfaces/interface[name='%s']/state",
-             interface_name);
+    snapshot = sys_request_interfaces(req);
+    if (NULL == snapshot) {
+        SRP_LOG_ERR_MSG("interface dump failed");
+        sys_request_put(req);
+        return SR_ERR_INTERNAL;
+    }
 
-    sysr_sw_interface_dump(&dctx);
+    if ('\0' != interface_name[0]) {
+        /* single interface, no need to size for the whole snapshot */
+        intfc = sc_interface_snapshot_find(snapshot, interface_name);
+        if (NULL == intfc) {
+            SRP_LOG_DBG_MSG("interface not found");
+            sys_request_put(req);
+            return SR_ERR_NOT_FOUND;
+        }
 
-    if (!dctx.sw_interface_details_query.interface_found) {
-        SRP_LOG_DBG_MSG("interface not found");
-        return SR_ERR_NOT_FOUND;
-    }
+        snprintf(dctx.sysr_values_ctx.xpath_root, XPATH_SIZE,
+                 "/openconfig-interfaces:interfaces/interface[name='%s']/state",
+                 interface_name);
 
-    sr_xpath_recover(&state);
-    *values = dctx.sysr_values_ctx.values;
-    *values_cnt = dctx.sysr_values_ctx.values_cnt;
+        if (SR_ERR_OK == sc_vals_init(&dctx.sysr_values_ctx.vals,
+                                      OC_INTERFACE_STATE_LEAVES)) {
+            sw_interface_dump_cb_inner(intfc, &dctx);
+        }
+    } else if (SR_ERR_OK == sc_vals_init(&dctx.sysr_values_ctx.vals,
+                       snapshot->num_ifs * OC_INTERFACE_STATE_LEAVES)) {
+        for (i = 0; i < snapshot->num_ifs; i++) {
+            intfc = &snapshot->intfcArray[i];
+            snprintf(dctx.sysr_values_ctx.xpath_root, XPATH_SIZE,
+                     "/openconfig-interfaces:interfaces/interface[name='%s']/state",
+                     intfc->interface_name);
+            if (SR_ERR_OK != sw_interface_dump_cb_inner(intfc, &dctx)) {
+                break;
+            }
+        }
+    }
+    sys_request_put(req);
 
-    return SR_ERR_OK;
+    return sc_vals_finish(&dctx.sysr_values_ctx.vals, values, values_cnt);
 }
 
 // XPATH: /openconfig-interfaces:interfaces/interface/subinterfaces/subinterface/openconfig-if-ip:ipv4/openconfig-if-ip:addresses/openconfig-if-ip:address/openconfig-if-ip:state
 int openconfig_interfaces_interfaces_interface_subinterfaces_subinterface_oc_ip_ipv4_oc_ip_addresses_oc_ip_address_oc_ip_state_vapi_cb(
-    vapi_payload_ip_address_details *reply,
+    const sc_ip_addr_t *reply,
     sysr_values_ctx_t *sysr_values_ctx)
 {
-    sr_val_t *vals = NULL;
-    int rc = 0;
-    int vc = 0;
+    sc_vals_t *vals = NULL;
+    sr_val_t *val = NULL;
+    char address[INET_ADDRSTRLEN] = {0};
 
     ARG_CHECK2(SR_ERR_INVAL_ARG, reply, sysr_values_ctx);
 
-    vc = 3;
-    /* convenient functions such as this can be found in sysrepo/values.h */
-    rc = sr_new_values(vc, &vals);
-    if (SR_ERR_OK != rc) {
-        return rc;
+    vals = &sysr_values_ctx->vals;
+    if (SR_ERR_OK != sc_vals_entry(vals, "%s", sysr_values_ctx->xpath_root)) {
+        return vals->rc;
     }
 
-    char * address_ip = bapi_ntoa(reply->ip);
-
-    sr_val_build_xpath(&vals[0], "%s/openconfig-if-ip:ip",
-                       sysr_values_ctx->xpath_root);
-    sr_val_set_str_data(&vals[0], SR_STRING_T, address_ip);
+    inet_ntop(AF_INET, reply->address, address, sizeof(address));
+    sc_vals_leaf_str(vals, "openconfig-if-ip:ip", SR_STRING_T, address);
 
-    sr_val_build_xpath(&vals[1], "%s/openconfig-if-ip:prefix-length",
-                       sysr_values_ctx->xpath_root);
-    vals[1].type = SR_UINT8_T;
-    vals[1].data.uint8_val = reply->prefix_length;
-
-    sr_val_build_xpath(&vals[2], "%s/openconfig-if-ip:origin",
-                       sysr_values_ctx->xpath_root);
-    sr_val_set_str_data(&vals[2], SR_ENUM_T, "STATIC");
+    if (NULL != (val = sc_vals_leaf(vals, "openconfig-if-ip:prefix-length"))) {
+        val->type = SR_UINT8_T;
+        val->data.uint8_val = reply->prefix_length;
+    }
 
-    sysr_values_ctx->values = vals;
-    sysr_values_ctx->values_cnt = vc;
+    sc_vals_leaf_str(vals, "openconfig-if-ip:origin", SR_ENUM_T,
+                     "STATIC");
 
-    return SR_ERR_OK;
+    return vals->rc;
 }
 
-vapi_error_e
-ip_address_dump_cb (struct vapi_ctx_s *ctx, void *callback_ctx,
-                    vapi_error_e rv, bool is_last,
-                    vapi_payload_ip_address_details * reply)
+typedef struct
 {
-    ARG_CHECK2(VAPI_EINVAL, ctx, callback_ctx);
-
-    sysr_values_ctx_t *dctx = callback_ctx;
-
-    if (is_last)
-    {
-        assert (NULL == reply);
-    }
-    else
-    {
-        assert (NULL != reply);
-
-        printf ("ip address dump entry:"
-                    "\tsw_if_index[%u]"
-                    "\tip[%s/%u]\n"
-                    , reply->sw_if_index, bapi_ntoa(reply->ip),
-                reply->prefix_length);
-
-        openconfig_interfaces_interfaces_interface_subinterfaces_subinterface_oc_ip_ipv4_oc_ip_addresses_oc_ip_address_oc_ip_state_vapi_cb(reply, dctx);
-    }
-
-    return VAPI_OK;
-}
+    u8 address_ip[VPP_IP4_ADDRESS_LEN];
+    sysr_values_ctx_t sysr_values_ctx;
+} sys_ip_address_dump_ctx;
 
 //TODO: for some arcane reason, this doesn't work
 int openconfig_interfaces_interfaces_interface_subinterfaces_subinterface_oc_ip_ipv4_oc_ip_addresses_oc_ip_address_oc_ip_state_cb(
     const char *xpath, sr_val_t **values, size_t *values_cnt,
-    __attribute__((unused)) uint64_t request_id,
+    uint64_t request_id,
     __attribute__((unused)) void *private_ctx)
 {
-    sr_xpath_ctx_t state = {0};
-    vapi_error_e rv;
-    char *tmp = NULL;
-    char interface_name[XPATH_SIZE] = {0};
-    char subinterface_index[XPATH_SIZE] = {0};
-    char address_ip[XPATH_SIZE] = {0};
+    sys_xpath_keys_t keys;
+    const sys_xpath_key_t *name = NULL;
+    const sys_xpath_key_t *subinterface_index = NULL;
+    const sys_xpath_key_t *ip = NULL;
+    char interface_name[VPP_INTFC_NAME_LEN] = {0};
+    char address_ip[INET_ADDRSTRLEN] = {0};
+    const sc_ip_addr_t *addr = NULL;
 
     ARG_CHECK3(SR_ERR_INVAL_ARG, xpath, values, values_cnt);
 
-    tmp = xpath_find_first_key(xpath, "name", &state);
-    if (NULL == tmp) {
-        SRP_LOG_ERR_MSG("interface_name not found.");
+    if (0 != xpath_keys_parse(xpath, &keys)) {
+        SRP_LOG_ERR_MSG("xpath not valid.");
         return SR_ERR_INVAL_ARG;
     }
 
-    strncpy(interface_name, tmp, XPATH_SIZE);
-    sr_xpath_recover(&state);
+    if (NULL == (name = xpath_keys_find(&keys, "name")) ||
+        0 != xpath_key_copy(name, interface_name, sizeof(interface_name))) {
+        SRP_LOG_ERR_MSG("interface_name not found.");
+        return SR_ERR_INVAL_ARG;
+    }
 
-    tmp = xpath_find_first_key(xpath, "index", &state);
-    if (NULL == tmp) {
+    if (NULL == (subinterface_index = xpath_keys_find(&keys, "index"))) {
         SRP_LOG_ERR_MSG("subinterface_index not found.");
         return SR_ERR_INVAL_ARG;
     }
 
-    strncpy(subinterface_index, tmp, XPATH_SIZE);
-    sr_xpath_recover(&state);
-
-    tmp = xpath_find_first_key(xpath, "ip", &state);
-    if (NULL == tmp) {
+    if (NULL == (ip = xpath_keys_find(&keys, "ip"))) {
         SRP_LOG_ERR_MSG("address_ip not found.");
         return SR_ERR_INVAL_ARG;
     }
 
-    strncpy(address_ip, tmp, XPATH_SIZE);
-    sr_xpath_recover(&state);
-
-    sysr_values_ctx_t dctx = {0};
-    snprintf(dctx.xpath_root, XPATH_SIZE, "/openconfig-interfaces:interfaces/interface[name='%s']/subinterfaces/subinterface[index='%s']/openconfig-if-ip:ipv4/openconfig-if-ip:addresses/openconfig-if-ip:address[ip='%s']/openconfig-if-ip:state",
-             interface_name, subinterface_index, address_ip);
-
-    sw_interface_details_query_t query = {0};
-    sw_interface_details_query_set_name(&query, interface_name);
+    sys_ip_address_dump_ctx dctx = {0};
+    if (0 != xpath_key_copy(ip, address_ip, sizeof(address_ip)) ||
+        1 != inet_pton(AF_INET, address_ip, dctx.address_ip)) {
+        SRP_LOG_ERR_MSG("address_ip not valid.");
+        return SR_ERR_INVAL_ARG;
+    }
+    snprintf(dctx.sysr_values_ctx.xpath_root, XPATH_SIZE, "/openconfig-interfaces:interfaces/interface[name='%.*s']/subinterfaces/subinterface[index='%.*s']/openconfig-if-ip:ipv4/openconfig-if-ip:addresses/openconfig-if-ip:address[ip='%.*s']/openconfig-if-ip:state",
+             XPATH_KEY_ARG(name), XPATH_KEY_ARG(subinterface_index),
+             XPATH_KEY_ARG(ip));
+
+    /* the interface and its addresses are dumped once for the whole request */
+    sys_request_t *req = sys_request_get(request_id);
+    if (NULL == req) {
+        return SR_ERR_NOMEM;
+    }
 
-    if (!get_interface_id(&query))
-    {
+    const scVppIntfc *intfc =
+        sc_interface_snapshot_find(sys_request_interfaces(req), interface_name);
+    if (NULL == intfc) {
+        sys_request_put(req);
         return SR_ERR_INVAL_ARG;
     }
 
-    vapi_msg_ip_address_dump *mp = vapi_alloc_ip_address_dump (g_vapi_ctx);
-    mp->payload.sw_if_index = query.sw_interface_details.sw_if_index;
-    mp->payload.is_ipv6 = 0;
+    if (SR_ERR_OK != sc_vals_init(&dctx.sysr_values_ctx.vals, 3))
+    {
+        sys_request_put(req);
+        return dctx.sysr_values_ctx.vals.rc;
+    }
 
-    rv = vapi_ip_address_dump(g_vapi_ctx, mp, ip_address_dump_cb, &dctx);
-    if (VAPI_OK != rv)
+    /* one dump fills the address table of the interface for the request */
+    if (0 != sys_request_addr_find(req, intfc->sw_if_index, false,
+                                   dctx.address_ip, &addr))
     {
         SRP_LOG_ERR_MSG("VAPI call failed");
+        sys_request_put(req);
+        sc_vals_free(&dctx.sysr_values_ctx.vals);
         return SR_ERR_INVAL_ARG;
     }
 
-    sr_xpath_recover(&state);
-    *values = dctx.values;
-    *values_cnt = dctx.values_cnt;
+    if (NULL != addr)
+    {
+        openconfig_interfaces_interfaces_interface_subinterfaces_subinterface_oc_ip_ipv4_oc_ip_addresses_oc_ip_address_oc_ip_state_vapi_cb(addr, &dctx.sysr_values_ctx);
+    }
+    sys_request_put(req);
 
-    return SR_ERR_OK;
+    return sc_vals_finish(&dctx.sysr_values_ctx.vals, values, values_cnt);
 }
 
 int openconfig_interfaces_interfaces_interface_subinterfaces_subinterface_state_cb(
     const char *xpath, sr_val_t **values, size_t *values_cnt,
-    __attribute__((unused)) uint64_t request_id,
+    uint64_t request_id,
     __attribute__((unused)) void *private_ctx)
 {
-    sr_xpath_ctx_t state = {0};
-    char *tmp = NULL;
-    char interface_name[XPATH_SIZE] = {0};
-    char subinterface_index[XPATH_SIZE] = {0};
+    sys_xpath_keys_t keys;
+    const sys_xpath_key_t *interface_name = NULL;
+    const sys_xpath_key_t *subinterface_index = NULL;
 
     ARG_CHECK3(SR_ERR_INVAL_ARG, xpath, values, values_cnt);
 
-    tmp = xpath_find_first_key(xpath, "name", &state);
-    if (NULL == tmp) {
-        SRP_LOG_ERR_MSG("interface_name not found.");
+    if (0 != xpath_keys_parse(xpath, &keys)) {
+        SRP_LOG_ERR_MSG("xpath not valid.");
         return SR_ERR_INVAL_ARG;
     }
 
-    strncpy(interface_name, tmp, XPATH_SIZE);
-    sr_xpath_recover(&state);
+    if (NULL == (interface_name = xpath_keys_find(&keys, "name"))) {
+        SRP_LOG_ERR_MSG("interface_name not found.");
+        return SR_ERR_INVAL_ARG;
+    }
 
-    tmp = xpath_find_first_key(xpath, "index", &state);
-    if (NULL == tmp) {
+    if (NULL == (subinterface_index = xpath_keys_find(&keys, "index"))) {
         SRP_LOG_ERR_MSG("subinterface_index not found.");
         return SR_ERR_INVAL_ARG;
     }
 
-    strncpy(subinterface_index, tmp, XPATH_SIZE);
-    sr_xpath_recover(&state);
-
+    /* the key is followed by its closing quote, strtoul stops there */
     sys_sw_interface_dump_ctx dctx =
     {
-        .is_subif = true,
-        .subinterface_index = atoi(subinterface_index)
+        .subinterface_index = strtoul(subinterface_index->value, NULL, 10)
     };
-    sw_interface_details_query_set_name(&dctx.sw_interface_details_query,
-                                        interface_name);
+    const sc_sw_interface_dump_ctx *snapshot = NULL;
+    const scVppIntfc *intfc = NULL;
+    sys_request_t *req = NULL;
+    size_t i;
 
-    snprintf(dctx.sysr_values_ctx.xpath_root, XPATH_SIZE, "/openconfig-interfaces:interfaces/interface[name='%s']/subinterfaces/subinterface[index='%s']/state",
-             interface_name, subinterface_index);
+    snprintf(dctx.sysr_values_ctx.xpath_root, XPATH_SIZE, "/openconfig-interfaces:interfaces/interface[name='%.*s']/subinterfaces/subinterface[index='%.*s']/state",
+             XPATH_KEY_ARG(interface_name), XPATH_KEY_ARG(subinterface_index));
 
-    sysr_sw_interface_dump(&dctx);
+    if (NULL == (req = sys_request_get(request_id))) {
+        return SR_ERR_NOMEM;
+    }
+
+    snapshot = sys_request_interfaces(req);
+    for (i = 0; NULL != snapshot && i < snapshot->num_ifs; i++) {
+        if (is_subinterface(snapshot->intfcArray[i].interface_name,
+                            interface_name, dctx.subinterface_index)) {
+            intfc = &snapshot->intfcArray[i];
+            break;
+        }
+    }
 
-    if (!dctx.sw_interface_details_query.interface_found) {
+    if (NULL == intfc) {
         SRP_LOG_DBG_MSG("interface not found");
+        sys_request_put(req);
         return SR_ERR_NOT_FOUND;
     }
 
-    sr_xpath_recover(&state);
-    *values = dctx.sysr_values_ctx.values;
-    *values_cnt = dctx.sysr_values_ctx.values_cnt;
+    if (SR_ERR_OK == sc_vals_init(&dctx.sysr_values_ctx.vals,
+                                  OC_SUBINTERFACE_STATE_LEAVES)) {
+        sw_subinterface_dump_cb_inner(intfc, &dctx);
+    }
+    sys_request_put(req);
 
-    return SR_ERR_OK;
+    return sc_vals_finish(&dctx.sysr_values_ctx.vals, values, values_cnt);
 }
 
 VAPI_RETVAL_CB(sw_interface_add_del_address);
@@ -725,9 +669,9 @@ int openconfig_interfaces_interfaces_interface_subinterfaces_subinterface_oc_ip_
     sr_change_oper_t oper;
     sr_val_t *old_val = NULL;
     sr_val_t *new_val = NULL;
-    char *tmp = NULL;
-    char interface_name[XPATH_SIZE] = {0};
-    char subinterface_index[XPATH_SIZE] = {0};
+    sys_xpath_keys_t keys;
+    const sys_xpath_key_t *name = NULL;
+    char interface_name[VPP_INTFC_NAME_LEN] = {0};
     char address_ip[XPATH_SIZE] = {0};
     char old_address_ip[XPATH_SIZE] = {0};
     u8 prefix_len = 0;
@@ -758,28 +702,28 @@ int openconfig_interfaces_interfaces_interface_subinterfaces_subinterface_oc_ip_
 
         log_recv_oper(oper, "subtree_change_cb received");
 
-        SRP_LOG_DBG("xpath: %s", new_val->xpath);
+        /* there is no new value of a deleted leaf */
+        const char *change_xpath = (NULL != new_val) ? new_val->xpath :
+                                                       old_val->xpath;
+        SRP_LOG_DBG("xpath: %s", change_xpath);
 
-        sr_xpath_ctx_t state = {0};
-
-        tmp = xpath_find_first_key(new_val->xpath, "name", &state);
-        if (NULL == tmp) {
+        /* the binary API wants the name as a C string */
+        if (0 != xpath_keys_parse(change_xpath, &keys) ||
+            NULL == (name = xpath_keys_find(&keys, "name")) ||
+            0 != xpath_key_copy(name, interface_name, sizeof(interface_name))) {
             SRP_LOG_DBG_MSG("interface_name NOT found.");
+            sr_free_val(old_val);
+            sr_free_val(new_val);
             continue;
         }
 
-        strncpy(interface_name, tmp, XPATH_SIZE);
-        sr_xpath_recover(&state);
-
-        tmp = xpath_find_first_key(new_val->xpath, "index", &state);
-        if (NULL == tmp) {
+        if (NULL == xpath_keys_find(&keys, "index")) {
             SRP_LOG_DBG_MSG("subinterface_index NOT found.");
+            sr_free_val(old_val);
+            sr_free_val(new_val);
             continue;
         }
 
-        strncpy(subinterface_index, tmp, XPATH_SIZE);
-        sr_xpath_recover(&state);
-
         switch (oper) {
             case SR_OP_CREATED:
                 if (sr_xpath_node_name_eq(new_val->xpath, "ip")) {
@@ -854,8 +798,6 @@ int openconfig_interfaces_interfaces_interface_subinterfaces_subinterface_oc_ip_
         }
 
         if (0 != rc) {
-            sr_xpath_recover(&state);
-
             sr_free_val(old_val);
             sr_free_val(new_val);
 
@@ -864,8 +806,6 @@ int openconfig_interfaces_interfaces_interface_subinterfaces_subinterface_oc_ip_
             return SR_ERR_OPERATION_FAILED;
         }
 
-        sr_xpath_recover(&state);
-
         sr_free_val(old_val);
         sr_free_val(new_val);
     }
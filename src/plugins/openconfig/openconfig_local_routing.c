@@ -16,7 +16,10 @@
 
 #include "openconfig_local_routing.h"
 #include "sys_util.h"
+#include "sys_request.h"
 #include "sc_vpp_operation.h"
+#include "sc_vpp_fib.h"
+#include "../sc_interface.h"
 
 #include "../bapi/bapi.h"
 #include "../bapi/bapi_interface.h"
@@ -24,6 +27,7 @@
 
 #include <assert.h>
 #include <string.h>
+#include <arpa/inet.h>
 #include <sysrepo/xpath.h>
 #include <sysrepo/values.h>
 
@@ -40,14 +44,39 @@ int openconfig_local_routing_mod_cb(
     return SR_ERR_OK;
 }
 
-static int set_route(sr_session_ctx_t *sess, const char *index,
+/* Apply our own route change to the FIB cache, so that it shows up before the next refresh. */
+static void fib_record_route(const char *address, u8 length,
+                             const char *next_hop /*NULLABLE*/,
+                             const char *interface /*NULLABLE*/, bool is_add)
+{
+    u8 prefix[VPP_IP6_ADDRESS_LEN] = {0};
+    sc_fib_path_t path = { .sw_if_index = ~0 };
+    bool is_ipv6 = (NULL != strchr(address, ':'));
+    int af = is_ipv6 ? AF_INET6 : AF_INET;
+    int rc = -1;
+
+    if (1 == inet_pton(af, address, prefix) &&
+        (NULL == next_hop || 1 == inet_pton(af, next_hop, path.next_hop)) &&
+        (NULL == interface || 0 == sc_interface_name2index(interface, &path.sw_if_index))) {
+        rc = is_add ? sc_fib_route_add(is_ipv6, prefix, length, &path) :
+                      sc_fib_route_del(is_ipv6, prefix, length, &path);
+    }
+
+    if (0 != rc) {
+        /* could not mirror the change, let the next read dump the FIB */
+        sc_fib_invalidate();
+    }
+}
+
+static int set_route(sr_session_ctx_t *sess, const sys_xpath_key_t *index,
                      const char *n_interface /*NULLABLE*/,
                      const char *n_next_hop /*NULLABLE*/,
-                     const char *prefix, bool is_add)
+                     const sys_xpath_key_t *prefix, bool is_add)
 {
     int rc = SR_ERR_OK;
     sr_val_t *value = NULL;
     char xpath[XPATH_SIZE] = {0};
+    char address[INET6_ADDRSTRLEN] = {0};
     const char *interface = NULL;
     const char *next_hop = NULL;
 
@@ -55,7 +84,8 @@ static int set_route(sr_session_ctx_t *sess, const char *index,
 
     if (NULL == n_interface) {
         snprintf(xpath, XPATH_SIZE,
-        "/openconfig-local-routing:local-routes/static-routes/static[prefix='%s']/next-hops/next-hop[index='%s']/interface-ref/config/interface", prefix, index);
+        "/openconfig-local-routing:local-routes/static-routes/static[prefix='%.*s']/next-hops/next-hop[index='%.*s']/interface-ref/config/interface",
+        XPATH_KEY_ARG(prefix), XPATH_KEY_ARG(index));
 
         rc = sr_get_item(sess, xpath, &value);
         if (SR_ERR_OK != rc) {
@@ -70,7 +100,8 @@ static int set_route(sr_session_ctx_t *sess, const char *index,
 
     if (NULL == n_next_hop) {
         snprintf(xpath, XPATH_SIZE,
-        "/openconfig-local-routing:local-routes/static-routes/static[prefix='%s']/next-hops/next-hop[index='%s']/config/next-hop", prefix, index);
+        "/openconfig-local-routing:local-routes/static-routes/static[prefix='%.*s']/next-hops/next-hop[index='%.*s']/config/next-hop",
+        XPATH_KEY_ARG(prefix), XPATH_KEY_ARG(index));
 
         rc = sr_get_item(sess, xpath, &value);
         if (SR_ERR_OK != rc) {
@@ -83,19 +114,22 @@ static int set_route(sr_session_ctx_t *sess, const char *index,
         next_hop = n_next_hop;
     }
 
-    int mask = ip_prefix_split(prefix);
+    int mask = ip_prefix_parse(prefix->value, prefix->value_len, address,
+                               sizeof(address));
     if (mask < 1) {
         return SR_ERR_INVAL_ARG;
     }
 
     vapi_payload_ip_add_del_route_reply reply = {0};
 
-    vapi_error_e rv = bin_api_ip_add_del_route(&reply, prefix, mask,
+    vapi_error_e rv = bin_api_ip_add_del_route(&reply, address, mask,
                                                next_hop, is_add, 0, interface);
     if (VAPI_OK != rv || reply.retval > 0) {
         return SR_ERR_INVAL_ARG;
     }
 
+    fib_record_route(address, mask, next_hop, interface, is_add);
+
     return VAPI_OK;
 }
 
@@ -109,11 +143,10 @@ int openconfig_local_routing_local_routes_static_routes_static_next_hops_next_ho
     sr_val_t *old_val = NULL;
     sr_val_t *new_val = NULL;
     int rc = SR_ERR_OK;
-    char *tmp = NULL;
-    char static_prefix[XPATH_SIZE] = {0};
-    char next_hop_index[XPATH_SIZE] = {0};
+    sys_xpath_keys_t keys;
+    const sys_xpath_key_t *static_prefix = NULL;
+    const sys_xpath_key_t *next_hop_index = NULL;
     char next_hop[XPATH_SIZE] = {0};
-    char old_next_hop_index[XPATH_SIZE] = {0};
     char old_next_hop[XPATH_SIZE] = {0};
     bool index_set = false, next_hop_set = false;
     bool old_index_set = false, old_next_hop_set = false;
@@ -140,24 +173,24 @@ int openconfig_local_routing_local_routes_static_routes_static_next_hops_next_ho
 
         log_recv_oper(oper, "subtree_change_cb received");
 
-        SRP_LOG_DBG("xpath: %s", new_val->xpath);
-
-        sr_xpath_ctx_t state = {0};
+        /* there is no new value of a deleted leaf */
+        const char *change_xpath = (NULL != new_val) ? new_val->xpath :
+                                                       old_val->xpath;
+        SRP_LOG_DBG("xpath: %s", change_xpath);
 
-        tmp = xpath_find_first_key(new_val->xpath, "prefix", &state);
-        if (NULL == tmp) {
+        /* the index leaf is the key of its next-hop */
+        if (0 != xpath_keys_parse(change_xpath, &keys) ||
+            NULL == (static_prefix = xpath_keys_find(&keys, "prefix")) ||
+            NULL == (next_hop_index = xpath_keys_find(&keys, "index"))) {
             SRP_LOG_DBG_MSG("static_prefix NOT found.");
+            sr_free_val(old_val);
+            sr_free_val(new_val);
             continue;
         }
 
-        strncpy(static_prefix, tmp, XPATH_SIZE);
-        sr_xpath_recover(&state);
-
         switch (oper) {
             case SR_OP_CREATED:
                 if (sr_xpath_node_name_eq(new_val->xpath, "index")) {
-                    strncpy(next_hop_index, new_val->data.string_val,
-                            XPATH_SIZE);
                     index_set = true;
                 } else if(sr_xpath_node_name_eq(new_val->xpath, "next-hop")) {
                     next_hop_set = true;
@@ -176,8 +209,6 @@ int openconfig_local_routing_local_routes_static_routes_static_next_hops_next_ho
 
             case SR_OP_MODIFIED:
                 if (sr_xpath_node_name_eq(old_val->xpath, "index")) {
-                    strncpy(old_next_hop_index, old_val->data.string_val,
-                            XPATH_SIZE);
                     old_index_set = true;
                 } else if(sr_xpath_node_name_eq(old_val->xpath, "next-hop")) {
                     old_next_hop_set = true;
@@ -189,8 +220,6 @@ int openconfig_local_routing_local_routes_static_routes_static_next_hops_next_ho
                 }
 
                 if (sr_xpath_node_name_eq(new_val->xpath, "index")) {
-                    strncpy(next_hop_index, new_val->data.string_val,
-                            XPATH_SIZE);
                     index_set = true;
                 } else if(sr_xpath_node_name_eq(new_val->xpath, "next-hop")) {
                     next_hop_set = true;
@@ -202,7 +231,7 @@ int openconfig_local_routing_local_routes_static_routes_static_next_hops_next_ho
                 }
 
                 if (old_index_set && old_next_hop_set) {
-                    rc = set_route(ds, old_next_hop_index,  NULL, old_next_hop,
+                    rc = set_route(ds, next_hop_index,  NULL, old_next_hop,
                                    static_prefix, false);
                 }
 
@@ -217,8 +246,6 @@ int openconfig_local_routing_local_routes_static_routes_static_next_hops_next_ho
 
             case SR_OP_DELETED:
                 if (sr_xpath_node_name_eq(old_val->xpath, "index")) {
-                    strncpy(old_next_hop_index, old_val->data.string_val,
-                            XPATH_SIZE);
                     old_index_set = true;
                 } else if(sr_xpath_node_name_eq(old_val->xpath, "next-hop")) {
                     old_next_hop_set = true;
@@ -230,15 +257,13 @@ int openconfig_local_routing_local_routes_static_routes_static_next_hops_next_ho
                 }
 
                 if (old_index_set && old_next_hop_set) {
-                    rc = set_route(ds, old_next_hop_index,  NULL, old_next_hop,
+                    rc = set_route(ds, next_hop_index,  NULL, old_next_hop,
                                    static_prefix, false);
                 }
                 break;
         }
 
         if (SR_ERR_OK != rc) {
-            sr_xpath_recover(&state);
-
             sr_free_val(old_val);
             sr_free_val(new_val);
 
@@ -246,8 +271,6 @@ int openconfig_local_routing_local_routes_static_routes_static_next_hops_next_ho
             return SR_ERR_OPERATION_FAILED;
         }
 
-        sr_xpath_recover(&state);
-
         sr_free_val(old_val);
         sr_free_val(new_val);
     }
@@ -265,9 +288,9 @@ int openconfig_local_routing_local_routes_static_routes_static_next_hops_next_ho
     sr_change_oper_t oper;
     sr_val_t *old_val = NULL;
     sr_val_t *new_val = NULL;
-    char *tmp = NULL;
-    char static_prefix[XPATH_SIZE] = {0};
-    char next_hop_index[XPATH_SIZE] = {0};
+    sys_xpath_keys_t keys;
+    const sys_xpath_key_t *static_prefix = NULL;
+    const sys_xpath_key_t *next_hop_index = NULL;
     char interface[XPATH_SIZE] = {0};
     char old_interface[XPATH_SIZE] = {0};
     int rc = SR_ERR_OK;
@@ -292,28 +315,26 @@ int openconfig_local_routing_local_routes_static_routes_static_next_hops_next_ho
 
         log_recv_oper(oper, "subtree_change_cb received");
 
-        SRP_LOG_DBG("xpath: %s", new_val->xpath);
+        /* there is no new value of a deleted leaf */
+        const char *change_xpath = (NULL != new_val) ? new_val->xpath :
+                                                       old_val->xpath;
+        SRP_LOG_DBG("xpath: %s", change_xpath);
 
-        sr_xpath_ctx_t state = {0};
-
-        tmp = xpath_find_first_key(new_val->xpath, "prefix", &state);
-        if (NULL == tmp) {
+        if (0 != xpath_keys_parse(change_xpath, &keys) ||
+            NULL == (static_prefix = xpath_keys_find(&keys, "prefix"))) {
             SRP_LOG_DBG_MSG("static_prefix NOT found.");
+            sr_free_val(old_val);
+            sr_free_val(new_val);
             continue;
         }
 
-        strncpy(static_prefix, tmp, XPATH_SIZE);
-        sr_xpath_recover(&state);
-
-        tmp = xpath_find_first_key(new_val->xpath, "index", &state);
-        if (NULL == tmp) {
+        if (NULL == (next_hop_index = xpath_keys_find(&keys, "index"))) {
             SRP_LOG_DBG_MSG("next-hop_index NOT found.");
+            sr_free_val(old_val);
+            sr_free_val(new_val);
             continue;
         }
 
-        strncpy(next_hop_index, tmp, XPATH_SIZE);
-        sr_xpath_recover(&state);
-
         switch (oper) {
             case SR_OP_CREATED:
                 if (sr_xpath_node_name_eq(new_val->xpath, "interface")) {
@@ -360,8 +381,6 @@ int openconfig_local_routing_local_routes_static_routes_static_next_hops_next_ho
         }
 
         if (SR_ERR_OK != rc) {
-            sr_xpath_recover(&state);
-
             sr_free_val(old_val);
             sr_free_val(new_val);
 
@@ -369,8 +388,6 @@ int openconfig_local_routing_local_routes_static_routes_static_next_hops_next_ho
             return SR_ERR_OPERATION_FAILED;
         }
 
-        sr_xpath_recover(&state);
-
         sr_free_val(old_val);
         sr_free_val(new_val);
     }
@@ -381,128 +398,100 @@ int openconfig_local_routing_local_routes_static_routes_static_next_hops_next_ho
 
 typedef struct
 {
+    bool is_ipv6;
     u8 length;
-    u8 address[4];
+    u8 address[VPP_IP6_ADDRESS_LEN];
 } address_prefix_t;
 
 typedef struct {
-    char *next_hop_index;
+    const sys_xpath_key_t *next_hop_index;
     address_prefix_t address_prefix;
     const bool is_interface_ref;
     sw_interface_details_query_t sw_interface_details_query;
     sysr_values_ctx_t sysr_values_ctx;
 } sysr_ip_fib_details_ctx_t;
 
-static
-bool address_prefix_cmp(address_prefix_t* address_prefix,
-                        vapi_payload_ip_fib_details* reply)
+static const sc_fib_route_t *
+fib_find_prefix(address_prefix_t *address_prefix)
 {
-    ARG_CHECK2(false, address_prefix, reply);
+    ARG_CHECK(NULL, address_prefix);
 
-    if (address_prefix->length == reply->address_length)
-    {
-        if (0 == memcmp(address_prefix->address, reply->address, sizeof(reply->address)))
-            return true;
-    }
-
-    return false;
+    return sc_fib_lookup(address_prefix->is_ipv6, address_prefix->address,
+                         address_prefix->length);
 }
 
 static
-bool address_prefix_init(address_prefix_t* address_prefix, char* str_prefix)
+bool address_prefix_init(address_prefix_t* address_prefix,
+                         const sys_xpath_key_t *prefix)
 {
-    ARG_CHECK2(false, address_prefix, str_prefix);
+    char address[INET6_ADDRSTRLEN] = {0};
+
+    ARG_CHECK2(false, address_prefix, prefix);
 
-    address_prefix->length = ip_prefix_split(str_prefix);
-    if(address_prefix->length < 1)
+    int length = ip_prefix_parse(prefix->value, prefix->value_len, address,
+                                 sizeof(address));
+
+    address_prefix->is_ipv6 = (NULL != strchr(address, ':'));
+    if (length < 1)
     {
         SRP_LOG_ERR_MSG("not a valid prefix");
         return false;
     }
+    address_prefix->length = length;
 
-    return bapi_aton(str_prefix, address_prefix->address);
+    return 1 == inet_pton(address_prefix->is_ipv6 ? AF_INET6 : AF_INET,
+                          address, address_prefix->address);
 }
 
 // XPATH: /openconfig-local-routing:local-routes/static-routes/static/state
 int openconfig_local_routing_local_routes_static_routes_static_state_vapi_cb(
-    vapi_payload_ip_fib_details *reply,
+    const sc_fib_route_t *reply,
     sysr_ip_fib_details_ctx_t *sysr_ip_fib_details_ctx)
 {
-    sr_val_t *vals = NULL;
-    int rc = 0;
-    int vc = 0;
-    char address_prefix[INET_ADDRSTRLEN + 3] = {0};
-    vc = 1;
+    sysr_values_ctx_t *sysr_values_ctx = NULL;
+    char address[INET6_ADDRSTRLEN] = {0};
+    char address_prefix[INET6_ADDRSTRLEN + 4] = {0};
 
     ARG_CHECK2(SR_ERR_INVAL_ARG, reply, sysr_ip_fib_details_ctx);
 
-    rc = sr_new_values(vc, &vals);
-    if (SR_ERR_OK != rc) {
-        return rc;
+    sysr_values_ctx = &sysr_ip_fib_details_ctx->sysr_values_ctx;
+    if (SR_ERR_OK != sc_vals_entry(&sysr_values_ctx->vals, "%s",
+                                   sysr_values_ctx->xpath_root)) {
+        return sysr_values_ctx->vals.rc;
     }
 
     //Filling the structure
+    inet_ntop(reply->is_ipv6 ? AF_INET6 : AF_INET, reply->address,
+              address, sizeof(address));
     snprintf(address_prefix, sizeof(address_prefix), "%s/%u",
-             bapi_ntoa(reply->address), reply->address_length);
-
-    sr_val_build_xpath(&vals[0], "%s/prefix",
-                       sysr_ip_fib_details_ctx->sysr_values_ctx.xpath_root);
-    sr_val_set_str_data(&vals[0], SR_STRING_T, address_prefix);
+             address, reply->address_length);
 
-    sysr_ip_fib_details_ctx->sysr_values_ctx.values = vals;
-    sysr_ip_fib_details_ctx->sysr_values_ctx.values_cnt = vc;
-
-    return SR_ERR_OK;
-}
-
-vapi_error_e
-ip_routing_dump_cb (struct vapi_ctx_s *ctx, void *callback_ctx,
-                vapi_error_e rv, bool is_last,
-                vapi_payload_ip_fib_details * reply)
-{
-    if (is_last)
-    {
-        assert (NULL == reply);
-    }
-    else
-    {
-        sysr_ip_fib_details_ctx_t *dctx = callback_ctx;
-        assert(dctx && reply);
-
-        if (address_prefix_cmp(&dctx->address_prefix, reply))
-        {
-            openconfig_local_routing_local_routes_static_routes_static_state_vapi_cb(reply,
-                                                                        dctx);
-        }
-    }
-
-    return VAPI_OK;
+    return sc_vals_leaf_str(&sysr_values_ctx->vals, "prefix", SR_STRING_T,
+                            address_prefix);
 }
 
 int openconfig_local_routing_local_routes_static_routes_static_state_cb(
     const char *xpath, sr_val_t **values, size_t *values_cnt,
-    __attribute__((unused)) uint64_t request_id,
+    uint64_t request_id,
     __attribute__((unused)) void *private_ctx)
 {
-    sr_xpath_ctx_t state = {0};
-    vapi_error_e rv = 0;
-    char *tmp = NULL;
-    char static_prefix[XPATH_SIZE] = {0};
+    sys_xpath_keys_t keys;
+    const sys_xpath_key_t *static_prefix = NULL;
     sysr_ip_fib_details_ctx_t dctx = {0};
+    const sc_fib_route_t *entry = NULL;
+    sys_request_t *req = NULL;
 
     ARG_CHECK3(SR_ERR_INVAL_ARG, xpath, values, values_cnt);
 
-    tmp = xpath_find_first_key(xpath, "prefix", &state);
-    if (NULL == tmp) {
+    if (0 != xpath_keys_parse(xpath, &keys) ||
+        NULL == (static_prefix = xpath_keys_find(&keys, "prefix"))) {
         SRP_LOG_ERR_MSG("static_prefix not found.");
         return SR_ERR_INVAL_ARG;
     }
 
-    strncpy(static_prefix, tmp, XPATH_SIZE);
-    sr_xpath_recover(&state);
-
     //VPP callback
-    snprintf(dctx.sysr_values_ctx.xpath_root, XPATH_SIZE, "/openconfig-local-routing:local-routes/static-routes/static[prefix='%s']/state", static_prefix);
+    snprintf(dctx.sysr_values_ctx.xpath_root, XPATH_SIZE, "/openconfig-local-routing:local-routes/static-routes/static[prefix='%.*s']/state",
+             XPATH_KEY_ARG(static_prefix));
 
     if (!address_prefix_init(&dctx.address_prefix, static_prefix))
     {
@@ -510,172 +499,160 @@ int openconfig_local_routing_local_routes_static_routes_static_state_cb(
     }
 
 
-    vapi_msg_ip_fib_dump *mp = vapi_alloc_ip_fib_dump (g_vapi_ctx);
+    if (NULL == (req = sys_request_get(request_id)))
+    {
+        return SR_ERR_NOMEM;
+    }
+
+    if (SR_ERR_OK != sc_vals_init(&dctx.sysr_values_ctx.vals, 1))
+    {
+        sys_request_put(req);
+        return dctx.sysr_values_ctx.vals.rc;
+    }
 
-    VAPI_CALL(vapi_ip_fib_dump(g_vapi_ctx, mp, ip_routing_dump_cb, &dctx));
-    if(VAPI_OK != rv)
+    /* every static route of the request reads the same FIB dump */
+    if (0 != sys_request_fib_read_lock(req))
     {
         SRP_LOG_ERR_MSG("VAPI call failed");
+        sys_request_put(req);
+        sc_vals_free(&dctx.sysr_values_ctx.vals);
         return SR_ERR_INVAL_ARG;
     }
 
-    sr_xpath_recover(&state);
-    *values = dctx.sysr_values_ctx.values;
-    *values_cnt = dctx.sysr_values_ctx.values_cnt;
+    entry = fib_find_prefix(&dctx.address_prefix);
+    if (NULL != entry)
+    {
+        openconfig_local_routing_local_routes_static_routes_static_state_vapi_cb(entry,
+                                                                    &dctx);
+    }
+    sc_fib_read_unlock();
+    sys_request_put(req);
 
-    return SR_ERR_OK;
+    return sc_vals_finish(&dctx.sysr_values_ctx.vals, values, values_cnt);
 }
 
 // // XPATH: /openconfig-local-routing:local-routes/static-routes/l/next-hops/next-hop/state
 int openconfig_local_routing_local_routes_static_routes_static_next_hops_next_hop_state_vapi_cb(
-    vapi_type_fib_path *reply,
+    const sc_fib_path_t *reply,
     sysr_ip_fib_details_ctx_t *sysr_ip_fib_details_ctx)
 {
-    sr_val_t *vals = NULL;
-    int rc = 0;
-    int vc = 0;
-    char next_hop[INET_ADDRSTRLEN] = {0};
+    sc_vals_t *vals = NULL;
+    sr_val_t *val = NULL;
+    char next_hop[INET6_ADDRSTRLEN] = {0};
 
     ARG_CHECK2(SR_ERR_INVAL_ARG, reply, sysr_ip_fib_details_ctx);
 
-    vc = 3;
-    /* convenient functions such as this can be found in sysrepo/values.h */
-    rc = sr_new_values(vc, &vals);
-    if (SR_ERR_OK != rc) {
-        return rc;
+    vals = &sysr_ip_fib_details_ctx->sysr_values_ctx.vals;
+    if (SR_ERR_OK != sc_vals_entry(vals, "%s", sysr_ip_fib_details_ctx->sysr_values_ctx.xpath_root)) {
+        return vals->rc;
     }
 
-    sr_val_build_xpath(&vals[0], "%s/index",
-                       sysr_ip_fib_details_ctx->sysr_values_ctx.xpath_root);
-    sr_val_set_str_data(&vals[0], SR_STRING_T,
-                        sysr_ip_fib_details_ctx->next_hop_index);
-
-    strncpy(next_hop, bapi_ntoa(reply->next_hop), sizeof(next_hop));
-    sr_val_build_xpath(&vals[1], "%s/next-hop", sysr_ip_fib_details_ctx->sysr_values_ctx.xpath_root);
-    sr_val_set_str_data(&vals[1], SR_STRING_T, next_hop);
+    if (NULL != (val = sc_vals_leaf(vals, "index"))) {
+        vals->rc = sr_val_build_str_data(val, SR_STRING_T, "%.*s",
+                       XPATH_KEY_ARG(sysr_ip_fib_details_ctx->next_hop_index));
+    }
 
-    sr_val_build_xpath(&vals[2], "%s/metric", sysr_ip_fib_details_ctx->sysr_values_ctx.xpath_root);
-    vals[2].type = SR_UINT32_T;
-    vals[2].data.uint32_val = reply->weight;
+    inet_ntop(sysr_ip_fib_details_ctx->address_prefix.is_ipv6 ? AF_INET6 : AF_INET,
+              reply->next_hop, next_hop, sizeof(next_hop));
+    sc_vals_leaf_str(vals, "next-hop", SR_STRING_T, next_hop);
 
-    // sr_val_build_xpath(&vals[3], "%s/recurse", sysr_ip_fib_details_ctx->sysr_values_ctx.xpath_root);
-    // vals[3].type = SR_BOOL_T;
-    // vals[3].data.bool_val = YANG INPUT TYPE: boolean;
+    if (NULL != (val = sc_vals_leaf(vals, "metric"))) {
+        val->type = SR_UINT32_T;
+        val->data.uint32_val = reply->weight;
+    }
 
-    sysr_ip_fib_details_ctx->sysr_values_ctx.values = vals;
-    sysr_ip_fib_details_ctx->sysr_values_ctx.values_cnt = vc;
+    // sc_vals_leaf(vals, "recurse");  YANG INPUT TYPE: boolean
 
-    return SR_ERR_OK;
+    return vals->rc;
 }
 
 // // XPATH: /openconfig-local-routing:local-routes/static-routes/l/next-hops/next-hop/interface-ref/state
 int openconfig_local_routing_local_routes_static_routes_static_next_hops_next_hop_interface_ref_state_vapi_cb(
     sysr_ip_fib_details_ctx_t * dctx)
 {
-    sr_val_t *vals = NULL;
-    int rc = 0;
-    int vc = 0;
+    sc_vals_t *vals = NULL;
+    sr_val_t *val = NULL;
 
     ARG_CHECK(SR_ERR_INVAL_ARG, dctx);
 
-    vc = 2;
-    /* convenient functions such as this can be found in sysrepo/values.h */
-    rc = sr_new_values(vc, &vals);
-    if (SR_ERR_OK != rc) {
-        return rc;
+    vals = &dctx->sysr_values_ctx.vals;
+    if (SR_ERR_OK != sc_vals_entry(vals, "%s", dctx->sysr_values_ctx.xpath_root)) {
+        return vals->rc;
     }
 
-    sr_val_build_xpath(&vals[0], "%s/interface",
-                       dctx->sysr_values_ctx.xpath_root);
-    sr_val_set_str_data(&vals[0], SR_STRING_T,
-        (const char*)dctx->sw_interface_details_query.sw_interface_details.interface_name);
-
-    sr_val_build_xpath(&vals[1], "%s/subinterface",
-                       dctx->sysr_values_ctx.xpath_root);
-    vals[1].type = SR_UINT32_T;
-    vals[1].data.uint32_val = 0;
+    sc_vals_leaf_str(vals, "interface", SR_STRING_T,
+                     (const char*)dctx->sw_interface_details_query.sw_interface_details.interface_name);
 
-    dctx->sysr_values_ctx.values = vals;
-    dctx->sysr_values_ctx.values_cnt = vc;
+    if (NULL != (val = sc_vals_leaf(vals, "subinterface"))) {
+        val->type = SR_UINT32_T;
+        val->data.uint32_val = 0;
+    }
 
-    return SR_ERR_OK;
+    return vals->rc;
 }
 
-vapi_error_e
-ip_routing_next_hop_dump_cb (struct vapi_ctx_s *ctx, void *callback_ctx,
-                vapi_error_e rv, bool is_last,
-                vapi_payload_ip_fib_details * reply)
+static void
+ip_routing_next_hop_lookup(sysr_ip_fib_details_ctx_t *dctx)
 {
-    ARG_CHECK(VAPI_EINVAL, callback_ctx);
+    const sc_fib_route_t *entry = fib_find_prefix(&dctx->address_prefix);
 
-    sysr_ip_fib_details_ctx_t *dctx = callback_ctx;
+    if (NULL == entry || entry->n_paths == 0)
+        return;
 
-    if (is_last)
+    if (dctx->is_interface_ref)
     {
-        assert (NULL == reply);
+        dctx->sw_interface_details_query.interface_found = true;
+        dctx->sw_interface_details_query.sw_interface_details.sw_if_index =
+            entry->paths[0].sw_if_index;
+        //sw_interface_dump will have to be called outside this lookup
     }
     else
     {
-        assert (NULL != reply);
-
-        if (reply->count > 0 && address_prefix_cmp(&dctx->address_prefix, reply))
-        {
-            if (dctx->is_interface_ref)
-            {
-                dctx->sw_interface_details_query.interface_found = true;
-                dctx->sw_interface_details_query.sw_interface_details.sw_if_index = reply->path[0].sw_if_index;
-                //sw_interface_dump will have to be called outside this VAPI
-            }
-            else
-            {
-                openconfig_local_routing_local_routes_static_routes_static_next_hops_next_hop_state_vapi_cb(reply->path, dctx);
-            }
-        }
+        openconfig_local_routing_local_routes_static_routes_static_next_hops_next_hop_state_vapi_cb(
+            &entry->paths[0], dctx);
     }
-
-    return VAPI_OK;
 }
 
 int next_hop_inner(
     bool is_interface_ref, const char *xpath, sr_val_t **values,
-    size_t *values_cnt, __attribute__((unused)) uint64_t request_id,
+    size_t *values_cnt, uint64_t request_id,
     __attribute__((unused)) void *private_ctx)
 {
-    sr_xpath_ctx_t state = {0};
-    vapi_error_e rv;
-    char *tmp = NULL;
-    char static_prefix[XPATH_SIZE] = {0};
-    char next_hop_index[XPATH_SIZE] = {0};
+    sys_xpath_keys_t keys;
+    const sys_xpath_key_t *static_prefix = NULL;
+    const sys_xpath_key_t *next_hop_index = NULL;
     sysr_ip_fib_details_ctx_t dctx = {.is_interface_ref = is_interface_ref};
+    sys_request_t *req = NULL;
+    const scVppIntfc *intfc = NULL;
 
     ARG_CHECK3(SR_ERR_INVAL_ARG, xpath, values, values_cnt);
 
-    tmp = xpath_find_first_key(xpath, "prefix", &state);
-    if (NULL == tmp) {
+    /* both keys in a single pass over the xpath */
+    if (0 != xpath_keys_parse(xpath, &keys)) {
+        SRP_LOG_ERR_MSG("xpath not valid.");
+        return SR_ERR_INVAL_ARG;
+    }
+
+    if (NULL == (static_prefix = xpath_keys_find(&keys, "prefix"))) {
         SRP_LOG_ERR_MSG("static_prefix not found.");
         return SR_ERR_INVAL_ARG;
     }
-    strncpy(static_prefix, tmp, XPATH_SIZE);
-    sr_xpath_recover(&state);
 
-    tmp = xpath_find_first_key(xpath, "index", &state);
-    if (NULL == tmp) {
+    if (NULL == (next_hop_index = xpath_keys_find(&keys, "index"))) {
         SRP_LOG_ERR_MSG("index not found.");
         return SR_ERR_INVAL_ARG;
     }
-    strncpy(next_hop_index, tmp, XPATH_SIZE);
-    sr_xpath_recover(&state);
 
     //VPP callback
     dctx.next_hop_index = next_hop_index;
     if (is_interface_ref) {
         snprintf(dctx.sysr_values_ctx.xpath_root, XPATH_SIZE,
-        "/openconfig-local-routing:local-routes/static-routes/static[prefix='%s']/next-hops/next-hop[index='%s']/interface-ref/state",
-        static_prefix, next_hop_index);
+        "/openconfig-local-routing:local-routes/static-routes/static[prefix='%.*s']/next-hops/next-hop[index='%.*s']/interface-ref/state",
+        XPATH_KEY_ARG(static_prefix), XPATH_KEY_ARG(next_hop_index));
     } else {
         snprintf(dctx.sysr_values_ctx.xpath_root, XPATH_SIZE,
-        "/openconfig-local-routing:local-routes/static-routes/static[prefix='%s']/next-hops/next-hop[index='%s']/state",
-        static_prefix, next_hop_index);
+        "/openconfig-local-routing:local-routes/static-routes/static[prefix='%.*s']/next-hops/next-hop[index='%.*s']/state",
+        XPATH_KEY_ARG(static_prefix), XPATH_KEY_ARG(next_hop_index));
     }
 
     if (!address_prefix_init(&dctx.address_prefix, static_prefix))
@@ -683,34 +660,53 @@ int next_hop_inner(
         return SR_ERR_INVAL_ARG;
     }
 
-    vapi_msg_ip_fib_dump *mp = vapi_alloc_ip_fib_dump (g_vapi_ctx);
-    VAPI_CALL(vapi_ip_fib_dump(g_vapi_ctx, mp, ip_routing_next_hop_dump_cb, &dctx));
-    if (VAPI_OK != rv)
+    if (NULL == (req = sys_request_get(request_id)))
+    {
+        return SR_ERR_NOMEM;
+    }
+
+    if (SR_ERR_OK != sc_vals_init(&dctx.sysr_values_ctx.vals, 3))
+    {
+        sys_request_put(req);
+        return dctx.sysr_values_ctx.vals.rc;
+    }
+
+    if (0 != sys_request_fib_read_lock(req))
     {
         SRP_LOG_ERR_MSG("VAPI call failed");
+        sys_request_put(req);
+        sc_vals_free(&dctx.sysr_values_ctx.vals);
         return SR_ERR_INVAL_ARG;
     }
 
+    ip_routing_next_hop_lookup(&dctx);
+    sc_fib_read_unlock();
+
     if (is_interface_ref)
     {
         if (dctx.sw_interface_details_query.interface_found)
         {
-            if (!get_interface_name(&dctx.sw_interface_details_query))
+            /* name of the next hop interface from the request snapshot */
+            intfc = sc_interface_snapshot_find_index(sys_request_interfaces(req),
+                dctx.sw_interface_details_query.sw_interface_details.sw_if_index);
+            if (NULL == intfc)
             {
+                sys_request_put(req);
+                sc_vals_free(&dctx.sysr_values_ctx.vals);
                 return SR_ERR_INVAL_ARG;
             }
+            strncpy((char *)dctx.sw_interface_details_query.sw_interface_details.interface_name,
+                    intfc->interface_name,
+                    sizeof(dctx.sw_interface_details_query.sw_interface_details.interface_name) - 1);
             if (strlen((const char*)
                 dctx.sw_interface_details_query.sw_interface_details.interface_name)) {
                 openconfig_local_routing_local_routes_static_routes_static_next_hops_next_hop_interface_ref_state_vapi_cb(&dctx);
             }
         }
     }
+    sys_request_put(req);
 
-    sr_xpath_recover(&state);
-    *values = dctx.sysr_values_ctx.values;
-    *values_cnt = dctx.sysr_values_ctx.values_cnt;
-
-    return SR_ERR_OK;
+    return sc_vals_finish(&dctx.sysr_values_ctx.vals, values, values_cnt);
 }
 
 int openconfig_local_routing_local_routes_static_routes_static_next_hops_next_hop_state_cb(
@@ -18,6 +18,7 @@
 #include "sys_util.h"
 #include "openconfig_interfaces.h"
 #include "openconfig_local_routing.h"
+#include "sys_request.h"
 #include "sc_vpp_operation.h"
 
 #include <assert.h>
@@ -262,4 +263,7 @@ void openconfig_unsubscribe(plugin_main_t* plugin_main)
             free(tmp);
         } while (plugin_subcscription != NULL);
     }
+
+    /* no callback runs anymore, the last request would stay pinned */
+    sys_request_cleanup();
 }
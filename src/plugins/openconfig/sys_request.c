@@ -0,0 +1,377 @@
+/*
+ * Copyright (c) 2018 PANTHEON.tech.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sys_request.h"
+#include "sc_vpp_fib.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+/* longer than the gaps between the callbacks of one request */
+#define SYS_REQUEST_IDLE_MS 2000
+
+typedef struct
+{
+    u32 sw_if_index;
+    sc_if_addrs_t addrs;
+} sys_request_addrs_t;
+
+struct _sys_request
+{
+    uint64_t request_id;
+    unsigned int refcnt;
+    uint64_t last_used_ms;
+    pthread_mutex_t lock;       /* serializes the loads below */
+    sc_snapshot_ref_t *interfaces_ref;
+    const sc_sw_interface_dump_ctx *interfaces;
+    u32 fib_generation;
+    sys_request_addrs_t *addrs;
+    size_t n_addrs;
+    size_t cap_addrs;
+    struct _sys_request *next;
+};
+
+static sys_request_t *g_requests = NULL;
+static pthread_mutex_t g_requests_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* releases the contexts once idle, its state is under g_requests_lock */
+static struct
+{
+    pthread_cond_t wakeup;
+    pthread_t thread;
+    bool running;
+    bool stop;
+} g_reaper;
+
+static uint64_t now_ms()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void sys_request_free(sys_request_t *req)
+{
+    size_t i;
+
+    sc_interface_snapshot_release(req->interfaces_ref);
+    for (i = 0; i < req->n_addrs; i++) {
+        sc_interface_addrs_free(&req->addrs[i].addrs);
+    }
+    free(req->addrs);
+    pthread_mutex_destroy(&req->lock);
+    free(req);
+}
+
+static void sys_request_free_list(sys_request_t *list)
+{
+    while (NULL != list) {
+        sys_request_t *next = list->next;
+        sys_request_free(list);
+        list = next;
+    }
+}
+
+/*
+ * Unlink the contexts of the requests that are over, called with
+ * g_requests_lock held. Their dumps are released outside the lock.
+ * next_ms is set to the time the next unused context expires, 0 if none.
+ */
+static sys_request_t *sys_request_reap(uint64_t now, uint64_t *next_ms)
+{
+    sys_request_t **pp = NULL;
+    sys_request_t *idle = NULL;
+    uint64_t expiry;
+
+    *next_ms = 0;
+    for (pp = &g_requests; NULL != *pp;) {
+        sys_request_t *cur = *pp;
+
+        if (0 == cur->refcnt) {
+            expiry = cur->last_used_ms + SYS_REQUEST_IDLE_MS + 1;
+            if (now >= expiry) {
+                *pp = cur->next;
+                cur->next = idle;
+                idle = cur;
+                continue;
+            }
+            if (0 == *next_ms || expiry < *next_ms) {
+                *next_ms = expiry;
+            }
+        }
+        pp = &cur->next;
+    }
+
+    return idle;
+}
+
+static void *sys_request_reaper(void *arg)
+{
+    sys_request_t *idle = NULL;
+    struct timespec deadline;
+    uint64_t next = 0;
+
+    (void)arg;
+
+    pthread_mutex_lock(&g_requests_lock);
+    while (!g_reaper.stop) {
+        idle = sys_request_reap(now_ms(), &next);
+        if (NULL != idle) {
+            pthread_mutex_unlock(&g_requests_lock);
+            sys_request_free_list(idle);
+            pthread_mutex_lock(&g_requests_lock);
+            continue;
+        }
+        if (0 == next) {
+            /* woken up by the put of a last reference */
+            pthread_cond_wait(&g_reaper.wakeup, &g_requests_lock);
+            continue;
+        }
+        deadline.tv_sec = next / 1000;
+        deadline.tv_nsec = (next % 1000) * 1000000L;
+        pthread_cond_timedwait(&g_reaper.wakeup, &g_requests_lock, &deadline);
+    }
+    pthread_mutex_unlock(&g_requests_lock);
+
+    return NULL;
+}
+
+/* called with g_requests_lock held */
+static void sys_request_reaper_start()
+{
+    pthread_condattr_t attr;
+
+    if (g_reaper.running) {
+        return;
+    }
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&g_reaper.wakeup, &attr);
+    pthread_condattr_destroy(&attr);
+
+    g_reaper.stop = false;
+    if (0 != pthread_create(&g_reaper.thread, NULL, sys_request_reaper, NULL)) {
+        /* contexts are still reaped by the next get or put */
+        SRP_LOG_WRN_MSG("Unable to start the request context reaper.");
+        pthread_cond_destroy(&g_reaper.wakeup);
+        return;
+    }
+    g_reaper.running = true;
+}
+
+sys_request_t *sys_request_get(uint64_t request_id)
+{
+    sys_request_t *req = NULL;
+    sys_request_t *idle = NULL;
+    uint64_t now = now_ms();
+    uint64_t next = 0;
+
+    pthread_mutex_lock(&g_requests_lock);
+    sys_request_reaper_start();
+    idle = sys_request_reap(now, &next);
+    for (req = g_requests; NULL != req; req = req->next) {
+        if (req->request_id == request_id) {
+            break;
+        }
+    }
+
+    if (NULL == req && NULL != (req = calloc(1, sizeof(*req)))) {
+        req->request_id = request_id;
+        pthread_mutex_init(&req->lock, NULL);
+        req->next = g_requests;
+        g_requests = req;
+    }
+    if (NULL != req) {
+        req->refcnt++;
+        req->last_used_ms = now;
+    }
+    pthread_mutex_unlock(&g_requests_lock);
+
+    sys_request_free_list(idle);
+
+    return req;
+}
+
+void sys_request_put(sys_request_t *req)
+{
+    sys_request_t *idle = NULL;
+    uint64_t now = now_ms();
+    uint64_t next = 0;
+
+    if (NULL == req) {
+        return;
+    }
+
+    pthread_mutex_lock(&g_requests_lock);
+    req->refcnt--;
+    req->last_used_ms = now;
+    if (0 == req->refcnt && g_reaper.running) {
+        /* the reaper releases it once idle, even if no request follows */
+        pthread_cond_signal(&g_reaper.wakeup);
+    }
+    idle = sys_request_reap(now, &next);
+    pthread_mutex_unlock(&g_requests_lock);
+
+    sys_request_free_list(idle);
+}
+
+void sys_request_cleanup()
+{
+    sys_request_t *all = NULL;
+    bool running = false;
+
+    pthread_mutex_lock(&g_requests_lock);
+    all = g_requests;
+    g_requests = NULL;
+    running = g_reaper.running;
+    g_reaper.stop = true;
+    g_reaper.running = false;
+    if (running) {
+        pthread_cond_signal(&g_reaper.wakeup);
+    }
+    pthread_mutex_unlock(&g_requests_lock);
+
+    if (running) {
+        pthread_join(g_reaper.thread, NULL);
+        pthread_cond_destroy(&g_reaper.wakeup);
+    }
+    sys_request_free_list(all);
+}
+
+const sc_sw_interface_dump_ctx *sys_request_interfaces(sys_request_t *req)
+{
+    const sc_sw_interface_dump_ctx *interfaces = NULL;
+
+    pthread_mutex_lock(&req->lock);
+    if (NULL == req->interfaces) {
+        sc_interface_snapshot_release(req->interfaces_ref);
+        req->interfaces_ref = NULL;
+        /* a failed dump is retried by the next callback */
+        req->interfaces = sc_interface_snapshot_acquire(&req->interfaces_ref);
+    }
+    interfaces = req->interfaces;
+    pthread_mutex_unlock(&req->lock);
+
+    return interfaces;
+}
+
+int sys_request_fib_read_lock(sys_request_t *req)
+{
+    u32 generation;
+
+    pthread_mutex_lock(&req->lock);
+    generation = req->fib_generation;
+    pthread_mutex_unlock(&req->lock);
+
+    if (0 != sc_fib_read_lock_pinned(&generation)) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&req->lock);
+    req->fib_generation = generation;
+    pthread_mutex_unlock(&req->lock);
+
+    return 0;
+}
+
+static int addr4_cmp(const void *a, const void *b)
+{
+    return memcmp(((const sc_ip_addr_t *)a)->address,
+                  ((const sc_ip_addr_t *)b)->address, VPP_IP4_ADDRESS_LEN);
+}
+
+static int addr6_cmp(const void *a, const void *b)
+{
+    return memcmp(((const sc_ip_addr_t *)a)->address,
+                  ((const sc_ip_addr_t *)b)->address, VPP_IP6_ADDRESS_LEN);
+}
+
+/* called with req->lock held */
+static sys_request_addrs_t *sys_request_addrs(sys_request_t *req,
+                                              u32 sw_if_index)
+{
+    sys_request_addrs_t *entry = NULL;
+    size_t i;
+
+    for (i = 0; i < req->n_addrs; i++) {
+        if (req->addrs[i].sw_if_index == sw_if_index) {
+            return &req->addrs[i];
+        }
+    }
+
+    if (req->n_addrs == req->cap_addrs) {
+        size_t cap = req->cap_addrs ? req->cap_addrs * 2 : 4;
+        entry = realloc(req->addrs, cap * sizeof(*entry));
+        if (NULL == entry) {
+            return NULL;
+        }
+        req->addrs = entry;
+        req->cap_addrs = cap;
+    }
+
+    entry = &req->addrs[req->n_addrs];
+    memset(entry, 0, sizeof(*entry));
+    entry->sw_if_index = sw_if_index;
+    if (0 != sc_interface_addr_dump(g_vapi_ctx_instance, sw_if_index, &entry->addrs)) {
+        sc_interface_addrs_free(&entry->addrs);
+        return NULL;
+    }
+    req->n_addrs++;
+
+    /* sorted once, every address of the interface is then a bsearch away */
+    if (entry->addrs.n_addrs[0] > 1) {
+        qsort(entry->addrs.addrs[0], entry->addrs.n_addrs[0],
+              sizeof(sc_ip_addr_t), addr4_cmp);
+    }
+    if (entry->addrs.n_addrs[1] > 1) {
+        qsort(entry->addrs.addrs[1], entry->addrs.n_addrs[1],
+              sizeof(sc_ip_addr_t), addr6_cmp);
+    }
+
+    return entry;
+}
+
+int sys_request_addr_find(sys_request_t *req, u32 sw_if_index, bool is_ipv6,
+                          const u8 *address, const sc_ip_addr_t **addr)
+{
+    sys_request_addrs_t *entry = NULL;
+    sc_ip_addr_t key = {0};
+    int rc = -1;
+
+    memcpy(key.address, address,
+           is_ipv6 ? VPP_IP6_ADDRESS_LEN : VPP_IP4_ADDRESS_LEN);
+
+    pthread_mutex_lock(&req->lock);
+    entry = sys_request_addrs(req, sw_if_index);
+    if (NULL != entry) {
+        /* the arrays do not move until the request is released */
+        *addr = NULL;
+        if (0 != entry->addrs.n_addrs[is_ipv6]) {
+            *addr = bsearch(&key, entry->addrs.addrs[is_ipv6],
+                            entry->addrs.n_addrs[is_ipv6],
+                            sizeof(sc_ip_addr_t),
+                            is_ipv6 ? addr6_cmp : addr4_cmp);
+        }
+        rc = 0;
+    }
+    pthread_mutex_unlock(&req->lock);
+
+    return rc;
+}
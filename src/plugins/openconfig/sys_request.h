@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2018 PANTHEON.tech.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __SYS_REQUEST_H__
+#define __SYS_REQUEST_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../sc_interface.h"
+
+/*
+ * VPP data shared by all the data-provider callbacks of one sysrepo request.
+ *
+ * A client get fans out into one callback per list entry, they all read the
+ * same interface snapshot, FIB dump and per-interface address lists, so one
+ * get costs one VPP dump per table. sysrepo 0.7 does not tell when a request
+ * ends, a background thread releases a context once it has not been used
+ * for SYS_REQUEST_IDLE_MS.
+ */
+typedef struct _sys_request sys_request_t;
+
+/* Context of request_id, created on first use, NULL on no memory. */
+sys_request_t *sys_request_get(uint64_t request_id);
+void sys_request_put(sys_request_t *req);
+
+/* Stop the reaper and release every context, once the callbacks are
+ * unsubscribed. */
+void sys_request_cleanup();
+
+/* Interface snapshot of the request, NULL when the dump failed. */
+const sc_sw_interface_dump_ctx *sys_request_interfaces(sys_request_t *req);
+
+/* sc_fib_read_lock() reading the same FIB dump for the whole request. */
+int sys_request_fib_read_lock(sys_request_t *req);
+
+/*
+ * Look an address up in the address table of an interface. The table is
+ * filled by one ip_address_dump per request and sorted, *addr is NULL when
+ * the interface does not have the address. -1 when the dump failed.
+ */
+int sys_request_addr_find(sys_request_t *req, u32 sw_if_index, bool is_ipv6,
+                          const u8 *address, const sc_ip_addr_t **addr);
+
+#endif /* __SYS_REQUEST_H__ */
@@ -18,21 +18,96 @@
 #include "sc_vpp_operation.h"
 
 #include <string.h>
+#include <ctype.h>
 #include <vppinfra/types.h>
 
-char* xpath_find_first_key(const char *xpath, char *key, sr_xpath_ctx_t *state)
+int xpath_keys_parse(const char *xpath, sys_xpath_keys_t *keys)
 {
-    char *value = NULL;
+    const char *p = xpath;
+    const char *name, *name_end, *value, *colon;
+    sys_xpath_key_t *key = NULL;
+    char quote;
 
-    if (sr_xpath_next_node((char *)xpath, state) == NULL) {
-        return NULL;
+    keys->keys_cnt = 0;
+
+    while (NULL != (p = strchr(p, '['))) {
+        /* [name='value'], quotes may be ' or " */
+        name = ++p;
+        while ('\0' != *p && '=' != *p && ']' != *p) {
+            p++;
+        }
+        if (']' == *p) {
+            continue;           /* positional predicate */
+        }
+        if ('=' != *p) {
+            return -1;
+        }
+
+        name_end = p++;
+        while (name_end > name && isspace((unsigned char)name_end[-1])) {
+            name_end--;
+        }
+        while (isspace((unsigned char)*p)) {
+            p++;
+        }
+
+        quote = *p;
+        if ('\'' != quote && '"' != quote) {
+            return -1;
+        }
+        value = ++p;
+        if (NULL == (p = strchr(p, quote))) {
+            return -1;
+        }
+
+        if (keys->keys_cnt == SYS_XPATH_KEYS_MAX) {
+            return -1;
+        }
+        key = &keys->keys[keys->keys_cnt++];
+        colon = memchr(name, ':', name_end - name);
+        key->name = (NULL != colon) ? colon + 1 : name;
+        key->name_len = name_end - key->name;
+        key->value = value;
+        key->value_len = p - value;
+
+        p++;
+        while (isspace((unsigned char)*p)) {
+            p++;
+        }
+        if (']' != *p) {
+            return -1;
+        }
     }
 
-    while (((value = sr_xpath_node_key_value(NULL,
-            key, state)) == NULL) &&
-            (sr_xpath_next_node(NULL, state) != NULL));
+    return 0;
+}
 
-    return value;
+const sys_xpath_key_t *xpath_keys_find(const sys_xpath_keys_t *keys,
+                                       const char *name)
+{
+    size_t name_len = strlen(name);
+    size_t i;
+
+    for (i = 0; i < keys->keys_cnt; i++) {
+        if (keys->keys[i].name_len == name_len &&
+            0 == memcmp(keys->keys[i].name, name, name_len)) {
+            return &keys->keys[i];
+        }
+    }
+
+    return NULL;
+}
+
+int xpath_key_copy(const sys_xpath_key_t *key, char *buf, size_t size)
+{
+    if (key->value_len >= size) {
+        return -1;
+    }
+
+    memcpy(buf, key->value, key->value_len);
+    buf[key->value_len] = '\0';
+
+    return 0;
 }
 
 // we can call sr_get_item after change is called to see if the value has or has not
@@ -62,21 +137,36 @@ void log_recv_oper(sr_change_oper_t oper, const char *msg) {
     SRP_LOG_DBG("%s: %s\n", msg, oper_s);
 }
 
-int ip_prefix_split(const char* ip_prefix)
+int ip_prefix_parse(const char *ip_prefix, size_t len, char *address,
+                    size_t address_size)
 {
     //find the slash
-    char* slash = strchr(ip_prefix, '/');
-    if (NULL == slash)
+    const char *slash = memchr(ip_prefix, '/', len);
+    const char *end = ip_prefix + len;
+    const char *p = NULL;
+    unsigned long mask = 0;
+    unsigned long max_mask = 0;
+
+    if (NULL == slash || slash + 1 == end)
         return -1;
 
+    //an IPv6 address has a colon, an IPv4 one has none
+    max_mask = NULL != memchr(ip_prefix, ':', slash - ip_prefix) ? 128 : 32;
+
     //extract subnet mask length
-    char * eptr = NULL;
-    u8 mask = strtoul(slash + 1, &eptr, 10);
-    if (*eptr || mask <= 0)
+    for (p = slash + 1; p < end; p++) {
+        if (!isdigit((unsigned char)*p) || mask > max_mask)
+            return -1;
+        mask = mask * 10 + (*p - '0');
+    }
+    if (mask <= 0 || mask > max_mask)
         return -1;
 
     //keep just the address part
-    *slash = '\0';         //replace '/' with 0
+    if ((size_t)(slash - ip_prefix) >= address_size)
+        return -1;
+    memcpy(address, ip_prefix, slash - ip_prefix);
+    address[slash - ip_prefix] = '\0';
 
     //return mask length
     return mask;
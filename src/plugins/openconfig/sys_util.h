@@ -20,18 +20,56 @@
 #include <sysrepo.h>
 #include <sysrepo/xpath.h>
 
+#include "../sc_values.h"
+
 #define XPATH_SIZE 2000
 
 typedef struct
 {
     char xpath_root[XPATH_SIZE];
-    sr_val_t * values;
-    size_t values_cnt;
+    sc_vals_t vals;
 } sysr_values_ctx_t;
 
-char* xpath_find_first_key(const char *xpath, char *key, sr_xpath_ctx_t *state);
+/* Key predicate of an xpath, name and value point into the xpath itself. */
+typedef struct
+{
+    const char *name;           /* without the module prefix */
+    size_t name_len;
+    const char *value;
+    size_t value_len;
+} sys_xpath_key_t;
+
+#define SYS_XPATH_KEYS_MAX 8
+
+typedef struct
+{
+    sys_xpath_key_t keys[SYS_XPATH_KEYS_MAX];
+    size_t keys_cnt;
+} sys_xpath_keys_t;
+
+/* printf arguments of a key value, for "%.*s" */
+#define XPATH_KEY_ARG(key) (int)(key)->value_len, (key)->value
+
+/**
+ * Collect every key of an xpath in a single pass, without modifying or
+ * copying it. -1 on a malformed predicate or more than SYS_XPATH_KEYS_MAX keys.
+ */
+int xpath_keys_parse(const char *xpath, sys_xpath_keys_t *keys);
+/* First key called name, NULL if the xpath has none. */
+const sys_xpath_key_t *xpath_keys_find(const sys_xpath_keys_t *keys,
+                                       const char *name);
+/* Copy a key value for APIs that want a C string, -1 if it does not fit. */
+int xpath_key_copy(const sys_xpath_key_t *key, char *buf, size_t size);
+
 void log_recv_event(sr_notif_event_t event, const char *msg);
 void log_recv_oper(sr_change_oper_t oper, const char *msg);
-int ip_prefix_split(const char* ip_prefix);
+
+/**
+ * Split the ip_prefix[0..len) "address/length" into address (NUL terminated)
+ * and return the prefix length, -1 if not a prefix or address is too small.
+ * The length is bounded by 128 for an address with a colon, 32 otherwise.
+ */
+int ip_prefix_parse(const char *ip_prefix, size_t len, char *address,
+                    size_t address_size);
 
 #endif /* __SYS_UTIL_H__ */
@@ -14,20 +14,48 @@
  */
 
 #include <stdio.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 
 #include "sc_interface.h"
+#include "sc_values.h"
+#include "sc_singleflight.h"
+#include "sc_snapshot.h"
+#include "sc_vpp_stats.h"
+#include "sc_batch.h"
 #include <sysrepo.h>
 #include <sysrepo/plugins.h>
 #include <sysrepo/values.h>
 #include <sysrepo/xpath.h>
 #include <vnet/interface.h>
 #include <vapi/interface.api.vapi.h>
+#include <vapi/ip.api.vapi.h>
 
 DEFINE_VAPI_MSG_IDS_INTERFACE_API_JSON;
 
+#define SC_SW_INTERFACE_DUMP_KEY "sw_interface_dump"
+
+/* how long one interface dump serves the readers, about one sysrepo request */
+#define SC_INTERFACE_SNAPSHOT_TTL_MS 500
+
+#define SC_INTERFACE_STATS_KEY "if_stats_read"
+/* one stats segment read serves the statistics of every interface of a poll */
+#define SC_INTERFACE_STATS_TTL_MS 1000
+
+#define SC_INTERFACE_BATCH_APP_NAME "sweetcomb_config"
+/* requests a transaction is sized for, it grows past them */
+#define SC_INTERFACE_OPS_HINT 64
+/* interfaces a change set is sized for, it grows past them */
+#define SC_INTERFACE_CHANGES_HINT 16
+/* every change of the module, the ietf-ip augmentations included */
+#define SC_INTERFACE_CHANGES_XPATH "/ietf-interfaces:*"
+/* longest wait for a change set to be applied or aborted */
+#define SC_INTERFACE_TXN_WAIT_MS 10000
+
 /**
  * @brief Helper function for converting netmask into prefix length.
  */
@@ -65,122 +93,354 @@ ip_addr_str_to_binary(const char *ip_address_str, uint8_t *ip_address_bin, bool
     }
 }
 
-/**
- * @brief Enable or disable given interface.
+/* Connection the batches of configuration changes run on, one at a time. */
+static struct
+{
+    pthread_mutex_t lock;
+    vapi_ctx_t vapi_ctx;        /* opened by the first batch */
+} g_if_batch = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/* One address change of an interface. */
+typedef struct
+{
+    bool add;
+    bool is_ipv6;
+    u8 prefix_length;
+    u8 address[VPP_IP6_ADDRESS_LEN];
+    char *xpath;
+} sc_if_addr_change_t;
+
+/* Changes of one interface in a change set. */
+typedef struct
+{
+    char name[VPP_INTFC_NAME_LEN];
+    char *xpath;                /* first change, reported if the name is invalid */
+    bool deleted;               /* the interface entry itself is deleted */
+    int enabled;                /* -1 if not changed */
+    char *enabled_xpath;
+    sc_if_addr_change_t *addrs;
+    u32 n_addrs;
+    u32 cap_addrs;
+} sc_if_change_t;
+
+static const char *sc_if_change_name(const void *ctx, unsigned int entry);
+
+/*
+ * Requests of the transaction being verified. The module change callback
+ * stages them at SR_EV_VERIFY and runs them all as one batch at
+ * SR_EV_APPLY.
  */
-static int
-interface_enable_disable(const char *if_name, bool enable)
+static struct
 {
-    uint32_t if_index = ~0;
-    int rc = 0;
+    pthread_mutex_t lock;
+    pthread_cond_t idle;        /* in_txn or held was cleared */
+    sc_interface_txn_t txn;
+    bool in_txn;                /* a change set is between verify and apply */
+    bool held;                  /* a reconciliation is applying its batch */
+    u64 generation;             /* change sets verified so far */
+
+    /* only touched by the module change callback */
+    sc_if_change_t *changes;
+    u32 n_changes;
+    u32 cap_changes;
+    sc_name_index_t change_names; /* changes by interface name */
+} g_if_config = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .idle = PTHREAD_COND_INITIALIZER,
+    .change_names = SC_NAME_INDEX_INIT(sc_if_change_name, NULL),
+};
 
-    SRP_LOG_DBG("%s interface '%s'", enable ? "Enabling" : "Disabling", if_name);
+static int
+sc_interface_txn_add(sc_interface_txn_t *txn, const sc_interface_op_t *op, const char *xpath)
+{
+    sc_interface_op_t *ops = NULL;
+    u32 cap;
+
+    if (txn->n_ops == txn->cap_ops) {
+        cap = txn->cap_ops ? 2 * txn->cap_ops : SC_INTERFACE_OPS_HINT;
+        ops = realloc(txn->ops, cap * sizeof(*ops));
+        if (NULL == ops) {
+            return SR_ERR_NOMEM;
+        }
+        txn->ops = ops;
+        txn->cap_ops = cap;
+    }
 
-    /* get interface index */
-    rc = sc_interface_name2index(if_name, &if_index);
-    if (0 != rc) {
-        SRP_LOG_ERR("Invalid interface name: %s", if_name);
-        return SR_ERR_INVAL_ARG;
+    txn->ops[txn->n_ops] = *op;
+    txn->ops[txn->n_ops].xpath = strdup(xpath);
+    if (NULL == txn->ops[txn->n_ops].xpath) {
+        return SR_ERR_NOMEM;
     }
+    txn->n_ops++;
 
-    /* enable/disable interface */
-    rc = sc_setInterfaceFlags(if_index, (uint8_t)enable);
-    if (0 != rc) {
-        SRP_LOG_ERR("Error by processing of the sw_interface_set_flags request, rc=%d", rc);
-        return SR_ERR_OPERATION_FAILED;
-    } else {
-        return SR_ERR_OK;
+    return SR_ERR_OK;
+}
+
+int
+sc_interface_txn_flags(sc_interface_txn_t *txn, u32 sw_if_index, bool enable,
+                       const char *xpath)
+{
+    sc_interface_op_t op = {
+        .kind = SC_INTERFACE_OP_FLAGS,
+        .sw_if_index = sw_if_index,
+        .enable = enable,
+    };
+
+    return sc_interface_txn_add(txn, &op, xpath);
+}
+
+int
+sc_interface_txn_addr(sc_interface_txn_t *txn, u32 sw_if_index, bool add, bool is_ipv6,
+                      u8 prefix_length, const u8 address[VPP_IP6_ADDRESS_LEN],
+                      const char *xpath)
+{
+    sc_interface_op_t op = {
+        .kind = SC_INTERFACE_OP_ADDR,
+        .sw_if_index = sw_if_index,
+        .enable = add,
+        .is_ipv6 = is_ipv6,
+        .prefix_length = prefix_length,
+    };
+
+    memcpy(op.address, address, is_ipv6 ? VPP_IP6_ADDRESS_LEN : VPP_IP4_ADDRESS_LEN);
+    return sc_interface_txn_add(txn, &op, xpath);
+}
+
+void
+sc_interface_txn_clear(sc_interface_txn_t *txn)
+{
+    u32 i;
+
+    for (i = 0; i < txn->n_ops; i++) {
+        free(txn->ops[i].xpath);
     }
+    txn->n_ops = 0;
 }
 
-/**
- * @brief Callback to be called by any config change of "/ietf-interfaces:interfaces/interface/enabled" leaf.
- */
-static int
-sc_interface_enable_disable_cb(sr_session_ctx_t *session, const char *xpath, sr_notif_event_t event, void *private_ctx)
+void
+sc_interface_txn_free(sc_interface_txn_t *txn)
 {
-    char *if_name = NULL;
-    sr_change_iter_t *iter = NULL;
-    sr_change_oper_t op = SR_OP_CREATED;
-    sr_val_t *old_val = NULL;
-    sr_val_t *new_val = NULL;
-    sr_xpath_ctx_t xpath_ctx = { 0, };
-    int rc = SR_ERR_OK, op_rc = SR_ERR_OK;
+    sc_interface_txn_clear(txn);
+    free(txn->ops);
+    txn->ops = NULL;
+    txn->cap_ops = 0;
+}
 
-    /* no-op for apply, we only care about SR_EV_ENABLED, SR_EV_VERIFY, SR_EV_ABORT */
-    if (SR_EV_APPLY == event) {
-        return SR_ERR_OK;
+static vapi_error_e
+sc_interface_txn_send(vapi_ctx_t ctx, uint32_t i, uint32_t context, void *arg)
+{
+    const sc_interface_txn_t *txn = arg;
+    const sc_interface_op_t *op = &txn->ops[i];
+    vapi_msg_sw_interface_set_flags *flags = NULL;
+    vapi_msg_sw_interface_add_del_address *addr = NULL;
+
+    if (SC_INTERFACE_OP_FLAGS == op->kind) {
+        flags = vapi_alloc_sw_interface_set_flags(ctx);
+        if (NULL == flags) {
+            return VAPI_ENOMEM;
+        }
+        flags->header.context = context;
+        flags->payload.sw_if_index = op->sw_if_index;
+        flags->payload.admin_up_down = op->enable;
+        vapi_msg_sw_interface_set_flags_hton(flags);
+        return vapi_send(ctx, flags);
     }
-    SRP_LOG_DBG("'%s' modified, event=%d", xpath, event);
 
-    /* get changes iterator */
-    rc = sr_get_changes_iter(session, xpath, &iter);
-    if (SR_ERR_OK != rc) {
-        SRP_LOG_ERR("Unable to retrieve change iterator: %s", sr_strerror(rc));
-        return rc;
+    addr = vapi_alloc_sw_interface_add_del_address(ctx);
+    if (NULL == addr) {
+        return VAPI_ENOMEM;
     }
+    addr->header.context = context;
+    addr->payload.sw_if_index = op->sw_if_index;
+    addr->payload.is_add = op->enable;
+    addr->payload.is_ipv6 = op->is_ipv6;
+    addr->payload.address_length = op->prefix_length;
+    memcpy(addr->payload.address, op->address, VPP_IP6_ADDRESS_LEN);
+    vapi_msg_sw_interface_add_del_address_hton(addr);
+    return vapi_send(ctx, addr);
+}
 
-    /* iterate over all changes */
-    while ((SR_ERR_OK == op_rc || event == SR_EV_ABORT) &&
-            (SR_ERR_OK == (rc = sr_get_change_next(session, iter, &op, &old_val, &new_val)))) {
+int
+sc_interface_txn_commit(sc_interface_txn_t *txn)
+{
+    sc_batch_result_t *results = NULL;
+    const sc_interface_op_t *op = NULL;
+    bool flags_changed = false;
+    int failed = -1;
+    u32 i;
+
+    if (0 == txn->n_ops) {
+        return 0;
+    }
 
-        SRP_LOG_DBG("A change detected in '%s', op=%d", new_val ? new_val->xpath : old_val->xpath, op);
-        if_name = sr_xpath_key_value(new_val ? new_val->xpath : old_val->xpath, "interface", "name", &xpath_ctx);
-        switch (op) {
-            case SR_OP_CREATED:
-            case SR_OP_MODIFIED:
-                op_rc = interface_enable_disable(if_name, new_val->data.bool_val);
-                break;
-            case SR_OP_DELETED:
-                op_rc = interface_enable_disable(if_name, false /* !enable */);
-                break;
-            default:
-                break;
+    results = calloc(txn->n_ops, sizeof(*results));
+    if (NULL == results) {
+        goto done;
+    }
+
+    pthread_mutex_lock(&g_if_batch.lock);
+    if (NULL == g_if_batch.vapi_ctx &&
+        0 != sc_batch_connect(SC_INTERFACE_BATCH_APP_NAME, &g_if_batch.vapi_ctx)) {
+        pthread_mutex_unlock(&g_if_batch.lock);
+        SRP_LOG_ERR_MSG("Unable to connect to VPP to apply the changes.");
+        goto done;
+    }
+
+    SRP_LOG_DBG("Applying %u interface changes.", txn->n_ops);
+    failed = sc_batch_run(g_if_batch.vapi_ctx, txn->n_ops, sc_interface_txn_send, txn, results);
+    if (failed < 0) {
+        /* replies still due would be read by the next batch */
+        sc_disconnect_vpp_private(g_if_batch.vapi_ctx);
+        g_if_batch.vapi_ctx = NULL;
+    }
+    pthread_mutex_unlock(&g_if_batch.lock);
+
+    for (i = 0, failed = 0; i < txn->n_ops; i++) {
+        op = &txn->ops[i];
+        if (VAPI_OK != results[i].rv || 0 != results[i].retval) {
+            SRP_LOG_ERR("Unable to apply '%s', rv=%d, retval=%d", op->xpath,
+                        results[i].rv, results[i].retval);
+            failed++;
         }
-        sr_xpath_recover(&xpath_ctx);
-        if (SR_ERR_INVAL_ARG == op_rc) {
-            sr_set_error(session, "Invalid interface name.", new_val ? new_val->xpath : old_val->xpath);
+        /* a request without reply may have been applied as well */
+        if (SC_INTERFACE_OP_FLAGS == op->kind) {
+            flags_changed = true;
+        } else {
+            sc_interface_addr_invalidate(op->sw_if_index);
         }
-        sr_free_val(old_val);
-        sr_free_val(new_val);
     }
-    sr_free_change_iter(iter);
+    if (flags_changed) {
+        sc_interface_snapshot_invalidate();
+    }
+
+done:
+    free(results);
+    sc_interface_txn_clear(txn);
+
+    return failed;
+}
+
+/**
+ * @brief A transaction is being verified, after the batch of a reconciliation
+ * if one is being applied.
+ */
+static void
+sc_if_config_begin()
+{
+    pthread_mutex_lock(&g_if_config.lock);
+    while (g_if_config.held) {
+        pthread_cond_wait(&g_if_config.idle, &g_if_config.lock);
+    }
+    if (0 != g_if_config.txn.n_ops) {
+        /* sysrepo lost the apply or abort of the previous change set */
+        SRP_LOG_WRN("Dropping %u requests of a change set never applied.",
+                    g_if_config.txn.n_ops);
+        sc_interface_txn_clear(&g_if_config.txn);
+    }
+    g_if_config.in_txn = true;
+    g_if_config.generation++;
+    pthread_mutex_unlock(&g_if_config.lock);
+}
 
-    return op_rc;
+/**
+ * @brief The transaction was aborted, or failed verification.
+ */
+static void
+sc_if_config_abort()
+{
+    pthread_mutex_lock(&g_if_config.lock);
+    sc_interface_txn_clear(&g_if_config.txn);
+    g_if_config.in_txn = false;
+    pthread_cond_broadcast(&g_if_config.idle);
+    pthread_mutex_unlock(&g_if_config.lock);
 }
 
 /**
- * @brief Add or remove IPv4/IPv6 address to/from an interface.
+ * @brief Apply the transaction.
  */
 static int
-interface_ipv46_config_add_remove(const char *if_name, uint8_t *addr, uint8_t prefix, bool is_ipv6, bool add)
+sc_if_config_commit()
 {
-    uint32_t if_index = ~0;
-    int rc = 0;
+    int failed = 0;
 
-    SRP_LOG_DBG("%s IP config on interface '%s'.", add ? "Adding" : "Removing", if_name);
+    pthread_mutex_lock(&g_if_config.lock);
+    if (!g_if_config.in_txn) {
+        /* no change set verified, or its verification failed and aborted it */
+        pthread_mutex_unlock(&g_if_config.lock);
+        return SR_ERR_OK;
+    }
+    failed = sc_interface_txn_commit(&g_if_config.txn);
+    g_if_config.in_txn = false;
+    pthread_cond_broadcast(&g_if_config.idle);
+    pthread_mutex_unlock(&g_if_config.lock);
 
-    /* get interface index */
-    rc = sc_interface_name2index(if_name, &if_index);
-    if (0 != rc) {
-        SRP_LOG_ERR("Invalid interface name: %s", if_name);
-        return SR_ERR_INVAL_ARG;
+    return 0 == failed ? SR_ERR_OK : SR_ERR_OPERATION_FAILED;
+}
+
+u64
+sc_interface_config_mark()
+{
+    struct timespec deadline;
+    u64 generation;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += SC_INTERFACE_TXN_WAIT_MS / 1000;
+
+    pthread_mutex_lock(&g_if_config.lock);
+    while (g_if_config.in_txn) {
+        if (ETIMEDOUT == pthread_cond_timedwait(&g_if_config.idle, &g_if_config.lock,
+                                                &deadline)) {
+            /* sysrepo lost its apply or abort, do not wait forever */
+            SRP_LOG_WRN_MSG("Change set of ietf-interfaces still not applied, going on.");
+            break;
+        }
     }
+    generation = g_if_config.generation;
+    pthread_mutex_unlock(&g_if_config.lock);
 
-    /* add del addr */
-    rc = sc_interface_add_del_addr(if_index, (uint8_t)add, (uint8_t)is_ipv6, 0, prefix, addr);
-    if (0 != rc) {
-        SRP_LOG_ERR("Error by processing of the sw_interface_set_flags request, rc=%d", rc);
-        return SR_ERR_OPERATION_FAILED;
-    } else {
-        return SR_ERR_OK;
+    return generation;
+}
+
+int
+sc_interface_config_hold(u64 generation)
+{
+    int rc = -1;
+
+    pthread_mutex_lock(&g_if_config.lock);
+    if (generation == g_if_config.generation && !g_if_config.held) {
+        g_if_config.held = true;
+        rc = 0;
     }
+    pthread_mutex_unlock(&g_if_config.lock);
+
+    return rc;
+}
+
+void
+sc_interface_config_release()
+{
+    pthread_mutex_lock(&g_if_config.lock);
+    g_if_config.held = false;
+    pthread_cond_broadcast(&g_if_config.idle);
+    pthread_mutex_unlock(&g_if_config.lock);
+}
+
+static const char *
+sc_sw_interface_dump_name (const void *ctx, unsigned int entry)
+{
+  const sc_sw_interface_dump_ctx *dctx = ctx;
+
+  return dctx->intfcArray[entry].interface_name;
 }
+
 int sc_initSwInterfaceDumpCTX(sc_sw_interface_dump_ctx * dctx)
 {
   if(dctx == NULL)
     return -1;
 
+  sc_name_index_init(&dctx->names, sc_sw_interface_dump_name, dctx);
   dctx->intfcArray = NULL;
   dctx->last_called = false;
   dctx->capacity = 0;
@@ -192,14 +452,49 @@ int sc_freeSwInterfaceDumpCTX(sc_sw_interface_dump_ctx * dctx)
   if(dctx == NULL)
     return -1;
 
-  if(dctx->intfcArray != NULL)
-    {
-      printf("free intfcArray %p\n", dctx->intfcArray);
-      free(dctx->intfcArray);
-    }
+  free(dctx->intfcArray);
+  sc_name_index_free(&dctx->names);
 
   return sc_initSwInterfaceDumpCTX(dctx);
 }
+/**
+ * @brief Helper function for converting VPP link speed flags into bits per second.
+ */
+u64
+sc_link_speed_to_bps(u32 link_speed)
+{
+#define ONE_MEGABIT (uint64_t)1000000
+  switch (link_speed << VNET_HW_INTERFACE_FLAG_SPEED_SHIFT)
+    {
+    case VNET_HW_INTERFACE_FLAG_SPEED_10M:
+      return 10 * ONE_MEGABIT;
+    case VNET_HW_INTERFACE_FLAG_SPEED_100M:
+      return 100 * ONE_MEGABIT;
+    case VNET_HW_INTERFACE_FLAG_SPEED_1G:
+      return 1000 * ONE_MEGABIT;
+    case VNET_HW_INTERFACE_FLAG_SPEED_2_5G:
+      return 2500 * ONE_MEGABIT;
+    case VNET_HW_INTERFACE_FLAG_SPEED_5G:
+      return 5000 * ONE_MEGABIT;
+    case VNET_HW_INTERFACE_FLAG_SPEED_10G:
+      return 10000 * ONE_MEGABIT;
+    case VNET_HW_INTERFACE_FLAG_SPEED_20G:
+      return 20000 * ONE_MEGABIT;
+    case VNET_HW_INTERFACE_FLAG_SPEED_25G:
+      return 25000 * ONE_MEGABIT;
+    case VNET_HW_INTERFACE_FLAG_SPEED_40G:
+      return 40000 * ONE_MEGABIT;
+    case VNET_HW_INTERFACE_FLAG_SPEED_50G:
+      return 50000 * ONE_MEGABIT;
+    case VNET_HW_INTERFACE_FLAG_SPEED_56G:
+      return 56000 * ONE_MEGABIT;
+    case VNET_HW_INTERFACE_FLAG_SPEED_100G:
+      return 100000 * ONE_MEGABIT;
+    default:
+      return 0;
+    }
+}
+
 vapi_error_e
 sc_sw_interface_dump_cb (struct vapi_ctx_s *ctx, void *callback_ctx,
                       vapi_error_e rv, bool is_last,
@@ -230,50 +525,7 @@ sc_sw_interface_dump_cb (struct vapi_ctx_s *ctx, void *callback_ctx,
       strncpy(dctx->intfcArray[dctx->num_ifs].interface_name, reply->interface_name, VPP_INTFC_NAME_LEN);
       dctx->intfcArray[dctx->num_ifs].l2_address_length = reply->l2_address_length;
       memcpy(dctx->intfcArray[dctx->num_ifs].l2_address, reply->l2_address, reply->l2_address_length );
-     //dctx->intfcArray[dctx->num_ifs].link_speed = reply->link_speed;
-#define ONE_MEGABIT (uint64_t)1000000
-      switch (reply->link_speed << VNET_HW_INTERFACE_FLAG_SPEED_SHIFT)
-        {
-        case VNET_HW_INTERFACE_FLAG_SPEED_10M:
-	  dctx->intfcArray[dctx->num_ifs].link_speed = 10 * ONE_MEGABIT;
-          break;
-        case VNET_HW_INTERFACE_FLAG_SPEED_100M:
-           dctx->intfcArray[dctx->num_ifs].link_speed = 100 * ONE_MEGABIT;
-          break;
-        case VNET_HW_INTERFACE_FLAG_SPEED_1G:
-	  dctx->intfcArray[dctx->num_ifs].link_speed = 1000 * ONE_MEGABIT;
-          break;
-        case VNET_HW_INTERFACE_FLAG_SPEED_2_5G:
-	  dctx->intfcArray[dctx->num_ifs].link_speed = 2500 * ONE_MEGABIT;
-          break;
-        case VNET_HW_INTERFACE_FLAG_SPEED_5G:
-	  dctx->intfcArray[dctx->num_ifs].link_speed = 5000 * ONE_MEGABIT;
-          break;
-        case VNET_HW_INTERFACE_FLAG_SPEED_10G:
-	  dctx->intfcArray[dctx->num_ifs].link_speed = 10000 * ONE_MEGABIT;
-          break;
-        case VNET_HW_INTERFACE_FLAG_SPEED_20G:
-	  dctx->intfcArray[dctx->num_ifs].link_speed = 20000 * ONE_MEGABIT;
-          break;
-        case VNET_HW_INTERFACE_FLAG_SPEED_25G:
-	  dctx->intfcArray[dctx->num_ifs].link_speed = 25000 * ONE_MEGABIT;
-          break;
-        case VNET_HW_INTERFACE_FLAG_SPEED_40G:
-	  dctx->intfcArray[dctx->num_ifs].link_speed = 40000 * ONE_MEGABIT;
-          break;
-        case VNET_HW_INTERFACE_FLAG_SPEED_50G:
-	  dctx->intfcArray[dctx->num_ifs].link_speed = 50000 * ONE_MEGABIT;
-          break;
-        case VNET_HW_INTERFACE_FLAG_SPEED_56G:
-	  dctx->intfcArray[dctx->num_ifs].link_speed = 56000 * ONE_MEGABIT;
-          break;
-        case VNET_HW_INTERFACE_FLAG_SPEED_100G:
-	  dctx->intfcArray[dctx->num_ifs].link_speed = 100000 * ONE_MEGABIT;
-          break;
-        default:
-          dctx->intfcArray[dctx->num_ifs].link_speed = 0;
-          break;
-        }
+      dctx->intfcArray[dctx->num_ifs].link_speed = sc_link_speed_to_bps(reply->link_speed);
 
         dctx->intfcArray[dctx->num_ifs].link_mtu = reply->link_mtu;
         dctx->intfcArray[dctx->num_ifs].admin_up_down = reply->admin_up_down;
@@ -283,398 +535,1416 @@ sc_sw_interface_dump_cb (struct vapi_ctx_s *ctx, void *callback_ctx,
     }
   return VAPI_OK;
 }
-int sc_swInterfaceDump(sc_sw_interface_dump_ctx * dctx)
+int
+sc_interface_dump (vapi_ctx_t ctx, sc_sw_interface_dump_ctx * dctx)
 {
-  if(dctx == NULL)
-    {
-      return -1;
-    }
-
-  //sc_sw_interface_dump_ctx dctx = { false, 0, 0, 0 };
   vapi_msg_sw_interface_dump *dump;
   vapi_error_e rv;
-  //  dctx->last_called = false;
+  size_t i;
+
+  if (dctx == NULL)
+    return -1;
+
   sc_initSwInterfaceDumpCTX(dctx);
-  dump = vapi_alloc_sw_interface_dump (g_vapi_ctx_instance);
+  dump = vapi_alloc_sw_interface_dump (ctx);
+  if (dump == NULL)
+    return -1;
   dump->payload.name_filter_valid = 0;
   memset (dump->payload.name_filter, 0, sizeof (dump->payload.name_filter));
   while (VAPI_EAGAIN ==
          (rv =
-          vapi_sw_interface_dump (g_vapi_ctx_instance, dump, sc_sw_interface_dump_cb,
+          vapi_sw_interface_dump (ctx, dump, sc_sw_interface_dump_cb,
                                   dctx)));
+  if (VAPI_OK != rv)
+    {
+      SRP_LOG_ERR ("sw_interface_dump failed, rv=%d", rv);
+      return -1;
+    }
 
-  return dctx->num_ifs;
-}
-
-u32 sc_interface_name2index(const char *name, u32* if_index)
-{
-  u32 ret = -1;
-  sc_sw_interface_dump_ctx dctx = {false, 0, 0, 0};
-  vapi_msg_sw_interface_dump *dump;
-  vapi_error_e rv;
-  dctx.last_called = false;
-  dump = vapi_alloc_sw_interface_dump(g_vapi_ctx_instance);
-  dump->payload.name_filter_valid = 0;
-  memset(dump->payload.name_filter, 0, sizeof(dump->payload.name_filter));
-  while (VAPI_EAGAIN == (rv = vapi_sw_interface_dump(g_vapi_ctx_instance, dump, sc_sw_interface_dump_cb, &dctx)))
-    ;
-  printf("interface dump over, there are %d intfc\n", dctx.num_ifs);
-  int i = 0;
-  for (; i < dctx.num_ifs; ++i)
-  {
-    printf("Index[%d] %s\n", dctx.intfcArray[i].sw_if_index, dctx.intfcArray[i].interface_name);
-    if (strcmp(dctx.intfcArray[i].interface_name, name) == 0)
+  /* names are looked up once per configured interface, or per request */
+  for (i = 0; i < dctx->num_ifs; ++i)
     {
-      *if_index = dctx.intfcArray[i].sw_if_index;
-      ret = 0;
-      break;
+      if (0 != sc_name_index_add (&dctx->names, i))
+        {
+          /* out of memory, lookups fall back to a scan */
+          sc_name_index_free (&dctx->names);
+          break;
+        }
     }
-  }
-  sc_freeSwInterfaceDumpCTX(&dctx);
 
-  return ret;
+  return 0;
 }
 
-i32 sc_interface_add_del_addr( u32 sw_if_index, u8 is_add, u8 is_ipv6, u8 del_all,
-			       u8 address_length, u8 address[VPP_IP6_ADDRESS_LEN] )
+int sc_swInterfaceDump(sc_sw_interface_dump_ctx * dctx)
 {
-  i32 ret = -1;
-  vapi_msg_sw_interface_add_del_address *msg = vapi_alloc_sw_interface_add_del_address(g_vapi_ctx_instance);
-  msg->payload.sw_if_index = sw_if_index;
-  msg->payload.is_add = is_add;
-  msg->payload.is_ipv6 = is_ipv6;
-  msg->payload.del_all = del_all;
-  msg->payload.address_length = address_length;
-  memcpy(msg->payload.address, address, VPP_IP6_ADDRESS_LEN);
-  vapi_msg_sw_interface_add_del_address_hton (msg);
+  if (0 != sc_interface_dump (g_vapi_ctx_instance, dctx))
+    return -1;
 
-  vapi_error_e rv = vapi_send (g_vapi_ctx_instance, msg);
+  return dctx->num_ifs;
+}
 
-  vapi_msg_sw_interface_add_del_address_reply *resp;
-  
-  SC_VPP_VAPI_RECV;
+static int sw_interface_dump_load(void **data)
+{
+  sc_sw_interface_dump_ctx *dctx = calloc(1, sizeof(*dctx));
+  if (dctx == NULL)
+    return -1;
 
-  vapi_msg_sw_interface_add_del_address_reply_hton(resp);
-  printf("addDelInterfaceAddr : %d \n", resp->payload.retval);
-  ret = resp->payload.retval;
-  vapi_msg_free (g_vapi_ctx_instance, resp);
-  return ret;
+  *data = dctx;
+  return sc_swInterfaceDump(dctx) < 0 ? -1 : 0;
 }
-i32 sc_setInterfaceFlags(u32 sw_if_index, u8 admin_up_down)
-{
-  i32 ret = -1;
-  vapi_msg_sw_interface_set_flags *msg = vapi_alloc_sw_interface_set_flags(g_vapi_ctx_instance);
-  msg->payload.sw_if_index = sw_if_index;
-  msg->payload.admin_up_down = admin_up_down;
-  vapi_msg_sw_interface_set_flags_hton (msg);
 
-  vapi_error_e rv = vapi_send (g_vapi_ctx_instance, msg);
+static void sw_interface_dump_free(void *data)
+{
+  sc_freeSwInterfaceDumpCTX(data);
+  free(data);
+}
 
-  vapi_msg_sw_interface_set_flags_reply *resp;
+static sc_snapshot_t g_interface_snapshot =
+  SC_SNAPSHOT_INIT(SC_SW_INTERFACE_DUMP_KEY, sw_interface_dump_load,
+                   sw_interface_dump_free, SC_INTERFACE_SNAPSHOT_TTL_MS);
 
-  SC_VPP_VAPI_RECV;
+const sc_sw_interface_dump_ctx *
+sc_interface_snapshot_acquire(sc_snapshot_ref_t **ref)
+{
+  *ref = sc_snapshot_acquire(&g_interface_snapshot);
+  return sc_snapshot_data(*ref);
+}
 
-  vapi_msg_sw_interface_set_flags_reply_ntoh(resp);
-  printf("setInterfaceFlags:%d \n", resp->payload.retval);
-  ret = resp->payload.retval;
-  vapi_msg_free (g_vapi_ctx_instance, resp);
-  return ret;
+void sc_interface_snapshot_release(sc_snapshot_ref_t *ref)
+{
+  sc_snapshot_release(ref);
 }
 
+void sc_interface_snapshot_invalidate()
+{
+  sc_snapshot_invalidate(&g_interface_snapshot);
+}
 
-/**
- * @brief Modify existing IPv4/IPv6 config on an interface.
- */
-static int
-interface_ipv46_config_modify(sr_session_ctx_t *session, const char *if_name,
-        sr_val_t *old_val, sr_val_t *new_val, bool is_ipv6)
+const scVppIntfc *
+sc_interface_snapshot_find(const sc_sw_interface_dump_ctx *dctx, const char *name)
 {
-    sr_xpath_ctx_t xpath_ctx = { 0, };
-    char *addr_str = NULL;
-    uint8_t addr[16] = { 0, };
-    uint8_t prefix = 0;
-    int rc = SR_ERR_OK;
+  size_t i;
+  int entry;
 
-    SRP_LOG_DBG("Updating IP config on interface '%s'.", if_name);
+  if (dctx == NULL)
+    return NULL;
 
-    /* get old config to be deleted */
-    if (SR_UINT8_T == old_val->type) {
-        prefix = old_val->data.uint8_val;
-    } else if (SR_STRING_T == old_val->type) {
-        prefix = netmask_to_prefix(old_val->data.string_val);
-    } else {
-        return SR_ERR_INVAL_ARG;
+  if (dctx->names.n_slots != 0)
+    {
+      entry = sc_name_index_find(&dctx->names, name);
+      return entry < 0 ? NULL : &dctx->intfcArray[entry];
     }
-    addr_str = sr_xpath_key_value((char*)old_val->xpath, "address", "ip", &xpath_ctx);
-    ip_addr_str_to_binary(addr_str, addr, is_ipv6);
-    sr_xpath_recover(&xpath_ctx);
 
-    /* delete old IP config */
-    rc = interface_ipv46_config_add_remove(if_name, addr, prefix, is_ipv6, false /* remove */);
-    if (SR_ERR_OK != rc) {
-        SRP_LOG_ERR("Unable to remove old IP address config, rc=%d", rc);
-        return rc;
+  for (i = 0; i < dctx->num_ifs; ++i)
+    {
+      if (strcmp(dctx->intfcArray[i].interface_name, name) == 0)
+        return &dctx->intfcArray[i];
     }
 
-    /* update the config with the new value */
-    if (sr_xpath_node_name_eq(new_val->xpath, "prefix-length")) {
-        prefix = new_val->data.uint8_val;
-    } else if (sr_xpath_node_name_eq(new_val->xpath, "netmask")) {
-        prefix = netmask_to_prefix(new_val->data.string_val);
+  return NULL;
+}
+
+const scVppIntfc *
+sc_interface_snapshot_find_index(const sc_sw_interface_dump_ctx *dctx, u32 sw_if_index)
+{
+  size_t i;
+
+  for (i = 0; dctx != NULL && i < dctx->num_ifs; ++i)
+    {
+      if (dctx->intfcArray[i].sw_if_index == sw_if_index)
+        return &dctx->intfcArray[i];
     }
 
-    /* set new IP config */
-    rc = interface_ipv46_config_add_remove(if_name, addr, prefix, is_ipv6, true /* add */);
-    if (SR_ERR_OK != rc) {
-        SRP_LOG_ERR("Unable to remove old IP address config, rc=%d", rc);
-        return rc;
+  return NULL;
+}
+
+u32 sc_interface_name2index(const char *name, u32* if_index)
+{
+  u32 ret = -1;
+  int retry;
+
+  /* a miss may just be an interface created after the snapshot was taken */
+  for (retry = 0; retry < 2 && ret != 0; ++retry)
+  {
+    sc_snapshot_ref_t *ref = NULL;
+    const scVppIntfc *intfc;
+
+    if (retry > 0)
+      sc_interface_snapshot_invalidate();
+
+    intfc = sc_interface_snapshot_find(sc_interface_snapshot_acquire(&ref), name);
+    if (intfc != NULL)
+    {
+      *if_index = intfc->sw_if_index;
+      ret = 0;
     }
+    sc_interface_snapshot_release(ref);
+  }
 
-    return rc;
+  return ret;
 }
 
-/**
- * @brief Callback to be called by any config change in subtrees "/ietf-interfaces:interfaces/interface/ietf-ip:ipv4/address"
- * or "/ietf-interfaces:interfaces/interface/ietf-ip:ipv6/address".
+/*
+ * Addresses of the interfaces, indexed by sw_if_index.
+ *
+ * Filled by one ip_address_dump per address family for the interfaces
+ * whose entry is stale, right after the interfaces-state dump, so the
+ * address lists sysrepo asks for next cost no VPP request. An entry goes
+ * stale with the interface snapshot, SC_INTERFACE_SNAPSHOT_TTL_MS after it
+ * was filled, as addresses may change behind our back, and right away
+ * when we change them ourselves.
  */
-static int
-sc_interface_ipv46_address_change_cb(sr_session_ctx_t *session, const char *xpath, sr_notif_event_t event, void *private_ctx)
+typedef struct _sc_if_addr_entry
 {
-    sr_change_iter_t *iter = NULL;
-    sr_change_oper_t op = SR_OP_CREATED;
-    sr_val_t *old_val = NULL;
-    sr_val_t *new_val = NULL;
-    sr_xpath_ctx_t xpath_ctx = { 0, };
-    bool is_ipv6 = false, has_addr = false, has_prefix = false;
-    uint8_t addr[16] = { 0, };
-    uint8_t prefix = 0;
-    char *node_name = NULL, *if_name = NULL;
-    int rc = SR_ERR_OK, op_rc = SR_ERR_OK;
+  u32 generation;               /* interfaces-state dump that last saw it */
+  bool valid;                   /* addresses below are current */
+  u32 seq;                      /* bumped when the addresses go stale */
+  u64 filled_ms;
+  char name[VPP_INTFC_NAME_LEN];
+  sc_if_addrs_t addrs;
+} sc_if_addr_entry;
+
+static sc_if_addr_entry *g_if_addr = NULL;
+static u32 g_if_addr_len = 0;
+static u32 g_if_addr_generation = 0;
+static pthread_mutex_t g_if_addr_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static vapi_error_e
+sc_ip_address_dump_cb (struct vapi_ctx_s *ctx, void *callback_ctx,
+                       vapi_error_e rv, bool is_last,
+                       vapi_payload_ip_address_details * reply)
+{
+  sc_if_addrs_t *addrs = callback_ctx;
+  u8 af;
 
-    /* no-op for apply, we only care about SR_EV_ENABLED, SR_EV_VERIFY, SR_EV_ABORT */
-    if (SR_EV_APPLY == event) {
-        return SR_ERR_OK;
-    }
-    SRP_LOG_DBG("'%s' modified, event=%d", xpath, event);
+  if (is_last)
+    return VAPI_OK;
 
-    /* check whether we are handling ipv4 or ipv6 config */
-    node_name = sr_xpath_node_idx((char*)xpath, 2, &xpath_ctx);
-    if (NULL != node_name && 0 == strcmp(node_name, "ipv6")) {
-        is_ipv6 = true;
+  af = reply->is_ipv6 ? 1 : 0;
+  if (addrs->n_addrs[af] == addrs->cap_addrs[af])
+    {
+      u32 cap = addrs->cap_addrs[af] ? addrs->cap_addrs[af] * 2 : 4;
+      sc_ip_addr_t *array = realloc (addrs->addrs[af], cap * sizeof (*array));
+      if (array == NULL)
+        return VAPI_ENOMEM;
+      addrs->addrs[af] = array;
+      addrs->cap_addrs[af] = cap;
     }
-    sr_xpath_recover(&xpath_ctx);
 
-    /* get changes iterator */
-    rc = sr_get_changes_iter(session, xpath, &iter);
-    if (SR_ERR_OK != rc) {
-        SRP_LOG_ERR("Unable to retrieve change iterator: %s", sr_strerror(rc));
-        return rc;
-    }
+  memcpy (addrs->addrs[af][addrs->n_addrs[af]].address, reply->ip, VPP_IP6_ADDRESS_LEN);
+  addrs->addrs[af][addrs->n_addrs[af]].prefix_length = reply->prefix_length;
+  addrs->n_addrs[af]++;
 
-    /* iterate over all changes */
-    while ((SR_ERR_OK == op_rc || event == SR_EV_ABORT) &&
-            (SR_ERR_OK == (rc = sr_get_change_next(session, iter, &op, &old_val, &new_val)))) {
+  return VAPI_OK;
+}
 
-        SRP_LOG_DBG("A change detected in '%s', op=%d", new_val ? new_val->xpath : old_val->xpath, op);
-        if_name = strdup(sr_xpath_key_value(new_val ? new_val->xpath : old_val->xpath, "interface", "name", &xpath_ctx));
-        sr_xpath_recover(&xpath_ctx);
-
-        switch (op) {
-            case SR_OP_CREATED:
-                if (SR_LIST_T == new_val->type) {
-                    /* create on list item - reset state vars */
-                    has_addr = has_prefix = false;
-                } else {
-                    if (sr_xpath_node_name_eq(new_val->xpath, "ip")) {
-                        ip_addr_str_to_binary(new_val->data.string_val, addr, is_ipv6);
-                        has_addr = true;
-                    } else if (sr_xpath_node_name_eq(new_val->xpath, "prefix-length")) {
-                        prefix = new_val->data.uint8_val;
-                        has_prefix = true;
-                    } else if (sr_xpath_node_name_eq(new_val->xpath, "netmask")) {
-                        prefix = netmask_to_prefix(new_val->data.string_val);
-                        has_prefix = true;
-                    }
-                    if (has_addr && has_prefix) {
-                        op_rc = interface_ipv46_config_add_remove(if_name, addr, prefix, is_ipv6, true /* add */);
-                    }
-                }
-                break;
-            case SR_OP_MODIFIED:
-                op_rc = interface_ipv46_config_modify(session, if_name, old_val, new_val, is_ipv6);
-                break;
-            case SR_OP_DELETED:
-                if (SR_LIST_T == old_val->type) {
-                    /* delete on list item - reset state vars */
-                    has_addr = has_prefix = false;
-                } else {
-                    if (sr_xpath_node_name_eq(old_val->xpath, "ip")) {
-                        ip_addr_str_to_binary(old_val->data.string_val, addr, is_ipv6);
-                        has_addr = true;
-                    } else if (sr_xpath_node_name_eq(old_val->xpath, "prefix-length")) {
-                        prefix = old_val->data.uint8_val;
-                        has_prefix = true;
-                    } else if (sr_xpath_node_name_eq(old_val->xpath, "netmask")) {
-                        prefix = netmask_to_prefix(old_val->data.string_val);
-                        has_prefix = true;
-                    }
-                    if (has_addr && has_prefix) {
-                        op_rc = interface_ipv46_config_add_remove(if_name, addr, prefix, is_ipv6, false /* !add */);
-                    }
-                }
-                break;
-            default:
-                break;
-        }
-        if (SR_ERR_INVAL_ARG == op_rc) {
-            sr_set_error(session, "Invalid interface name.", new_val ? new_val->xpath : old_val->xpath);
+int
+sc_interface_addr_dump (vapi_ctx_t ctx, u32 sw_if_index, sc_if_addrs_t *addrs)
+{
+  vapi_msg_ip_address_dump *mp;
+  vapi_error_e rv;
+  u8 is_ipv6;
+
+  for (is_ipv6 = 0; is_ipv6 <= 1; is_ipv6++)
+    {
+      addrs->n_addrs[is_ipv6] = 0;
+      mp = vapi_alloc_ip_address_dump (ctx);
+      if (mp == NULL)
+        return -1;
+      mp->payload.sw_if_index = sw_if_index;
+      mp->payload.is_ipv6 = is_ipv6;
+      while (VAPI_EAGAIN ==
+             (rv = vapi_ip_address_dump (ctx, mp,
+                                         sc_ip_address_dump_cb, addrs)));
+      if (VAPI_OK != rv)
+        {
+          SRP_LOG_ERR ("ip_address_dump failed for sw_if_index %u, rv=%d", sw_if_index, rv);
+          return -1;
         }
-        free(if_name);
-        sr_free_val(old_val);
-        sr_free_val(new_val);
     }
-    sr_free_change_iter(iter);
 
-    return op_rc;
+  return 0;
 }
 
-/**
- * @brief Callback to be called by any config change under "/ietf-interfaces:interfaces-state/interface" path.
- * Does not provide any functionality, needed just to cover not supported config leaves.
- */
+void
+sc_interface_addrs_free (sc_if_addrs_t *addrs)
+{
+  u8 is_ipv6;
+
+  for (is_ipv6 = 0; is_ipv6 <= 1; is_ipv6++)
+    {
+      free (addrs->addrs[is_ipv6]);
+      addrs->addrs[is_ipv6] = NULL;
+      addrs->n_addrs[is_ipv6] = addrs->cap_addrs[is_ipv6] = 0;
+    }
+}
+
+static u64
+sc_if_addr_now_ms (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (u64) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Dump the addresses of an entry without holding g_if_addr_lock, so
+ * readers of the other entries do not wait for VPP. Called with
+ * g_if_addr_lock held, which is released meanwhile: the entry pointer is
+ * stale on return. -1 when the dump failed.
+ */
 static int
-sc_interface_change_cb(sr_session_ctx_t *session, const char *xpath, sr_notif_event_t event, void *private_ctx)
+sc_if_addr_fill (u32 sw_if_index)
 {
-    SRP_LOG_DBG("'%s' modified, event=%d", xpath, event);
+  sc_if_addrs_t addrs = { { 0, }, };
+  sc_if_addrs_t old;
+  sc_if_addr_entry *entry;
+  u32 seq = g_if_addr[sw_if_index].seq;
+  int rc;
+
+  pthread_mutex_unlock (&g_if_addr_lock);
+  rc = sc_interface_addr_dump (g_vapi_ctx_instance, sw_if_index, &addrs);
+  pthread_mutex_lock (&g_if_addr_lock);
+
+  entry = &g_if_addr[sw_if_index];
+  /* an entry invalidated during the dump keeps waiting for a fresh one */
+  if (0 == rc && entry->seq == seq)
+    {
+      old = entry->addrs;
+      entry->addrs = addrs;
+      addrs = old;
+      entry->valid = true;
+      entry->filled_ms = sc_if_addr_now_ms ();
+    }
+  sc_interface_addrs_free (&addrs);
 
-    return SR_ERR_OK;
+  return rc;
+}
+
+/* called with g_if_addr_lock held */
+static void
+sc_if_addr_stale (sc_if_addr_entry *entry)
+{
+  entry->valid = false;
+  entry->seq++;
 }
 
 /**
- * @brief Callback to be called by any request for state data under "/ietf-interfaces:interfaces-state/interface" path.
+ * @brief Make the addresses of an entry current, filling it when stale or
+ * older than the snapshot TTL. Called with g_if_addr_lock held, see
+ * sc_if_addr_fill(). -1 when the dump failed.
  */
 static int
-sc_interface_state_cb(const char *xpath, sr_val_t **values, size_t *values_cnt, void *private_ctx)
+sc_if_addr_current (u32 sw_if_index, u64 now)
 {
-    sr_val_t *values_arr = NULL;
-    size_t values_arr_size = 0, values_arr_cnt = 0;
-    sc_sw_interface_dump_ctx dctx;
-    scVppIntfc* if_details;
-    int rc = 0;
+  sc_if_addr_entry *entry = &g_if_addr[sw_if_index];
 
-    SRP_LOG_DBG("Requesting state data for '%s'", xpath);
-printf("%d\n", __LINE__);
-    printf("Requesting state data for '%s'\n", xpath);
+  if (entry->valid && now - entry->filled_ms >= SC_INTERFACE_SNAPSHOT_TTL_MS)
+    sc_if_addr_stale (entry);
+  if (!entry->valid)
+    return sc_if_addr_fill (sw_if_index);
 
-    if (! sr_xpath_node_name_eq(xpath, "interface")) {
-        /* statistics, ipv4 and ipv6 state data not supported */
-      printf("============= you want %s ?\n ", xpath);
-      *values = NULL;
-      *values_cnt = 0;
-      return SR_ERR_OK;
+  return 0;
+}
+
+/**
+ * @brief Start recording the interfaces seen by a new interfaces-state dump.
+ */
+static void
+sc_if_addr_track_begin (void)
+{
+  pthread_mutex_lock (&g_if_addr_lock);
+  g_if_addr_generation++;
+  pthread_mutex_unlock (&g_if_addr_lock);
+}
+
+/**
+ * @brief Record an interface seen by the running interfaces-state dump, no VPP request.
+ */
+static void
+sc_if_addr_track (u32 sw_if_index, const char *name)
+{
+  sc_if_addr_entry *entry;
+
+  pthread_mutex_lock (&g_if_addr_lock);
+  if (sw_if_index >= g_if_addr_len)
+    {
+      u32 len = g_if_addr_len ? g_if_addr_len : 16;
+      while (len <= sw_if_index)
+        len *= 2;
+      entry = realloc (g_if_addr, len * sizeof (*entry));
+      if (entry == NULL)
+        {
+          pthread_mutex_unlock (&g_if_addr_lock);
+          return;
+        }
+      memset (&entry[g_if_addr_len], 0, (len - g_if_addr_len) * sizeof (*entry));
+      g_if_addr = entry;
+      g_if_addr_len = len;
     }
 
-    /* dump interfaces */
-    rc = sc_swInterfaceDump(&dctx);
-    if (rc <= 0) {
-        SRP_LOG_ERR_MSG("Error by processing of a interface dump request.");
-	sc_freeSwInterfaceDumpCTX(&dctx);
-        return SR_ERR_INTERNAL;
+  entry = &g_if_addr[sw_if_index];
+  if (strncmp (entry->name, name, VPP_INTFC_NAME_LEN) != 0)
+    {
+      /* index reused by another interface */
+      strncpy (entry->name, name, VPP_INTFC_NAME_LEN - 1);
+      sc_if_addr_stale (entry);
     }
+  entry->generation = g_if_addr_generation;
+  pthread_mutex_unlock (&g_if_addr_lock);
+}
 
-    /* allocate array of values to be returned */
-    values_arr_size = dctx.num_ifs * 5;
-    rc = sr_new_values(values_arr_size, &values_arr);
-    if (0 != rc) {
-      sc_freeSwInterfaceDumpCTX(&dctx);
-        return rc;
+/**
+ * @brief Fetch the addresses of the tracked interfaces whose entry is stale.
+ */
+static void
+sc_if_addr_refresh (void)
+{
+  u64 now = sc_if_addr_now_ms ();
+  u32 i;
+
+  pthread_mutex_lock (&g_if_addr_lock);
+  for (i = 0; i < g_if_addr_len; i++)
+    {
+      if (g_if_addr[i].generation == g_if_addr_generation)
+        sc_if_addr_current (i, now);
     }
-    printf("create %d sr vals\n", values_arr_size);
-
-    size_t i = 0;
-    for (; i < dctx.num_ifs; i++) {
-        if_details = dctx.intfcArray+i;
-
-        /* currently the only supported interface types are propVirtual / ethernetCsmacd */
-        sr_val_build_xpath(&values_arr[values_arr_cnt], "%s[name='%s']/type", xpath, if_details->interface_name);
-        sr_val_set_str_data(&values_arr[values_arr_cnt], SR_IDENTITYREF_T,
-                strstr((char*)if_details->interface_name, "local0") ? "iana-if-type:propVirtual" : "iana-if-type:ethernetCsmacd");
-printf("\nset %s 's data\n",values_arr[values_arr_cnt].xpath);
-        values_arr_cnt++;
-
-        sr_val_build_xpath(&values_arr[values_arr_cnt], "%s[name='%s']/admin-status", xpath, if_details->interface_name);
-        sr_val_set_str_data(&values_arr[values_arr_cnt], SR_ENUM_T, if_details->admin_up_down ? "up" : "down");
-printf("\nset %s 's data\n",values_arr[values_arr_cnt].xpath);
-        values_arr_cnt++;
-
-        sr_val_build_xpath(&values_arr[values_arr_cnt], "%s[name='%s']/oper-status", xpath, if_details->interface_name);
-        sr_val_set_str_data(&values_arr[values_arr_cnt], SR_ENUM_T, if_details->link_up_down ? "up" : "down");
-printf("\nset %s 's data\n",values_arr[values_arr_cnt].xpath);
-        values_arr_cnt++;
-
-        if (if_details->l2_address_length > 0) {
-            sr_val_build_xpath(&values_arr[values_arr_cnt], "%s[name='%s']/phys-address", xpath, if_details->interface_name);
-            sr_val_build_str_data(&values_arr[values_arr_cnt], SR_STRING_T, "%02x:%02x:%02x:%02x:%02x:%02x",
-                    if_details->l2_address[0], if_details->l2_address[1], if_details->l2_address[2],
-                    if_details->l2_address[3], if_details->l2_address[4], if_details->l2_address[5]);
-printf("\nset %s 's data\n",values_arr[values_arr_cnt].xpath);
-            values_arr_cnt++;
-        } else {
-	  sr_val_build_xpath(&values_arr[values_arr_cnt], "%s[name='%s']/phys-address", xpath, if_details->interface_name);
-	  sr_val_build_str_data(&values_arr[values_arr_cnt], SR_STRING_T, "%02x:%02x:%02x:%02x:%02x:%02x", 0,0,0,0,0,0);
-	  printf("\nset %s 's data\n",values_arr[values_arr_cnt].xpath);
-	  values_arr_cnt++;
-	}
+  pthread_mutex_unlock (&g_if_addr_lock);
+}
 
-        sr_val_build_xpath(&values_arr[values_arr_cnt], "%s[name='%s']/speed", xpath, if_details->interface_name);
-        values_arr[values_arr_cnt].type = SR_UINT64_T;
-        values_arr[values_arr_cnt].data.uint64_val = if_details->link_speed;
-printf("\nset %s 's data\n",values_arr[values_arr_cnt].xpath);
-        values_arr_cnt++;
+void
+sc_interface_addr_invalidate (u32 sw_if_index)
+{
+  pthread_mutex_lock (&g_if_addr_lock);
+  if (sw_if_index < g_if_addr_len)
+    sc_if_addr_stale (&g_if_addr[sw_if_index]);
+  pthread_mutex_unlock (&g_if_addr_lock);
+}
+
+int
+sc_interface_addr_walk (const char *if_name, bool is_ipv6,
+                        sc_interface_addr_walk_fn fn, void *ctx)
+{
+  sc_if_addr_entry *entry = NULL;
+  int rc = -1;
+  u32 i;
+
+  pthread_mutex_lock (&g_if_addr_lock);
+  for (i = 0; i < g_if_addr_len; i++)
+    {
+      if (g_if_addr[i].generation == g_if_addr_generation &&
+          strncmp (g_if_addr[i].name, if_name, VPP_INTFC_NAME_LEN) == 0)
+        {
+          entry = &g_if_addr[i];
+          break;
+        }
+    }
+
+  /* not seen by an interfaces-state dump yet, or invalidated since */
+  if (entry != NULL && !entry->valid)
+    {
+      /* the index may have been reused while the lock was released */
+      if (0 != sc_if_addr_fill (i) ||
+          strncmp (g_if_addr[i].name, if_name, VPP_INTFC_NAME_LEN) != 0)
+        entry = NULL;
+      else
+        entry = &g_if_addr[i];
+    }
+  if (entry != NULL && entry->valid)
+    {
+      rc = 0;
+      for (i = 0; i < entry->addrs.n_addrs[is_ipv6] && 0 == rc; i++)
+        rc = fn (&entry->addrs.addrs[is_ipv6][i], ctx);
+    }
+  pthread_mutex_unlock (&g_if_addr_lock);
+
+  return rc;
+}
+
+/**
+ * @brief Index of an interface seen by the last interfaces-state dump, no VPP request.
+ */
+static int
+sc_if_addr_index (const char *if_name, u32 *sw_if_index)
+{
+  int rc = -1;
+  u32 i;
+
+  pthread_mutex_lock (&g_if_addr_lock);
+  for (i = 0; i < g_if_addr_len; i++)
+    {
+      if (g_if_addr[i].generation == g_if_addr_generation &&
+          strncmp (g_if_addr[i].name, if_name, VPP_INTFC_NAME_LEN) == 0)
+        {
+          *sw_if_index = i;
+          rc = 0;
+          break;
+        }
     }
+  pthread_mutex_unlock (&g_if_addr_lock);
+
+  return rc;
+}
+
+static const char *
+sc_if_change_name(const void *ctx, unsigned int entry)
+{
+    return g_if_config.changes[entry].name;
+}
+
+/**
+ * @brief Entry of the changes of an interface, the last one when the changes
+ * of an interface follow each other as they do. NULL when out of memory.
+ */
+static sc_if_change_t *
+sc_if_change_get(const char *if_name, const char *xpath)
+{
+    sc_if_change_t *changes = NULL, *ch = NULL;
+    u32 cap;
+    int i;
 
-    SRP_LOG_DBG("Returning %zu state data elements for '%s'", values_arr, xpath);
-    printf("\nReturning %d  data elements for '%s'\n", values_arr_cnt, xpath);
+    if (0 != g_if_config.n_changes &&
+        0 == strcmp(g_if_config.changes[g_if_config.n_changes - 1].name, if_name)) {
+        return &g_if_config.changes[g_if_config.n_changes - 1];
+    }
+    i = sc_name_index_find(&g_if_config.change_names, if_name);
+    if (i >= 0) {
+        return &g_if_config.changes[i];
+    }
 
-    *values = values_arr;
-    *values_cnt = values_arr_cnt;
+    if (g_if_config.n_changes == g_if_config.cap_changes) {
+        cap = g_if_config.cap_changes ? 2 * g_if_config.cap_changes : SC_INTERFACE_CHANGES_HINT;
+        changes = realloc(g_if_config.changes, cap * sizeof(*changes));
+        if (NULL == changes) {
+            return NULL;
+        }
+        /* the address arrays of the entries past n_changes are kept for reuse */
+        memset(&changes[g_if_config.cap_changes], 0,
+               (cap - g_if_config.cap_changes) * sizeof(*changes));
+        g_if_config.changes = changes;
+        g_if_config.cap_changes = cap;
+    }
 
-    sc_freeSwInterfaceDumpCTX(&dctx);
+    ch = &g_if_config.changes[g_if_config.n_changes];
+    strncpy(ch->name, if_name, VPP_INTFC_NAME_LEN - 1);
+    ch->name[VPP_INTFC_NAME_LEN - 1] = '\0';
+    ch->xpath = strdup(xpath);
+    if (NULL == ch->xpath) {
+        return NULL;
+    }
+    g_if_config.n_changes++;
+    if (0 != sc_name_index_add(&g_if_config.change_names, g_if_config.n_changes - 1)) {
+        return NULL;
+    }
+    ch->deleted = false;
+    ch->enabled = -1;
+    ch->n_addrs = 0;
+
+    return ch;
+}
+
+/**
+ * @brief Forget the changes collected, keeping their memory.
+ */
+static void
+sc_if_change_reset()
+{
+    sc_if_change_t *ch = NULL;
+    u32 i, j;
+
+    for (i = 0; i < g_if_config.n_changes; i++) {
+        ch = &g_if_config.changes[i];
+        for (j = 0; j < ch->n_addrs; j++) {
+            free(ch->addrs[j].xpath);
+        }
+        free(ch->xpath);
+        free(ch->enabled_xpath);
+        ch->xpath = ch->enabled_xpath = NULL;
+    }
+    g_if_config.n_changes = 0;
+    sc_name_index_reset(&g_if_config.change_names);
+}
+
+/**
+ * @brief Handler of a change of the "enabled" leaf of an interface.
+ */
+static int
+sc_if_change_enabled(sc_if_change_t *ch, sr_change_oper_t op, const sr_val_t *old_val,
+                     const sr_val_t *new_val)
+{
+    const sr_val_t *val = new_val ? new_val : old_val;
+
+    free(ch->enabled_xpath);
+    ch->enabled_xpath = strdup(val->xpath);
+    if (NULL == ch->enabled_xpath) {
+        return SR_ERR_NOMEM;
+    }
+    /* a deleted leaf falls back to its YANG default, true, unless its
+     * interface entry is deleted too: sc_if_change_collect() sees to that */
+    ch->enabled = SR_OP_DELETED == op || new_val->data.bool_val;
+
+    return SR_ERR_OK;
+}
+
+static int
+sc_if_change_addr_add(sc_if_change_t *ch, const sr_val_t *val, bool add, bool is_ipv6)
+{
+    sc_if_addr_change_t *addrs = NULL, *a = NULL;
+    sr_xpath_ctx_t xpath_ctx = { 0, };
+    char *addr_str = NULL;
+    u32 cap;
+
+    if (ch->n_addrs == ch->cap_addrs) {
+        cap = ch->cap_addrs ? 2 * ch->cap_addrs : 4;
+        addrs = realloc(ch->addrs, cap * sizeof(*addrs));
+        if (NULL == addrs) {
+            return SR_ERR_NOMEM;
+        }
+        ch->addrs = addrs;
+        ch->cap_addrs = cap;
+    }
+
+    a = &ch->addrs[ch->n_addrs];
+    memset(a, 0, sizeof(*a));
+    a->add = add;
+    a->is_ipv6 = is_ipv6;
+    if (sr_xpath_node_name_eq(val->xpath, "prefix-length")) {
+        a->prefix_length = val->data.uint8_val;
+    } else {
+        a->prefix_length = netmask_to_prefix(val->data.string_val);
+    }
+
+    /* the address is the key of the list entry */
+    addr_str = sr_xpath_key_value(val->xpath, "address", "ip", &xpath_ctx);
+    if (NULL != addr_str) {
+        ip_addr_str_to_binary(addr_str, a->address, is_ipv6);
+    }
+    sr_xpath_recover(&xpath_ctx);
+    if (NULL == addr_str) {
+        return SR_ERR_INVAL_ARG;
+    }
+
+    a->xpath = strdup(val->xpath);
+    if (NULL == a->xpath) {
+        return SR_ERR_NOMEM;
+    }
+    ch->n_addrs++;
 
     return SR_ERR_OK;
 }
 
 /**
- * @brief Callback to be called by plugin daemon upon plugin load.
+ * @brief Handler of a change of an IPv4/IPv6 address of an interface. The
+ * prefix-length or netmask leaf carries the change, the address being the
+ * key of its list entry.
  */
-int
-sc_interface_subscribe_events(sr_session_ctx_t *session,
-			      sr_subscription_ctx_t **subscription)
+static int
+sc_if_change_address(sc_if_change_t *ch, sr_change_oper_t op, const sr_val_t *old_val,
+                     const sr_val_t *new_val, bool is_ipv6)
 {
     int rc = SR_ERR_OK;
 
-    SRP_LOG_DBG_MSG("Initializing vpp-interfaces plugin.");
+    switch (op) {
+        case SR_OP_CREATED:
+            rc = sc_if_change_addr_add(ch, new_val, true /* add */, is_ipv6);
+            break;
+        case SR_OP_MODIFIED:
+            /* replace the old config with the new one */
+            rc = sc_if_change_addr_add(ch, old_val, false /* !add */, is_ipv6);
+            if (SR_ERR_OK == rc) {
+                rc = sc_if_change_addr_add(ch, new_val, true /* add */, is_ipv6);
+            }
+            break;
+        case SR_OP_DELETED:
+            rc = sc_if_change_addr_add(ch, old_val, false /* !add */, is_ipv6);
+            break;
+        default:
+            break;
+    }
+
+    return rc;
+}
 
-    rc = sr_subtree_change_subscribe(session, "/ietf-interfaces:interfaces/interface",
-            sc_interface_change_cb, g_vapi_ctx_instance, 0, SR_SUBSCR_CTX_REUSE | SR_SUBSCR_EV_ENABLED, subscription);
+/* Whether xpath is an interface list entry itself, not one of its nodes. */
+static bool
+sc_if_change_is_entry(const char *xpath)
+{
+    const char *entry = strstr(xpath, "/interface[");
+    size_t len = strlen(xpath);
+
+    return NULL != entry && 0 != len && ']' == xpath[len - 1] &&
+           NULL == strstr(entry, "]/");
+}
+
+/**
+ * @brief Walk the change set once, grouping the changes by interface.
+ * Changes of leaves not supported are ignored.
+ */
+static int
+sc_if_change_collect(sr_session_ctx_t *session)
+{
+    sr_change_iter_t *iter = NULL;
+    sr_change_oper_t op = SR_OP_CREATED;
+    sr_val_t *old_val = NULL;
+    sr_val_t *new_val = NULL;
+    sr_xpath_ctx_t xpath_ctx = { 0, };
+    sc_if_change_t *ch = NULL;
+    char if_name[VPP_INTFC_NAME_LEN];
+    const char *change_xpath = NULL;
+    const char *key = NULL;
+    bool is_ip, is_ipv6;
+    int rc = SR_ERR_OK, op_rc = SR_ERR_OK, err_rc = SR_ERR_OK;
+
+    rc = sr_get_changes_iter(session, SC_INTERFACE_CHANGES_XPATH, &iter);
     if (SR_ERR_OK != rc) {
-        goto error;
+        SRP_LOG_ERR("Unable to retrieve change iterator: %s", sr_strerror(rc));
+        return rc;
     }
 
-    rc = sr_subtree_change_subscribe(session, "/ietf-interfaces:interfaces/interface/enabled",
-            sc_interface_enable_disable_cb, g_vapi_ctx_instance, 100, SR_SUBSCR_CTX_REUSE | SR_SUBSCR_EV_ENABLED, subscription);
-    if (SR_ERR_OK != rc) {
-        goto error;
+    while (SR_ERR_NOMEM != err_rc &&
+            (SR_ERR_OK == (rc = sr_get_change_next(session, iter, &op, &old_val, &new_val)))) {
+
+        change_xpath = new_val ? new_val->xpath : old_val->xpath;
+        SRP_LOG_DBG("A change detected in '%s', op=%d", change_xpath, op);
+
+        op_rc = SR_ERR_OK;
+        is_ip = NULL != strstr(change_xpath, "/ietf-ip:");
+        is_ipv6 = NULL != strstr(change_xpath, "/ietf-ip:ipv6/address");
+        ch = NULL;
+        if ((!is_ip && SR_OP_DELETED == op && sc_if_change_is_entry(change_xpath)) ||
+            (!is_ip && sr_xpath_node_name_eq(change_xpath, "enabled")) ||
+            (is_ip && NULL != strstr(change_xpath, "/address[") &&
+             (sr_xpath_node_name_eq(change_xpath, "prefix-length") ||
+              sr_xpath_node_name_eq(change_xpath, "netmask")))) {
+            key = sr_xpath_key_value((char *)change_xpath, "interface", "name", &xpath_ctx);
+            if (NULL != key) {
+                strncpy(if_name, key, sizeof(if_name) - 1);
+                if_name[sizeof(if_name) - 1] = '\0';
+            }
+            sr_xpath_recover(&xpath_ctx);
+            if (NULL != key && NULL == (ch = sc_if_change_get(if_name, change_xpath))) {
+                op_rc = SR_ERR_NOMEM;
+            }
+        }
+
+        if (NULL != ch && !is_ip && sc_if_change_is_entry(change_xpath)) {
+            ch->deleted = true;
+        } else if (NULL != ch) {
+            op_rc = is_ip ? sc_if_change_address(ch, op, old_val, new_val, is_ipv6)
+                          : sc_if_change_enabled(ch, op, old_val, new_val);
+        }
+        if (SR_ERR_INVAL_ARG == op_rc) {
+            sr_set_error(session, "Invalid address.", change_xpath);
+        }
+        if (SR_ERR_OK == err_rc) {
+            err_rc = op_rc;
+        }
+        sr_free_val(old_val);
+        sr_free_val(new_val);
+    }
+    sr_free_change_iter(iter);
+
+    /* the configuration of the interface is removed, its enabled leaf with
+     * it: disable the interface, the default applies to existing entries */
+    for (ch = g_if_config.changes; ch < g_if_config.changes + g_if_config.n_changes; ch++) {
+        if (ch->deleted && ch->enabled >= 0) {
+            ch->enabled = 0;
+        }
+    }
+
+    return err_rc;
+}
+
+/* Whether two prefixes overlap, the shorter one containing the other. */
+static bool
+sc_if_prefix_overlap(const u8 *a, u8 a_len, const u8 *b, u8 b_len)
+{
+    u8 len = a_len < b_len ? a_len : b_len;
+    u8 mask;
+
+    if (0 != memcmp(a, b, len / 8)) {
+        return false;
+    }
+    if (0 == len % 8) {
+        return true;
+    }
+    mask = (u8)(0xff << (8 - len % 8));
+
+    return (a[len / 8] & mask) == (b[len / 8] & mask);
+}
+
+/*
+ * Whether VPP refuses address a on interface a_name while address b is on
+ * interface b_name: they overlap, unless both are on the same interface with
+ * the same prefix length, a subnet having several addresses.
+ */
+static bool
+sc_if_addr_conflicts(const char *a_name, const sc_if_addr_change_t *a,
+                     const char *b_name, const u8 *b, u8 b_len)
+{
+    if (!sc_if_prefix_overlap(a->address, a->prefix_length, b, b_len)) {
+        return false;
+    }
+
+    return 0 != strncmp(a_name, b_name, VPP_INTFC_NAME_LEN) || a->prefix_length != b_len;
+}
+
+/* Whether the change set removes the address from the interface. */
+static bool
+sc_if_change_removes(const char *if_name, bool is_ipv6, const sc_ip_addr_t *addr)
+{
+    const sc_if_change_t *ch = NULL;
+    const sc_if_addr_change_t *a = NULL;
+    int i;
+
+    i = sc_name_index_find(&g_if_config.change_names, if_name);
+    if (i < 0) {
+        return false;
+    }
+    ch = &g_if_config.changes[i];
+    for (a = ch->addrs; a < ch->addrs + ch->n_addrs; a++) {
+        if (!a->add && a->is_ipv6 == is_ipv6 &&
+            a->prefix_length == addr->prefix_length &&
+            0 == memcmp(a->address, addr->address, VPP_IP6_ADDRESS_LEN)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Interface of an address a new one of ch conflicts with, NULL if none:
+ * one the change set adds before, or one VPP has that stays configured.
+ * Called with g_if_addr_lock held, the entries of ifs being current.
+ */
+static const char *
+sc_if_change_conflict(const sc_if_change_t *ch, const sc_if_addr_change_t *a,
+                      const u32 *ifs, u32 n_ifs)
+{
+    const sc_if_change_t *other = NULL;
+    const sc_if_addr_change_t *b = NULL;
+    const sc_if_addr_entry *entry = NULL;
+    const sc_ip_addr_t *x = NULL;
+    u32 i, j;
+
+    for (other = g_if_config.changes; other <= ch; other++) {
+        for (b = other->addrs; b < other->addrs + other->n_addrs && b != a; b++) {
+            if (b->add && b->is_ipv6 == a->is_ipv6 &&
+                sc_if_addr_conflicts(ch->name, a, other->name, b->address, b->prefix_length)) {
+                return other->name;
+            }
+        }
+    }
+
+    for (i = 0; i < n_ifs; i++) {
+        entry = &g_if_addr[ifs[i]];
+        for (j = 0; j < entry->addrs.n_addrs[a->is_ipv6]; j++) {
+            x = &entry->addrs.addrs[a->is_ipv6][j];
+            /* link-local addresses are per interface */
+            if (a->is_ipv6 && 0xfe == x->address[0] && 0x80 == (x->address[1] & 0xc0)) {
+                continue;
+            }
+            if (sc_if_addr_conflicts(ch->name, a, entry->name, x->address, x->prefix_length) &&
+                !sc_if_change_removes(entry->name, a->is_ipv6, x)) {
+                return entry->name;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Reject at SR_EV_VERIFY the new addresses VPP would refuse at
+ * SR_EV_APPLY, whose errors sysrepo ignores: those overlapping an address
+ * of another interface, or one of another prefix length on the same
+ * interface. The addresses of VPP are read through the address cache.
+ */
+static int
+sc_if_change_check(sr_session_ctx_t *session)
+{
+    const sc_sw_interface_dump_ctx *snapshot = NULL;
+    sc_snapshot_ref_t *ref = NULL;
+    const sc_if_change_t *ch = NULL;
+    const sc_if_addr_change_t *a = NULL;
+    const scVppIntfc *intfc = NULL;
+    const char *other = NULL;
+    char msg[VPP_INTFC_NAME_LEN + 64];
+    u32 *ifs = NULL;
+    u32 i, n_ifs = 0;
+    bool adds = false;
+    int rc = SR_ERR_OK;
+    u64 now;
+
+    for (ch = g_if_config.changes; ch < g_if_config.changes + g_if_config.n_changes; ch++) {
+        for (a = ch->addrs; a < ch->addrs + ch->n_addrs; a++) {
+            adds |= a->add;
+        }
+    }
+    if (!adds) {
+        return SR_ERR_OK;
+    }
+
+    snapshot = sc_interface_snapshot_acquire(&ref);
+    if (NULL != snapshot && 0 != snapshot->num_ifs &&
+        NULL == (ifs = calloc(snapshot->num_ifs, sizeof(*ifs)))) {
+        sc_interface_snapshot_release(ref);
+        return SR_ERR_NOMEM;
+    }
+    for (i = 0; NULL != snapshot && i < snapshot->num_ifs; i++) {
+        sc_if_addr_track(snapshot->intfcArray[i].sw_if_index,
+                         snapshot->intfcArray[i].interface_name);
+    }
+
+    now = sc_if_addr_now_ms();
+    pthread_mutex_lock(&g_if_addr_lock);
+    for (i = 0; NULL != snapshot && i < snapshot->num_ifs; i++) {
+        intfc = &snapshot->intfcArray[i];
+        if (intfc->sw_if_index < g_if_addr_len &&
+            0 == sc_if_addr_current(intfc->sw_if_index, now) &&
+            0 == strncmp(g_if_addr[intfc->sw_if_index].name, intfc->interface_name,
+                         VPP_INTFC_NAME_LEN)) {
+            ifs[n_ifs++] = intfc->sw_if_index;
+        } else {
+            SRP_LOG_DBG("Addresses of '%s' not checked.", intfc->interface_name);
+        }
+    }
+    /* every entry was current at once, none goes stale with the lock held */
+    for (ch = g_if_config.changes; ch < g_if_config.changes + g_if_config.n_changes; ch++) {
+        for (a = ch->addrs; a < ch->addrs + ch->n_addrs; a++) {
+            if (!a->add || NULL == (other = sc_if_change_conflict(ch, a, ifs, n_ifs))) {
+                continue;
+            }
+            SRP_LOG_ERR("'%s' overlaps an address of interface '%s'.", a->xpath, other);
+            snprintf(msg, sizeof(msg), "Address overlaps an address of interface %s.", other);
+            sr_set_error(session, msg, a->xpath);
+            rc = SR_ERR_VALIDATION_FAILED;
+        }
+    }
+    pthread_mutex_unlock(&g_if_addr_lock);
+    sc_interface_snapshot_release(ref);
+    free(ifs);
+
+    return rc;
+}
+
+/**
+ * @brief Stage the changes of one interface, intfc being its entry in the
+ * dump, NULL if unknown: the address removals first, the new addresses may
+ * overlap them, then the admin status.
+ */
+static int
+sc_if_change_stage(sr_session_ctx_t *session, const sc_if_change_t *ch,
+                   const scVppIntfc *intfc)
+{
+    sc_interface_op_t op = { 0, };
+    const sc_if_addr_change_t *a = NULL;
+    uint32_t if_index = ~0;
+    int rc = SR_ERR_OK;
+    u32 i;
+    int add;
+
+    if (NULL == intfc) {
+        SRP_LOG_ERR("Invalid interface name: %s", ch->name);
+        sr_set_error(session, "Invalid interface name.", ch->xpath);
+        return SR_ERR_INVAL_ARG;
+    }
+    if_index = intfc->sw_if_index;
+
+    pthread_mutex_lock(&g_if_config.lock);
+    for (add = 0; add <= 1 && SR_ERR_OK == rc; add++) {
+        for (i = 0; i < ch->n_addrs && SR_ERR_OK == rc; i++) {
+            a = &ch->addrs[i];
+            if (a->add != add) {
+                continue;
+            }
+            SRP_LOG_DBG("%s IP config on interface '%s'.", add ? "Adding" : "Removing", ch->name);
+            op.kind = SC_INTERFACE_OP_ADDR;
+            op.sw_if_index = if_index;
+            op.enable = (uint8_t)add;
+            op.is_ipv6 = (uint8_t)a->is_ipv6;
+            op.prefix_length = a->prefix_length;
+            memcpy(op.address, a->address, VPP_IP6_ADDRESS_LEN);
+            rc = sc_interface_txn_add(&g_if_config.txn, &op, a->xpath);
+        }
+    }
+    if (SR_ERR_OK == rc && ch->enabled >= 0) {
+        SRP_LOG_DBG("%s interface '%s'", ch->enabled ? "Enabling" : "Disabling", ch->name);
+        memset(&op, 0, sizeof(op));
+        op.kind = SC_INTERFACE_OP_FLAGS;
+        op.sw_if_index = if_index;
+        op.enable = (uint8_t)ch->enabled;
+        rc = sc_interface_txn_add(&g_if_config.txn, &op, ch->enabled_xpath);
+    }
+    pthread_mutex_unlock(&g_if_config.lock);
+
+    return rc;
+}
+
+/**
+ * @brief Callback to be called by any config change of module "ietf-interfaces",
+ * the ietf-ip augmentations included. The changes are grouped by interface and
+ * each interface is staged at once, invalid ones being reported each.
+ */
+static int
+sc_interface_module_change_cb(sr_session_ctx_t *session, const char *module_name,
+                              sr_notif_event_t event, void *private_ctx)
+{
+    const sc_sw_interface_dump_ctx *snapshot = NULL;
+    sc_snapshot_ref_t *ref = NULL;
+    const scVppIntfc *intfc = NULL;
+    int rc = SR_ERR_OK, op_rc = SR_ERR_OK;
+    bool dumped = false;
+    u32 i;
+
+    SRP_LOG_DBG("'%s' modified, event=%d", module_name, event);
+
+    /* the changes were staged by SR_EV_VERIFY */
+    if (SR_EV_APPLY == event) {
+        return sc_if_config_commit();
+    }
+    if (SR_EV_ABORT == event) {
+        sc_if_config_abort();
+        return SR_ERR_OK;
+    }
+
+    sc_if_config_begin();
+    rc = sc_if_change_collect(session);
+    if (SR_ERR_OK == rc) {
+        rc = sc_if_change_check(session);
+    }
+    /* every interface resolved through one dump, indexed by name */
+    if (0 != g_if_config.n_changes) {
+        snapshot = sc_interface_snapshot_acquire(&ref);
+    }
+    for (i = 0; i < g_if_config.n_changes && SR_ERR_NOMEM != rc; i++) {
+        if (0 == g_if_config.changes[i].n_addrs && g_if_config.changes[i].enabled < 0) {
+            /* only the deletion of an entry without supported leaves */
+            continue;
+        }
+        intfc = sc_interface_snapshot_find(snapshot, g_if_config.changes[i].name);
+        if (NULL == intfc && !dumped) {
+            /* the interface may be newer than the dump, dump once more */
+            sc_interface_snapshot_release(ref);
+            sc_interface_snapshot_invalidate();
+            snapshot = sc_interface_snapshot_acquire(&ref);
+            dumped = true;
+            intfc = sc_interface_snapshot_find(snapshot, g_if_config.changes[i].name);
+        }
+        op_rc = sc_if_change_stage(session, &g_if_config.changes[i], intfc);
+        if (SR_ERR_OK == rc) {
+            rc = op_rc;
+        }
     }
+    sc_interface_snapshot_release(ref);
+    sc_if_change_reset();
 
-    rc = sr_subtree_change_subscribe(session, "/ietf-interfaces:interfaces/interface/ietf-ip:ipv4/address",
-            sc_interface_ipv46_address_change_cb, g_vapi_ctx_instance, 99, SR_SUBSCR_CTX_REUSE | SR_SUBSCR_EV_ENABLED, subscription);
     if (SR_ERR_OK != rc) {
-        goto error;
+        sc_if_config_abort();
     }
 
-    rc = sr_subtree_change_subscribe(session, "/ietf-interfaces:interfaces/interface/ietf-ip:ipv6/address",
-            sc_interface_ipv46_address_change_cb, g_vapi_ctx_instance, 98, SR_SUBSCR_CTX_REUSE | SR_SUBSCR_EV_ENABLED, subscription);
+    return rc;
+}
+
+/* number of state leaves emitted per interface by sc_interface_state_cb */
+#define SC_INTERFACE_STATE_LEAVES 5
+
+/* interface count seen by the last state dump, used to size the next one */
+static size_t g_interface_count_hint = 16;
+
+typedef struct _sc_interface_state_ctx
+{
+  const char *xpath;
+  size_t n_ifs;
+  sc_vals_t vals;
+} sc_interface_state_ctx;
+
+static void sc_interface_state_ctx_free(void *result)
+{
+  sc_interface_state_ctx *sctx = result;
+
+  sc_vals_free(&sctx->vals);
+  free(sctx);
+}
+
+/**
+ * @brief Dump callback writing the state leaves of each interface directly into the sysrepo values.
+ */
+static vapi_error_e
+sc_interface_state_dump_cb (struct vapi_ctx_s *ctx, void *callback_ctx,
+                            vapi_error_e rv, bool is_last,
+                            vapi_payload_sw_interface_details * reply)
+{
+  sc_interface_state_ctx *sctx = callback_ctx;
+  sc_vals_t *vals = &sctx->vals;
+  const char *name;
+  sr_val_t *val;
+
+  if (is_last || SR_ERR_OK != vals->rc)
+    return VAPI_OK;
+
+  name = (const char *)reply->interface_name;
+  sc_if_addr_track(reply->sw_if_index, name);
+  sctx->n_ifs++;
+  if (SR_ERR_OK != sc_vals_entry(vals, "%s[name='%s']", sctx->xpath, name))
+    return VAPI_EINVAL;
+
+  /* currently the only supported interface types are propVirtual / ethernetCsmacd */
+  sc_vals_leaf_str(vals, "type", SR_IDENTITYREF_T,
+          strstr(name, "local0") ? "iana-if-type:propVirtual" : "iana-if-type:ethernetCsmacd");
+
+  sc_vals_leaf_str(vals, "admin-status", SR_ENUM_T,
+          reply->admin_up_down ? "up" : "down");
+
+  sc_vals_leaf_str(vals, "oper-status", SR_ENUM_T,
+          reply->link_up_down ? "up" : "down");
+
+  val = sc_vals_leaf(vals, "phys-address");
+  if (NULL != val) {
+      const u8 *mac = reply->l2_address;
+      static const u8 zero_mac[6] = { 0, };
+      if (reply->l2_address_length == 0)
+          mac = zero_mac;
+      vals->rc = sr_val_build_str_data(val, SR_STRING_T, "%02x:%02x:%02x:%02x:%02x:%02x",
+              mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+  }
+
+  val = sc_vals_leaf(vals, "speed");
+  if (NULL != val) {
+      val->type = SR_UINT64_T;
+      val->data.uint64_val = sc_link_speed_to_bps(reply->link_speed);
+  }
+
+  return SR_ERR_OK == vals->rc ? VAPI_OK : VAPI_ENOMEM;
+}
+
+/**
+ * @brief Dump interfaces into sysrepo values sized from the previous dump, without an intermediate copy.
+ */
+static int sc_interface_state_dump(void *arg, void **result)
+{
+  sc_interface_state_ctx *sctx = calloc(1, sizeof(*sctx));
+  vapi_msg_sw_interface_dump *dump;
+  vapi_error_e rv;
+
+  if (sctx == NULL)
+    return SR_ERR_NOMEM;
+  *result = sctx;
+
+  sctx->xpath = arg;
+  if (SR_ERR_OK != sc_vals_init(&sctx->vals, g_interface_count_hint * SC_INTERFACE_STATE_LEAVES))
+    return sctx->vals.rc;
+
+  sc_if_addr_track_begin();
+  dump = vapi_alloc_sw_interface_dump (g_vapi_ctx_instance);
+  dump->payload.name_filter_valid = 0;
+  memset (dump->payload.name_filter, 0, sizeof (dump->payload.name_filter));
+  while (VAPI_EAGAIN ==
+         (rv =
+          vapi_sw_interface_dump (g_vapi_ctx_instance, dump, sc_interface_state_dump_cb,
+                                  sctx)));
+  if (VAPI_OK != rv && SR_ERR_OK == sctx->vals.rc)
+    sctx->vals.rc = SR_ERR_INTERNAL;
+
+  /* sysrepo asks for the address lists of each interface next, fetch them in one go */
+  sc_if_addr_refresh();
+
+  if (SR_ERR_OK == sctx->vals.rc && sctx->n_ifs > 0)
+    g_interface_count_hint = sctx->n_ifs;
+
+  return sctx->vals.rc;
+}
+
+typedef struct _sc_interface_addr_state_ctx
+{
+  bool is_ipv6;
+  const char *xpath;
+  sc_vals_t vals;
+} sc_interface_addr_state_ctx;
+
+static int
+sc_interface_addr_state_add (const sc_ip_addr_t *addr, void *ctx)
+{
+  sc_interface_addr_state_ctx *actx = ctx;
+  char ip[VPP_IP6_ADDRESS_STRING_LEN];
+  sr_val_t *val;
+
+  if (NULL == inet_ntop(actx->is_ipv6 ? AF_INET6 : AF_INET, addr->address, ip, sizeof(ip)))
+    return -1;
+
+  if (SR_ERR_OK != sc_vals_entry(&actx->vals, "%s[ip='%s']", actx->xpath, ip))
+    return -1;
+
+  val = sc_vals_leaf(&actx->vals, "prefix-length");
+  if (NULL != val) {
+      val->type = SR_UINT8_T;
+      val->data.uint8_val = addr->prefix_length;
+  }
+
+  sc_vals_leaf_str(&actx->vals, "origin", SR_ENUM_T, "static");
+
+  return SR_ERR_OK == actx->vals.rc ? 0 : -1;
+}
+
+/**
+ * @brief State data of "/ietf-interfaces:interfaces-state/interface/ietf-ip:ipv4/address"
+ * and ".../ietf-ip:ipv6/address", served from the address cache.
+ */
+static int
+sc_interface_addr_state_cb(const char *xpath, sr_val_t **values, size_t *values_cnt)
+{
+    sc_interface_addr_state_ctx actx = { .xpath = xpath };
+    sr_xpath_ctx_t xpath_ctx = { 0, };
+    char if_name[VPP_INTFC_NAME_LEN] = { 0, };
+    char *node_name = NULL, *key = NULL;
+
+    *values = NULL;
+    *values_cnt = 0;
+
+    node_name = sr_xpath_node_idx((char*)xpath, 2, &xpath_ctx);
+    actx.is_ipv6 = (NULL != node_name && 0 == strcmp(node_name, "ipv6"));
+    sr_xpath_recover(&xpath_ctx);
+
+    key = sr_xpath_key_value((char*)xpath, "interface", "name", &xpath_ctx);
+    if (NULL != key) {
+        strncpy(if_name, key, sizeof(if_name) - 1);
+    }
+    sr_xpath_recover(&xpath_ctx);
+    if (NULL == key) {
+        return SR_ERR_INVAL_ARG;
+    }
+
+    if (SR_ERR_OK != sc_vals_init(&actx.vals, 4)) {
+        return actx.vals.rc;
+    }
+
+    if (0 != sc_interface_addr_walk(if_name, actx.is_ipv6, sc_interface_addr_state_add, &actx)) {
+        /* unknown interface or failed dump, report no addresses */
+        sc_vals_free(&actx.vals);
+        return SR_ERR_OK == actx.vals.rc ? SR_ERR_OK : actx.vals.rc;
+    }
+
+    return sc_vals_finish(&actx.vals, values, values_cnt);
+}
+
+/* number of leaves of "/ietf-interfaces:interfaces-state/interface/statistics" */
+#define SC_INTERFACE_STATISTICS_LEAVES 12
+
+static int if_stats_load(void **data)
+{
+  sc_if_stats_t *stats = calloc(1, sizeof(*stats));
+  if (stats == NULL)
+    return -1;
+
+  *data = stats;
+  return sc_stats_if_read(stats);
+}
+
+static void if_stats_free(void *data)
+{
+  sc_if_stats_free(data);
+  free(data);
+}
+
+static sc_snapshot_t g_if_stats_snapshot =
+  SC_SNAPSHOT_INIT(SC_INTERFACE_STATS_KEY, if_stats_load, if_stats_free,
+                   SC_INTERFACE_STATS_TTL_MS);
+
+static void
+sc_interface_stat_leaf(sc_vals_t *vals, const char *leaf, sr_type_t type, u64 value)
+{
+    sr_val_t *val = sc_vals_leaf(vals, leaf);
+
+    if (NULL == val) {
+        return;
+    }
+    val->type = type;
+    if (SR_UINT64_T == type) {
+        val->data.uint64_val = value;
+    } else {
+        /* counter32 wraps like the 32-bit counters it models */
+        val->data.uint32_val = (uint32_t)value;
+    }
+}
+
+/**
+ * @brief State data of "/ietf-interfaces:interfaces-state/interface/statistics",
+ * read from the VPP stats segment without any binary API request.
+ */
+static int
+sc_interface_statistics_cb(const char *xpath, sr_val_t **values, size_t *values_cnt)
+{
+    sr_xpath_ctx_t xpath_ctx = { 0, };
+    char if_name[VPP_INTFC_NAME_LEN] = { 0, };
+    char time_str[32];
+    sc_snapshot_ref_t *ref = NULL;
+    const sc_if_stats_t *stats = NULL;
+    const sc_if_counters_t *c = NULL;
+    sc_vals_t vals;
+    char *key = NULL;
+    u32 sw_if_index = ~0;
+    struct tm tm;
+    time_t t;
+
+    *values = NULL;
+    *values_cnt = 0;
+
+    key = sr_xpath_key_value((char*)xpath, "interface", "name", &xpath_ctx);
+    if (NULL != key) {
+        strncpy(if_name, key, sizeof(if_name) - 1);
+    }
+    sr_xpath_recover(&xpath_ctx);
+    if (NULL == key) {
+        return SR_ERR_INVAL_ARG;
+    }
+
+    /* sysrepo lists the interfaces first, their indexes are known by now */
+    if (0 != sc_if_addr_index(if_name, &sw_if_index) &&
+        0 != sc_interface_name2index(if_name, &sw_if_index)) {
+        return SR_ERR_OK;
+    }
+
+    ref = sc_snapshot_acquire(&g_if_stats_snapshot);
+    stats = sc_snapshot_data(ref);
+    if (NULL == stats) {
+        SRP_LOG_ERR_MSG("Error by reading the interface counters.");
+        sc_snapshot_release(ref);
+        return SR_ERR_INTERNAL;
+    }
+    if (sw_if_index >= stats->n_ifs) {
+        sc_snapshot_release(ref);
+        return SR_ERR_OK;
+    }
+    c = &stats->counters[sw_if_index];
+
+    if (SR_ERR_OK != sc_vals_init(&vals, SC_INTERFACE_STATISTICS_LEAVES)) {
+        sc_snapshot_release(ref);
+        return vals.rc;
+    }
+
+    sc_vals_entry(&vals, "/ietf-interfaces:interfaces-state/interface[name='%s']/statistics",
+                  if_name);
+
+    t = sc_stats_discontinuity_time();
+    gmtime_r(&t, &tm);
+    strftime(time_str, sizeof(time_str), "%Y-%m-%dT%H:%M:%SZ", &tm);
+    sc_vals_leaf_str(&vals, "discontinuity-time", SR_STRING_T, time_str);
+
+    sc_interface_stat_leaf(&vals, "in-octets", SR_UINT64_T, c->rx_bytes);
+    sc_interface_stat_leaf(&vals, "in-unicast-pkts", SR_UINT64_T, c->rx_unicast_packets);
+    sc_interface_stat_leaf(&vals, "in-broadcast-pkts", SR_UINT64_T, c->rx_broadcast_packets);
+    sc_interface_stat_leaf(&vals, "in-multicast-pkts", SR_UINT64_T, c->rx_multicast_packets);
+    sc_interface_stat_leaf(&vals, "in-discards", SR_UINT32_T,
+                           c->drops + c->rx_no_buf + c->rx_miss);
+    sc_interface_stat_leaf(&vals, "in-errors", SR_UINT32_T, c->rx_errors);
+    sc_interface_stat_leaf(&vals, "out-octets", SR_UINT64_T, c->tx_bytes);
+    sc_interface_stat_leaf(&vals, "out-unicast-pkts", SR_UINT64_T, c->tx_unicast_packets);
+    sc_interface_stat_leaf(&vals, "out-broadcast-pkts", SR_UINT64_T, c->tx_broadcast_packets);
+    sc_interface_stat_leaf(&vals, "out-multicast-pkts", SR_UINT64_T, c->tx_multicast_packets);
+    sc_interface_stat_leaf(&vals, "out-errors", SR_UINT32_T, c->tx_errors);
+    sc_snapshot_release(ref);
+
+    return sc_vals_finish(&vals, values, values_cnt);
+}
+
+/**
+ * @brief Callback to be called by any request for state data under "/ietf-interfaces:interfaces-state/interface" path.
+ */
+static int
+sc_interface_state_cb(const char *xpath, sr_val_t **values, size_t *values_cnt, void *private_ctx)
+{
+    sc_singleflight_call_t *call = NULL;
+    sc_interface_state_ctx *sctx;
+    int rc = 0;
+
+    SRP_LOG_DBG("Requesting state data for '%s'", xpath);
+
+    if (sr_xpath_node_name_eq(xpath, "address")) {
+        return sc_interface_addr_state_cb(xpath, values, values_cnt);
+    }
+
+    if (sr_xpath_node_name_eq(xpath, "statistics")) {
+        return sc_interface_statistics_cb(xpath, values, values_cnt);
+    }
+
+    if (! sr_xpath_node_name_eq(xpath, "interface")) {
+        /* neighbor state data not supported */
+        *values = NULL;
+        *values_cnt = 0;
+        return SR_ERR_OK;
+    }
+
+    /* dump interfaces, shared with concurrent readers of the same xpath */
+    rc = sc_singleflight_do(xpath, sc_interface_state_dump, (void *)xpath,
+                            sc_interface_state_ctx_free, &call);
+    sctx = sc_singleflight_result(call);
+    if (SR_ERR_OK != rc || NULL == sctx || 0 == sctx->vals.values_cnt) {
+        SRP_LOG_ERR_MSG("Error by processing of a interface dump request.");
+        sc_singleflight_release(call);
+        return SR_ERR_INTERNAL;
+    }
+
+    if (NULL != (sctx = sc_singleflight_steal(call))) {
+        /* nobody else is reading the dump, hand over the values as they are */
+        sc_vals_finish(&sctx->vals, values, values_cnt);
+        free(sctx);
+    } else {
+        sctx = sc_singleflight_result(call);
+        rc = sr_dup_values(sctx->vals.values, sctx->vals.values_cnt, values);
+        if (SR_ERR_OK != rc) {
+            sc_singleflight_release(call);
+            return rc;
+        }
+        *values_cnt = sctx->vals.values_cnt;
+    }
+    sc_singleflight_release(call);
+
+    SRP_LOG_DBG("Returning %zu state data elements for '%s'", *values_cnt, xpath);
+
+    return SR_ERR_OK;
+}
+
+/**
+ * @brief Callback to be called by plugin daemon upon plugin unload.
+ */
+void
+sc_interface_cleanup()
+{
+    u32 i;
+
+    pthread_mutex_lock(&g_if_config.lock);
+    sc_interface_txn_free(&g_if_config.txn);
+    sc_if_change_reset();
+    for (i = 0; i < g_if_config.cap_changes; i++) {
+        free(g_if_config.changes[i].addrs);
+    }
+    free(g_if_config.changes);
+    g_if_config.changes = NULL;
+    g_if_config.cap_changes = 0;
+    sc_name_index_free(&g_if_config.change_names);
+    pthread_mutex_unlock(&g_if_config.lock);
+
+    pthread_mutex_lock(&g_if_batch.lock);
+    sc_disconnect_vpp_private(g_if_batch.vapi_ctx);
+    g_if_batch.vapi_ctx = NULL;
+    pthread_mutex_unlock(&g_if_batch.lock);
+}
+
+int
+sc_interface_subscribe_events(sr_session_ctx_t *session,
+			      sr_subscription_ctx_t **subscription)
+{
+    int rc = SR_ERR_OK;
+
+    SRP_LOG_DBG_MSG("Initializing vpp-interfaces plugin.");
+
+    /* one callback per commit, its changes grouped by interface; no
+     * SR_SUBSCR_EV_ENABLED: the startup configuration is applied in bulk
+     * by the reconciler, not replayed leaf by leaf through the callback */
+    rc = sr_module_change_subscribe(session, "ietf-interfaces", sc_interface_module_change_cb,
+            g_vapi_ctx_instance, 0, SR_SUBSCR_CTX_REUSE, subscription);
     if (SR_ERR_OK != rc) {
         goto error;
     }
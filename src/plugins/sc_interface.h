@@ -17,6 +17,8 @@
 #define SC_INTERFACE_H
 
 #include "sc_vpp_operation.h"
+#include "sc_snapshot.h"
+#include "sc_name_index.h"
 
 #include <vapi/interface.api.vapi.h>
 
@@ -38,21 +40,134 @@ typedef struct _sc_sw_interface_dump_ctx
   size_t num_ifs;
   size_t capacity;
   scVppIntfc * intfcArray;
+  sc_name_index_t names;        /* intfcArray by interface_name */
 } sc_sw_interface_dump_ctx;
 
 int sc_initSwInterfaceDumpCTX(sc_sw_interface_dump_ctx * dctx);
 int sc_freeSwInterfaceDumpCTX(sc_sw_interface_dump_ctx * dctx);
+/**
+ * Dump all the interfaces into dctx on ctx, indexed by name, -1 when the dump
+ * failed. dctx must not be moved, its index refers to it.
+ */
+int sc_interface_dump(vapi_ctx_t ctx, sc_sw_interface_dump_ctx * dctx);
+/* Same on g_vapi_ctx_instance, the number of interfaces or -1. */
 int sc_swInterfaceDump(sc_sw_interface_dump_ctx * dctx);
 u32 sc_interface_name2index(const char *name, u32* if_index);
+u64 sc_link_speed_to_bps(u32 link_speed);
+
+/**
+ * Interfaces of a recent full sw_interface_dump, shared read-only by all
+ * readers within the snapshot window. NULL when the dump failed, the
+ * reference must be released in any case.
+ */
+const sc_sw_interface_dump_ctx *sc_interface_snapshot_acquire(sc_snapshot_ref_t **ref);
+void sc_interface_snapshot_release(sc_snapshot_ref_t *ref);
+void sc_interface_snapshot_invalidate();
+const scVppIntfc *sc_interface_snapshot_find(const sc_sw_interface_dump_ctx *dctx,
+                                             const char *name);
+const scVppIntfc *sc_interface_snapshot_find_index(const sc_sw_interface_dump_ctx *dctx,
+                                                   u32 sw_if_index);
+
+/* Cached IPv4/IPv6 address of an interface. */
+typedef struct _sc_ip_addr
+{
+  u8 address[VPP_IP6_ADDRESS_LEN];
+  u8 prefix_length;
+} sc_ip_addr_t;
+
+/* Addresses of one interface, arrays indexed by is_ipv6. */
+typedef struct _sc_if_addrs
+{
+  sc_ip_addr_t *addrs[2];
+  u32 n_addrs[2];
+  u32 cap_addrs[2];
+} sc_if_addrs_t;
+
+/**
+ * Dump the IPv4 and IPv6 addresses of an interface into addrs on ctx,
+ * reusing its arrays. Bypasses the cache below, addrs is released with
+ * sc_interface_addrs_free().
+ */
+int sc_interface_addr_dump(vapi_ctx_t ctx, u32 sw_if_index, sc_if_addrs_t *addrs);
+void sc_interface_addrs_free(sc_if_addrs_t *addrs);
+
+typedef int (*sc_interface_addr_walk_fn)(const sc_ip_addr_t *addr, void *ctx);
+
+/**
+ * Walk the cached addresses of an interface seen by the last interfaces-state
+ * dump, the walk stops at the first non-zero return of fn. Returns -1 when
+ * the interface is unknown or its addresses could not be dumped.
+ */
+int sc_interface_addr_walk(const char *if_name, bool is_ipv6,
+                           sc_interface_addr_walk_fn fn, void *ctx);
+void sc_interface_addr_invalidate(u32 sw_if_index);
+
+/* Kind of a VPP request of a batch. */
+typedef enum
+{
+  SC_INTERFACE_OP_FLAGS,
+  SC_INTERFACE_OP_ADDR,
+} sc_interface_op_kind_t;
 
-i32 sc_interface_add_del_addr( u32 sw_if_index, u8 is_add, u8 is_ipv6, u8 del_all,
-			       u8 address_length, u8 address[VPP_IP6_ADDRESS_LEN] );
-i32 sc_setInterfaceFlags(u32 sw_if_index, u8 admin_up_down);
+/* One VPP request of a batch. */
+typedef struct _sc_interface_op
+{
+  sc_interface_op_kind_t kind;
+  u32 sw_if_index;
+  u8 enable;                    /* admin up for FLAGS, add for ADDR */
+  u8 is_ipv6;
+  u8 prefix_length;
+  u8 address[VPP_IP6_ADDRESS_LEN];
+  char *xpath;                  /* change reported when the request fails */
+} sc_interface_op_t;
 
+/*
+ * Configuration changes applied to VPP as one pipelined batch, see
+ * sc_batch.h, in the order they were added. Zero-initialized when empty.
+ */
+typedef struct _sc_interface_txn
+{
+  sc_interface_op_t *ops;
+  u32 n_ops;
+  u32 cap_ops;
+} sc_interface_txn_t;
+
+int sc_interface_txn_flags(sc_interface_txn_t *txn, u32 sw_if_index, bool enable,
+                           const char *xpath);
+int sc_interface_txn_addr(sc_interface_txn_t *txn, u32 sw_if_index, bool add, bool is_ipv6,
+                          u8 prefix_length, const u8 address[VPP_IP6_ADDRESS_LEN],
+                          const char *xpath);
+/*
+ * Run the requests of txn and empty it, each failure is logged with its
+ * xpath. Returns the number of requests that failed, -1 if none could run.
+ * Batches of different transactions are serialized.
+ */
+int sc_interface_txn_commit(sc_interface_txn_t *txn);
+void sc_interface_txn_clear(sc_interface_txn_t *txn);
+void sc_interface_txn_free(sc_interface_txn_t *txn);
+
+/**
+ * Order a batch built from the running configuration with the change sets
+ * of ietf-interfaces, so a change committed while the batch was built is not
+ * reverted by it.
+ *
+ * sc_interface_config_mark() waits for the change set being verified or
+ * applied, if any, and returns the generation of the configuration to read.
+ * sc_interface_config_hold() fails if a change set was verified since that
+ * generation, the batch must then be built again; otherwise new change sets
+ * wait at verify until sc_interface_config_release(), called once the batch
+ * is applied.
+ */
+u64 sc_interface_config_mark();
+int sc_interface_config_hold(u64 generation);
+void sc_interface_config_release();
 
 int
 sc_interface_subscribe_events(sr_session_ctx_t *session,
 			      sr_subscription_ctx_t **subscription);
 
+/* Close the connection configuration changes are applied on. */
+void sc_interface_cleanup();
+
 #endif /* SC_INTERFACE_H */
 
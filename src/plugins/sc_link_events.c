@@ -0,0 +1,466 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+#include "sc_link_events.h"
+#include "sc_notify.h"
+#include "sc_values.h"
+#include <sysrepo/plugins.h>
+#include <sysrepo/values.h>
+#include <vapi/interface.api.vapi.h>
+
+#define SC_LINK_EVENTS_XPATH "/sweetcomb-telemetry:telemetry/link-events"
+#define SC_LINK_NOTIF_XPATH "/sweetcomb-telemetry:link-state-change"
+#define SC_LINK_APP_NAME "sweetcomb_link_events"
+#define SC_LINK_WINDOW_MS 5000
+
+/* longest wait for an event, the resolution of the windows */
+#define SC_LINK_WAIT_S 1
+/* interfaces the tables are sized for, they grow past them */
+#define SC_LINK_IFS_HINT 1024
+
+/* name, admin-status, oper-status, admin-transitions, oper-transitions */
+#define SC_LINK_LEAVES 5
+
+/* Events of one interface within its window. */
+typedef struct
+{
+    bool seen;                  /* the state below is known */
+    bool pending;               /* in the pending list */
+    bool deleted;               /* the next event is of a new interface */
+    u8 admin_up;
+    u8 oper_up;
+    u32 admin_transitions;
+    u32 oper_transitions;
+    u64 deadline_ms;            /* CLOCK_MONOTONIC end of the window */
+} sc_link_if_t;
+
+static struct
+{
+    pthread_mutex_t lock;       /* thread life cycle and window_ms */
+    pthread_t thread;
+    bool running;
+    bool stop;
+    u32 window_ms;
+
+    /* only touched by the events thread */
+    vapi_ctx_t vapi_ctx;
+    sr_conn_ctx_t *connection;
+    sr_session_ctx_t *session;
+    u32 window_cur_ms;
+    sc_link_if_t *ifs;          /* indexed by sw_if_index */
+    u32 *pending;               /* interfaces with an open window */
+    u32 n_pending;
+    u32 cap_ifs;                /* of both ifs and pending */
+} g_link = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .window_ms = SC_LINK_WINDOW_MS,
+};
+
+static u64
+sc_link_now_ms()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int
+sc_link_reserve(u32 n_ifs)
+{
+    sc_link_if_t *ifs = NULL;
+    u32 *pending = NULL;
+    u32 cap = g_link.cap_ifs ? g_link.cap_ifs : SC_LINK_IFS_HINT;
+
+    while (cap < n_ifs) {
+        cap *= 2;
+    }
+    if (cap == g_link.cap_ifs) {
+        return 0;
+    }
+
+    ifs = realloc(g_link.ifs, cap * sizeof(*ifs));
+    if (NULL == ifs) {
+        return -1;
+    }
+    g_link.ifs = ifs;
+    memset(&ifs[g_link.cap_ifs], 0, (cap - g_link.cap_ifs) * sizeof(*ifs));
+
+    pending = realloc(g_link.pending, cap * sizeof(*pending));
+    if (NULL == pending) {
+        /* ifs grew alone, harmless: cap_ifs still bounds both */
+        return -1;
+    }
+    g_link.pending = pending;
+    g_link.cap_ifs = cap;
+
+    return 0;
+}
+
+/**
+ * @brief Fold an event into the window of its interface.
+ *
+ * Called for every event, it only updates the flat tables: nothing is
+ * allocated unless VPP reports an index past all those seen so far.
+ */
+static void
+sc_link_event(const vapi_payload_sw_interface_event *ev)
+{
+    sc_link_if_t *e = NULL;
+    u32 idx = ev->sw_if_index;
+
+    if (idx >= g_link.cap_ifs && 0 != sc_link_reserve(idx + 1)) {
+        return;
+    }
+    e = &g_link.ifs[idx];
+
+    /* VPP sends events on changes only: the first one of an interface is a
+     * transition from its last dumped state, or from down for a new one */
+    if (e->deleted ||
+        (!e->seen && 0 != sc_notify_if_status(idx, &e->admin_up, &e->oper_up))) {
+        e->admin_up = e->oper_up = 0;
+    }
+    if (!ev->deleted) {
+        if (e->admin_up != ev->admin_up_down) {
+            e->admin_transitions++;
+        }
+        if (e->oper_up != ev->link_up_down) {
+            e->oper_transitions++;
+        }
+    }
+    e->seen = true;
+    e->deleted = ev->deleted;
+    e->admin_up = ev->admin_up_down;
+    e->oper_up = ev->link_up_down;
+
+    if (!e->pending) {
+        e->pending = true;
+        e->deadline_ms = sc_link_now_ms() + g_link.window_cur_ms;
+        g_link.pending[g_link.n_pending++] = idx;
+        /* the notifier catches up with the state once per window */
+        sc_notify_hint();
+    }
+}
+
+static vapi_error_e
+sc_link_event_cb(vapi_ctx_t ctx, void *callback_ctx, void *payload)
+{
+    sc_link_event(payload);
+    return VAPI_OK;
+}
+
+static void
+sc_link_count_leaf(sc_vals_t *vals, const char *leaf, u32 value)
+{
+    sr_val_t *val = sc_vals_leaf(vals, leaf);
+
+    if (NULL != val) {
+        val->type = SR_UINT32_T;
+        val->data.uint32_val = value;
+    }
+}
+
+static void
+sc_link_send(const char *name, const sc_link_if_t *e)
+{
+    sr_val_t *values = NULL;
+    size_t values_cnt = 0;
+    sc_vals_t vals;
+    int rc;
+
+    if (SR_ERR_OK != sc_vals_init(&vals, SC_LINK_LEAVES)) {
+        return;
+    }
+    sc_vals_entry(&vals, SC_LINK_NOTIF_XPATH);
+    sc_vals_leaf_str(&vals, "name", SR_STRING_T, name);
+    sc_vals_leaf_str(&vals, "admin-status", SR_ENUM_T, e->admin_up ? "up" : "down");
+    sc_vals_leaf_str(&vals, "oper-status", SR_ENUM_T, e->oper_up ? "up" : "down");
+    sc_link_count_leaf(&vals, "admin-transitions", e->admin_transitions);
+    sc_link_count_leaf(&vals, "oper-transitions", e->oper_transitions);
+
+    if (SR_ERR_OK != sc_vals_finish(&vals, &values, &values_cnt)) {
+        SRP_LOG_ERR("Unable to build the link state change of '%s'.", name);
+        return;
+    }
+
+    rc = sr_event_notif_send(g_link.session, SC_LINK_NOTIF_XPATH, values, values_cnt,
+                             SR_EV_NOTIF_DEFAULT);
+    if (SR_ERR_OK != rc) {
+        SRP_LOG_ERR("Unable to notify the link state change of '%s': %s",
+                    name, sr_strerror(rc));
+    }
+    sr_free_values(values, values_cnt);
+}
+
+/* Notify the interfaces whose window is over, events thread only. */
+static void
+sc_link_flush(u64 now_ms)
+{
+    char name[VPP_INTFC_NAME_LEN];
+    sc_link_if_t *e = NULL;
+    u32 i = 0, idx;
+
+    while (i < g_link.n_pending) {
+        idx = g_link.pending[i];
+        e = &g_link.ifs[idx];
+        if (now_ms < e->deadline_ms) {
+            i++;
+            continue;
+        }
+
+        if (e->deleted) {
+            /* the removal is notified by interface-state-change, the next
+             * event of the index is of a new interface */
+            memset(e, 0, sizeof(*e));
+            e->deleted = true;
+        } else if (0 == sc_notify_if_name(idx, name)) {
+            sc_link_send(name, e);
+        } else if (now_ms < e->deadline_ms + g_link.window_cur_ms) {
+            /* created after the last dump of the notifier, named soon */
+            i++;
+            continue;
+        }
+
+        e->pending = false;
+        e->admin_transitions = 0;
+        e->oper_transitions = 0;
+        g_link.pending[i] = g_link.pending[--g_link.n_pending];
+    }
+}
+
+static vapi_error_e
+sc_link_want_cb(struct vapi_ctx_s *ctx, void *callback_ctx, vapi_error_e rv,
+                bool is_last, vapi_payload_want_interface_events_reply *reply)
+{
+    if (VAPI_OK == rv && NULL != reply && 0 != reply->retval) {
+        return VAPI_EINVAL;
+    }
+    return rv;
+}
+
+static void
+sc_link_disconnect()
+{
+    sc_disconnect_vpp_private(g_link.vapi_ctx);
+    g_link.vapi_ctx = NULL;
+}
+
+/* Connect to VPP and ask for the interface events. */
+static int
+sc_link_connect()
+{
+    vapi_msg_want_interface_events *msg = NULL;
+    vapi_error_e rv;
+
+    if (0 != sc_connect_vpp_private(SC_LINK_APP_NAME, &g_link.vapi_ctx)) {
+        return -1;
+    }
+
+    /* events received while waiting for the reply go through the callback */
+    vapi_set_event_cb(g_link.vapi_ctx, vapi_msg_id_sw_interface_event,
+                      sc_link_event_cb, NULL);
+
+    msg = vapi_alloc_want_interface_events(g_link.vapi_ctx);
+    if (NULL == msg) {
+        sc_link_disconnect();
+        return -1;
+    }
+    msg->payload.enable_disable = 1;
+    msg->payload.pid = getpid();
+    while (VAPI_EAGAIN == (rv = vapi_want_interface_events(g_link.vapi_ctx, msg,
+                                                           sc_link_want_cb, NULL)))
+        ;
+    if (VAPI_OK != rv) {
+        SRP_LOG_ERR("Unable to register for the interface events: %d", rv);
+        sc_link_disconnect();
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Wait for events and fold all those queued, events thread only. */
+static void
+sc_link_receive()
+{
+    vapi_msg_sw_interface_event *ev = NULL;
+    size_t size;
+    vapi_error_e rv;
+
+    rv = vapi_recv(g_link.vapi_ctx, (void **)&ev, &size, SVM_Q_TIMEDWAIT, SC_LINK_WAIT_S);
+    while (VAPI_OK == rv) {
+        if (vapi_lookup_vapi_msg_id_t(g_link.vapi_ctx, ntohs(ev->header._vl_msg_id)) ==
+            vapi_msg_id_sw_interface_event) {
+            vapi_msg_sw_interface_event_ntoh(ev);
+            sc_link_event(&ev->payload);
+        }
+        vapi_msg_free(g_link.vapi_ctx, ev);
+        rv = vapi_recv(g_link.vapi_ctx, (void **)&ev, &size, SVM_Q_NOWAIT, 0);
+    }
+
+    if (VAPI_EAGAIN != rv) {
+        /* lost VPP, register again on the next call */
+        sc_link_disconnect();
+    }
+}
+
+static void *
+sc_link_thread(void *arg)
+{
+    pthread_mutex_lock(&g_link.lock);
+    while (!g_link.stop) {
+        g_link.window_cur_ms = g_link.window_ms;
+        pthread_mutex_unlock(&g_link.lock);
+
+        if (NULL != g_link.vapi_ctx || 0 == sc_link_connect()) {
+            sc_link_receive();
+        } else {
+            sleep(SC_LINK_WAIT_S);
+        }
+        sc_link_flush(sc_link_now_ms());
+
+        pthread_mutex_lock(&g_link.lock);
+    }
+    pthread_mutex_unlock(&g_link.lock);
+
+    return NULL;
+}
+
+/**
+ * @brief Callback for "/sweetcomb-telemetry:telemetry/link-events".
+ */
+static int
+sc_link_config_cb(sr_session_ctx_t *session, const char *xpath,
+                  sr_notif_event_t event, void *private_ctx)
+{
+    u32 window_ms = SC_LINK_WINDOW_MS;
+    sr_val_t *val = NULL;
+    int rc;
+
+    if (SR_EV_APPLY != event && SR_EV_ENABLED != event) {
+        return SR_ERR_OK;
+    }
+    SRP_LOG_DBG("'%s' modified, event=%d", xpath, event);
+
+    rc = sr_get_item(session, SC_LINK_EVENTS_XPATH "/window", &val);
+    if (SR_ERR_OK == rc) {
+        if (SR_UINT32_T == val->type) {
+            window_ms = val->data.uint32_val;
+        }
+        sr_free_val(val);
+    } else if (SR_ERR_NOT_FOUND != rc) {
+        SRP_LOG_ERR("Unable to read the link events window: %s", sr_strerror(rc));
+        return rc;
+    }
+
+    /* windows already open keep their deadline */
+    pthread_mutex_lock(&g_link.lock);
+    g_link.window_ms = window_ms;
+    pthread_mutex_unlock(&g_link.lock);
+
+    return SR_ERR_OK;
+}
+
+static void
+sc_link_session_close()
+{
+    if (NULL != g_link.session) {
+        sr_session_stop(g_link.session);
+        g_link.session = NULL;
+    }
+    if (NULL != g_link.connection) {
+        sr_disconnect(g_link.connection);
+        g_link.connection = NULL;
+    }
+}
+
+int
+sc_link_events_subscribe_events(sr_session_ctx_t *session,
+                                sr_subscription_ctx_t **subscription)
+{
+    int rc = SR_ERR_OK;
+
+    SRP_LOG_DBG_MSG("Initializing link events.");
+
+    if (0 != sc_link_reserve(SC_LINK_IFS_HINT)) {
+        return SR_ERR_NOMEM;
+    }
+
+    /* sessions are not shared across threads, the events thread has its own */
+    rc = sr_connect(SC_LINK_APP_NAME, SR_CONN_DEFAULT, &g_link.connection);
+    if (SR_ERR_OK == rc) {
+        rc = sr_session_start(g_link.connection, SR_DS_RUNNING, SR_SESS_DEFAULT,
+                              &g_link.session);
+    }
+    if (SR_ERR_OK != rc) {
+        SRP_LOG_ERR("Unable to open the link events session: %s", sr_strerror(rc));
+        goto error;
+    }
+
+    rc = sr_subtree_change_subscribe(session, SC_LINK_EVENTS_XPATH,
+            sc_link_config_cb, NULL, 0, SR_SUBSCR_CTX_REUSE | SR_SUBSCR_EV_ENABLED, subscription);
+    if (SR_ERR_OK != rc) {
+        goto error;
+    }
+
+    g_link.stop = false;
+    if (0 != pthread_create(&g_link.thread, NULL, sc_link_thread, NULL)) {
+        rc = SR_ERR_INTERNAL;
+        goto error;
+    }
+    g_link.running = true;
+
+    SRP_LOG_INF_MSG("link events initialized successfully.");
+
+    return SR_ERR_OK;
+
+error:
+    SRP_LOG_ERR_MSG("Error by initialization of the link events.");
+    sc_link_events_cleanup();
+    return rc;
+}
+
+void
+sc_link_events_cleanup()
+{
+    pthread_mutex_lock(&g_link.lock);
+    if (g_link.running) {
+        g_link.stop = true;
+        pthread_mutex_unlock(&g_link.lock);
+
+        /* the thread waits SC_LINK_WAIT_S at most */
+        pthread_join(g_link.thread, NULL);
+
+        pthread_mutex_lock(&g_link.lock);
+        g_link.running = false;
+    }
+    pthread_mutex_unlock(&g_link.lock);
+
+    sc_link_disconnect();
+    sc_link_session_close();
+    free(g_link.ifs);
+    free(g_link.pending);
+    g_link.ifs = NULL;
+    g_link.pending = NULL;
+    g_link.n_pending = g_link.cap_ifs = 0;
+}
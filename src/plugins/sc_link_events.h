@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SC_LINK_EVENTS_H
+#define SC_LINK_EVENTS_H
+
+#include <sysrepo.h>
+
+/**
+ * @brief Turn VPP sw_interface_event messages into "link-state-change".
+ *
+ * The events of an interface are coalesced over the window configured in
+ * "/sweetcomb-telemetry:telemetry/link-events": its first event opens the
+ * window, one notification with the last state and the number of
+ * transitions closes it.
+ */
+int
+sc_link_events_subscribe_events(sr_session_ctx_t *session,
+                                sr_subscription_ctx_t **subscription);
+
+/**
+ * @brief Stop listening to the VPP events.
+ */
+void sc_link_events_cleanup();
+
+#endif /* SC_LINK_EVENTS_H */
@@ -0,0 +1,563 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "sc_notify.h"
+#include "sc_interface.h"
+#include "sc_values.h"
+#include "sc_refresh.h"
+#include "sc_reconcile.h"
+#include <sysrepo/plugins.h>
+#include <sysrepo/values.h>
+#include <vapi/interface.api.vapi.h>
+
+#define SC_NOTIFY_XPATH "/sweetcomb-telemetry:interface-state-change"
+#define SC_NOTIFY_APP_NAME "sweetcomb_notify"
+
+/* name, admin-status, oper-status, speed, mtu, phys-address */
+#define SC_NOTIFY_LEAVES 6
+
+#define SC_NOTIFY_MAC_LEN 6
+
+enum
+{
+    SC_NOTIFY_ADDED = 1 << 0,
+    SC_NOTIFY_REMOVED = 1 << 1,
+    SC_NOTIFY_ADMIN = 1 << 2,
+    SC_NOTIFY_OPER = 1 << 3,
+    SC_NOTIFY_SPEED = 1 << 4,
+    SC_NOTIFY_MTU = 1 << 5,
+    SC_NOTIFY_MAC = 1 << 6,
+};
+
+/* Notified state of one interface. */
+typedef struct
+{
+    bool present;
+    u8 admin_up;
+    u8 oper_up;
+    u8 mac[SC_NOTIFY_MAC_LEN];
+    u16 mtu;
+    u64 speed;
+    char name[VPP_INTFC_NAME_LEN];
+} sc_notify_if_t;
+
+/* Interfaces of one dump, indexed by sw_if_index. */
+typedef struct
+{
+    sc_notify_if_t *ifs;
+    u32 n_ifs;
+    u32 cap_ifs;
+} sc_notify_table_t;
+
+static struct
+{
+    pthread_mutex_t lock;       /* thread life cycle and refresh period */
+    pthread_cond_t wakeup;
+    pthread_t thread;
+    bool running;
+    bool stop;
+    u32 min_ms;
+    u32 max_ms;
+    sc_refresh_t refresh;
+    bool hinted;                /* status change announced by an event */
+
+    /* tables[current] is read by sc_notify_if_name(), only the notifier
+     * thread writes the other one and swaps them under tables_lock */
+    pthread_rwlock_t tables_lock;
+    sc_notify_table_t tables[2];
+    u32 current;                /* index of the last dump in tables */
+
+    /* only touched by the notifier thread */
+    vapi_ctx_t vapi_ctx;
+    sr_conn_ctx_t *connection;
+    sr_session_ctx_t *session;
+    bool have_previous;
+    bool lost;                  /* VPP could not be reached */
+} g_notify = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .tables_lock = PTHREAD_RWLOCK_INITIALIZER,
+    .min_ms = SC_NOTIFY_MIN_MS,
+    .max_ms = SC_NOTIFY_MAX_MS,
+};
+
+static u64
+sc_notify_now_ms()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static vapi_error_e
+sc_notify_dump_cb(struct vapi_ctx_s *ctx, void *callback_ctx, vapi_error_e rv,
+                  bool is_last, vapi_payload_sw_interface_details *reply)
+{
+    sc_notify_table_t *table = callback_ctx;
+    sc_notify_if_t *entry = NULL;
+    u32 idx, len;
+
+    if (is_last || NULL == reply) {
+        return VAPI_OK;
+    }
+
+    idx = reply->sw_if_index;
+    if (idx >= table->cap_ifs) {
+        u32 cap = table->cap_ifs ? table->cap_ifs * 2 : 16;
+
+        if (cap <= idx) {
+            cap = idx + 1;
+        }
+        entry = realloc(table->ifs, cap * sizeof(*entry));
+        if (NULL == entry) {
+            return VAPI_ENOMEM;
+        }
+        table->ifs = entry;
+        table->cap_ifs = cap;
+    }
+    if (idx >= table->n_ifs) {
+        /* indexes skipped so far are deleted interfaces */
+        memset(&table->ifs[table->n_ifs], 0,
+               (idx + 1 - table->n_ifs) * sizeof(*entry));
+        table->n_ifs = idx + 1;
+    }
+
+    entry = &table->ifs[idx];
+    entry->present = true;
+    entry->admin_up = reply->admin_up_down;
+    entry->oper_up = reply->link_up_down;
+    entry->mtu = reply->link_mtu;
+    entry->speed = sc_link_speed_to_bps(reply->link_speed);
+    len = reply->l2_address_length < SC_NOTIFY_MAC_LEN ?
+          reply->l2_address_length : SC_NOTIFY_MAC_LEN;
+    memset(entry->mac, 0, sizeof(entry->mac));
+    memcpy(entry->mac, reply->l2_address, len);
+    strncpy(entry->name, (const char *)reply->interface_name,
+            sizeof(entry->name) - 1);
+    entry->name[sizeof(entry->name) - 1] = '\0';
+
+    return VAPI_OK;
+}
+
+/**
+ * @brief Dump the interfaces into table, reusing its array.
+ */
+static int
+sc_notify_dump(sc_notify_table_t *table)
+{
+    vapi_msg_sw_interface_dump *dump = NULL;
+    vapi_error_e rv;
+
+    dump = vapi_alloc_sw_interface_dump(g_notify.vapi_ctx);
+    if (NULL == dump) {
+        return -1;
+    }
+    dump->payload.name_filter_valid = 0;
+    memset(dump->payload.name_filter, 0, sizeof(dump->payload.name_filter));
+
+    table->n_ifs = 0;
+    while (VAPI_EAGAIN == (rv = vapi_sw_interface_dump(g_notify.vapi_ctx, dump,
+                                                       sc_notify_dump_cb, table)))
+        ;
+
+    return VAPI_OK == rv ? 0 : -1;
+}
+
+static u32
+sc_notify_changes(const sc_notify_if_t *before, const sc_notify_if_t *now)
+{
+    u32 changes = 0;
+
+    if (!before->present) {
+        return now->present ? SC_NOTIFY_ADDED : 0;
+    }
+    if (!now->present) {
+        return SC_NOTIFY_REMOVED;
+    }
+
+    if (before->admin_up != now->admin_up) {
+        changes |= SC_NOTIFY_ADMIN;
+    }
+    if (before->oper_up != now->oper_up) {
+        changes |= SC_NOTIFY_OPER;
+    }
+    if (before->speed != now->speed) {
+        changes |= SC_NOTIFY_SPEED;
+    }
+    if (before->mtu != now->mtu) {
+        changes |= SC_NOTIFY_MTU;
+    }
+    if (0 != memcmp(before->mac, now->mac, sizeof(now->mac))) {
+        changes |= SC_NOTIFY_MAC;
+    }
+
+    return changes;
+}
+
+/**
+ * @brief Send the changed leaves of an interface, all of them when it was added.
+ */
+static void
+sc_notify_send(const sc_notify_if_t *entry, u32 changes)
+{
+    sr_val_t *values = NULL;
+    size_t values_cnt = 0;
+    sr_val_t *val = NULL;
+    sc_vals_t vals;
+    const u8 *mac = entry->mac;
+    int rc;
+
+    if (changes & SC_NOTIFY_ADDED) {
+        changes |= SC_NOTIFY_ADMIN | SC_NOTIFY_OPER | SC_NOTIFY_SPEED |
+                   SC_NOTIFY_MTU | SC_NOTIFY_MAC;
+    }
+
+    if (SR_ERR_OK != sc_vals_init(&vals, SC_NOTIFY_LEAVES)) {
+        return;
+    }
+    sc_vals_entry(&vals, SC_NOTIFY_XPATH);
+    sc_vals_leaf_str(&vals, "name", SR_STRING_T, entry->name);
+
+    if (changes & SC_NOTIFY_REMOVED) {
+        if (NULL != (val = sc_vals_leaf(&vals, "removed"))) {
+            val->type = SR_LEAF_EMPTY_T;
+        }
+    }
+    if (changes & SC_NOTIFY_ADMIN) {
+        sc_vals_leaf_str(&vals, "admin-status", SR_ENUM_T,
+                         entry->admin_up ? "up" : "down");
+    }
+    if (changes & SC_NOTIFY_OPER) {
+        sc_vals_leaf_str(&vals, "oper-status", SR_ENUM_T,
+                         entry->oper_up ? "up" : "down");
+    }
+    if ((changes & SC_NOTIFY_SPEED) && NULL != (val = sc_vals_leaf(&vals, "speed"))) {
+        val->type = SR_UINT64_T;
+        val->data.uint64_val = entry->speed;
+    }
+    if ((changes & SC_NOTIFY_MTU) && NULL != (val = sc_vals_leaf(&vals, "mtu"))) {
+        val->type = SR_UINT32_T;
+        val->data.uint32_val = entry->mtu;
+    }
+    if ((changes & SC_NOTIFY_MAC) && NULL != (val = sc_vals_leaf(&vals, "phys-address"))) {
+        vals.rc = sr_val_build_str_data(val, SR_STRING_T, "%02x:%02x:%02x:%02x:%02x:%02x",
+                mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    }
+
+    if (SR_ERR_OK != sc_vals_finish(&vals, &values, &values_cnt)) {
+        SRP_LOG_ERR("Unable to build the state change of '%s'.", entry->name);
+        return;
+    }
+
+    rc = sr_event_notif_send(g_notify.session, SC_NOTIFY_XPATH, values, values_cnt,
+                             SR_EV_NOTIF_DEFAULT);
+    if (SR_ERR_OK != rc) {
+        SRP_LOG_ERR("Unable to notify the state change of '%s': %s",
+                    entry->name, sr_strerror(rc));
+    }
+    sr_free_values(values, values_cnt);
+}
+
+/**
+ * @brief Notify the differences of two dumps, a single pass over the indexes.
+ * Returns all the changes found.
+ */
+static u32
+sc_notify_diff(const sc_notify_table_t *before, const sc_notify_table_t *now)
+{
+    static const sc_notify_if_t absent = { 0, };
+    u32 n = now->n_ifs > before->n_ifs ? now->n_ifs : before->n_ifs;
+    u32 i, changes, all = 0;
+
+    for (i = 0; i < n; i++) {
+        const sc_notify_if_t *b = i < before->n_ifs ? &before->ifs[i] : &absent;
+        const sc_notify_if_t *c = i < now->n_ifs ? &now->ifs[i] : &absent;
+
+        if (b->present && c->present && 0 != strcmp(b->name, c->name)) {
+            /* index reused by an interface created in the meantime */
+            sc_notify_send(b, SC_NOTIFY_REMOVED);
+            sc_notify_send(c, SC_NOTIFY_ADDED);
+            all |= SC_NOTIFY_REMOVED | SC_NOTIFY_ADDED;
+            continue;
+        }
+
+        changes = sc_notify_changes(b, c);
+        if (0 != changes) {
+            sc_notify_send(changes & SC_NOTIFY_REMOVED ? b : c, changes);
+            all |= changes;
+        }
+    }
+
+    return all;
+}
+
+/* Dump once and notify the changes, notifier thread only. -1 on failure. */
+static int
+sc_notify_poll(u32 *changes)
+{
+    sc_notify_table_t *now = &g_notify.tables[g_notify.current ^ 1];
+    const sc_notify_table_t *before = &g_notify.tables[g_notify.current];
+
+    *changes = 0;
+    if (NULL == g_notify.vapi_ctx) {
+        if (0 != sc_connect_vpp_private(SC_NOTIFY_APP_NAME, &g_notify.vapi_ctx)) {
+            g_notify.lost = true;
+            return -1;
+        }
+        if (g_notify.lost) {
+            /* a restarted VPP lost the configuration */
+            sc_reconcile_request();
+            g_notify.lost = false;
+        }
+    }
+
+    if (0 != sc_notify_dump(now)) {
+        /* VPP went away, reconnect on the next poll and diff against the
+         * last good dump: what a restart changed is notified too */
+        sc_disconnect_vpp_private(g_notify.vapi_ctx);
+        g_notify.vapi_ctx = NULL;
+        g_notify.lost = true;
+        return -1;
+    }
+    pthread_rwlock_wrlock(&g_notify.tables_lock);
+    g_notify.current ^= 1;
+    pthread_rwlock_unlock(&g_notify.tables_lock);
+
+    /* the first dump is only the reference */
+    if (g_notify.have_previous) {
+        *changes = sc_notify_diff(before, now);
+    }
+    g_notify.have_previous = true;
+
+    return 0;
+}
+
+/* Fold the outcome of a dump into the refresh period, called with lock held. */
+static void
+sc_notify_refreshed(int rc, u32 changes, bool hinted)
+{
+    u64 now = sc_notify_now_ms();
+    sc_refresh_t *r = &g_notify.refresh;
+
+    if (0 != rc) {
+        /* retried at the shortest period until VPP answers */
+        r->next_ms = now + r->min_ms;
+        return;
+    }
+
+    /* a status change an event announced says nothing about how often
+     * the interfaces must be polled */
+    if (hinted) {
+        changes &= ~(SC_NOTIFY_ADMIN | SC_NOTIFY_OPER);
+    }
+    sc_refresh_done(r, now, 0 != changes);
+}
+
+static void *
+sc_notify_thread(void *arg)
+{
+    struct timespec deadline;
+    u64 next;
+    u32 changes;
+    bool hinted;
+    int rc;
+
+    pthread_mutex_lock(&g_notify.lock);
+    while (!g_notify.stop) {
+        if (!sc_refresh_due(&g_notify.refresh, sc_notify_now_ms())) {
+            next = g_notify.refresh.next_ms;
+            deadline.tv_sec = next / 1000;
+            deadline.tv_nsec = (next % 1000) * 1000000L;
+            pthread_cond_timedwait(&g_notify.wakeup, &g_notify.lock, &deadline);
+            continue;
+        }
+        hinted = g_notify.hinted;
+        g_notify.hinted = false;
+        pthread_mutex_unlock(&g_notify.lock);
+
+        rc = sc_notify_poll(&changes);
+
+        pthread_mutex_lock(&g_notify.lock);
+        sc_notify_refreshed(rc, changes, hinted);
+    }
+    pthread_mutex_unlock(&g_notify.lock);
+
+    return NULL;
+}
+
+int
+sc_notify_start()
+{
+    pthread_condattr_t attr;
+    int rc = SR_ERR_OK;
+
+    pthread_mutex_lock(&g_notify.lock);
+    if (g_notify.running) {
+        goto out;
+    }
+
+    /* sessions are not shared across threads, the notifier has its own */
+    rc = sr_connect(SC_NOTIFY_APP_NAME, SR_CONN_DEFAULT, &g_notify.connection);
+    if (SR_ERR_OK == rc) {
+        rc = sr_session_start(g_notify.connection, SR_DS_RUNNING, SR_SESS_DEFAULT,
+                              &g_notify.session);
+    }
+    if (SR_ERR_OK != rc) {
+        SRP_LOG_ERR("Unable to open the notification session: %s", sr_strerror(rc));
+        goto error;
+    }
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&g_notify.wakeup, &attr);
+    pthread_condattr_destroy(&attr);
+
+    sc_refresh_init(&g_notify.refresh, g_notify.min_ms, g_notify.max_ms,
+                    sc_notify_now_ms());
+    g_notify.hinted = false;
+    g_notify.stop = false;
+    g_notify.have_previous = false;
+    g_notify.lost = false;
+    if (0 != pthread_create(&g_notify.thread, NULL, sc_notify_thread, NULL)) {
+        SRP_LOG_ERR_MSG("Unable to start the interface state notifier.");
+        pthread_cond_destroy(&g_notify.wakeup);
+        rc = SR_ERR_INTERNAL;
+        goto error;
+    }
+    g_notify.running = true;
+    goto out;
+
+error:
+    if (NULL != g_notify.session) {
+        sr_session_stop(g_notify.session);
+        g_notify.session = NULL;
+    }
+    if (NULL != g_notify.connection) {
+        sr_disconnect(g_notify.connection);
+        g_notify.connection = NULL;
+    }
+out:
+    pthread_mutex_unlock(&g_notify.lock);
+    return rc;
+}
+
+void
+sc_notify_stop()
+{
+    u32 i;
+
+    pthread_mutex_lock(&g_notify.lock);
+    if (!g_notify.running) {
+        pthread_mutex_unlock(&g_notify.lock);
+        return;
+    }
+    g_notify.stop = true;
+    pthread_cond_signal(&g_notify.wakeup);
+    pthread_mutex_unlock(&g_notify.lock);
+
+    pthread_join(g_notify.thread, NULL);
+
+    pthread_mutex_lock(&g_notify.lock);
+    g_notify.running = false;
+    pthread_cond_destroy(&g_notify.wakeup);
+    sc_disconnect_vpp_private(g_notify.vapi_ctx);
+    g_notify.vapi_ctx = NULL;
+    sr_session_stop(g_notify.session);
+    g_notify.session = NULL;
+    sr_disconnect(g_notify.connection);
+    g_notify.connection = NULL;
+    pthread_rwlock_wrlock(&g_notify.tables_lock);
+    for (i = 0; i < 2; i++) {
+        free(g_notify.tables[i].ifs);
+        memset(&g_notify.tables[i], 0, sizeof(g_notify.tables[i]));
+    }
+    pthread_rwlock_unlock(&g_notify.tables_lock);
+    pthread_mutex_unlock(&g_notify.lock);
+}
+
+int
+sc_notify_if_name(u32 sw_if_index, char name[VPP_INTFC_NAME_LEN])
+{
+    const sc_notify_table_t *table = NULL;
+    int rc = -1;
+
+    pthread_rwlock_rdlock(&g_notify.tables_lock);
+    table = &g_notify.tables[g_notify.current];
+    if (sw_if_index < table->n_ifs && table->ifs[sw_if_index].present) {
+        memcpy(name, table->ifs[sw_if_index].name, VPP_INTFC_NAME_LEN);
+        rc = 0;
+    }
+    pthread_rwlock_unlock(&g_notify.tables_lock);
+
+    return rc;
+}
+
+int
+sc_notify_if_status(u32 sw_if_index, u8 *admin_up, u8 *oper_up)
+{
+    const sc_notify_table_t *table = NULL;
+    int rc = -1;
+
+    pthread_rwlock_rdlock(&g_notify.tables_lock);
+    table = &g_notify.tables[g_notify.current];
+    if (sw_if_index < table->n_ifs && table->ifs[sw_if_index].present) {
+        *admin_up = table->ifs[sw_if_index].admin_up;
+        *oper_up = table->ifs[sw_if_index].oper_up;
+        rc = 0;
+    }
+    pthread_rwlock_unlock(&g_notify.tables_lock);
+
+    return rc;
+}
+
+void
+sc_notify_configure(u32 min_ms, u32 max_ms)
+{
+    pthread_mutex_lock(&g_notify.lock);
+    g_notify.min_ms = min_ms;
+    g_notify.max_ms = max_ms;
+    if (g_notify.running) {
+        sc_refresh_bounds(&g_notify.refresh, min_ms, max_ms);
+        pthread_cond_signal(&g_notify.wakeup);
+    }
+    pthread_mutex_unlock(&g_notify.lock);
+}
+
+void
+sc_notify_hint()
+{
+    pthread_mutex_lock(&g_notify.lock);
+    if (g_notify.running) {
+        sc_refresh_soon(&g_notify.refresh, sc_notify_now_ms());
+        g_notify.hinted = true;
+        pthread_cond_signal(&g_notify.wakeup);
+    }
+    pthread_mutex_unlock(&g_notify.lock);
+}
+
+void
+sc_notify_refresh(sc_refresh_t *refresh)
+{
+    pthread_mutex_lock(&g_notify.lock);
+    *refresh = g_notify.refresh;
+    pthread_mutex_unlock(&g_notify.lock);
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SC_NOTIFY_H
+#define SC_NOTIFY_H
+
+#include "sc_vpp_operation.h"
+#include "sc_refresh.h"
+
+/**
+ * @brief Start sending "/sweetcomb-telemetry:interface-state-change".
+ *
+ * A thread dumps the interfaces on a VPP connection of its own, diffs the
+ * dump against the previous one and notifies the leaves that changed, so
+ * clients subscribe instead of polling interfaces-state.
+ *
+ * The dumps are paced by a refresh period adapting to how often the
+ * interfaces change, see sc_refresh.h. One sw_interface_dump carries the
+ * status, the properties and the membership alike, so they share that
+ * period: the dump is the cost, not the fields read from it.
+ */
+int sc_notify_start();
+
+/**
+ * @brief Stop the thread started by sc_notify_start().
+ */
+void sc_notify_stop();
+
+#define SC_NOTIFY_MIN_MS 1000
+#define SC_NOTIFY_MAX_MS 30000
+
+/**
+ * @brief Bounds of the refresh period, SC_NOTIFY_MIN_MS and SC_NOTIFY_MAX_MS by default.
+ */
+void sc_notify_configure(u32 min_ms, u32 max_ms);
+
+/**
+ * @brief The status of an interface changed, refresh it soon.
+ *
+ * Called on VPP interface events, which are then enough for the status to
+ * be polled at the longest period.
+ */
+void sc_notify_hint();
+
+/**
+ * @brief Current refresh period of the dumps.
+ */
+void sc_notify_refresh(sc_refresh_t *refresh);
+
+/**
+ * @brief Name of an interface in the last dump of the notifier, -1 if unknown.
+ *
+ * Lets background threads name interfaces without a VPP request of their own.
+ */
+int sc_notify_if_name(u32 sw_if_index, char name[VPP_INTFC_NAME_LEN]);
+
+/**
+ * @brief Admin and oper status of an interface in the last dump of the
+ * notifier, -1 if unknown.
+ */
+int sc_notify_if_status(u32 sw_if_index, u8 *admin_up, u8 *oper_up);
+
+#endif /* SC_NOTIFY_H */
@@ -38,6 +38,12 @@ DEFINE_VAPI_MSG_IDS_HC_API_JSON;
 #include "sc_plugins.h"
 //#include "sc_ip.h"
 #include "sc_interface.h"
+#include "sc_link_events.h"
+#include "sc_notify.h"
+#include "sc_push.h"
+#include "sc_reconcile.h"
+#include "sc_telemetry.h"
+#include "sc_vpp_stats.h"
 //#include "sc_l2.h"
 //#include "sc_vxlan.h"
 
@@ -61,6 +67,22 @@ int sr_plugin_init_cb(sr_session_ctx_t *session, void **private_ctx)
   //INTERFACE
   sc_interface_subscribe_events(session, &subscription);
 
+  //RECONCILE, applies the startup configuration, after the interface
+  //subscriptions so that no change is missed in between
+  sc_reconcile_subscribe_events(session, &subscription);
+
+  //TELEMETRY
+  sc_telemetry_subscribe_events(session, &subscription);
+
+  //NOTIFICATIONS
+  sc_notify_start();
+
+  //PUSH
+  sc_push_subscribe_events(session, &subscription);
+
+  //LINK EVENTS
+  sc_link_events_subscribe_events(session, &subscription);
+
   /* set subscription as our private context */
   *private_ctx = subscription;
   SC_INVOKE_END;
@@ -73,6 +95,13 @@ void sr_plugin_cleanup_cb(sr_session_ctx_t *session, void *private_ctx)
   /* subscription was set as our private context */
   sr_unsubscribe(session, private_ctx);
   SC_LOG_DBG_MSG("unload plugin ok.");
+  sc_reconcile_cleanup();
+  sc_link_events_cleanup();
+  sc_push_cleanup();
+  sc_notify_stop();
+  sc_telemetry_cleanup();
+  sc_interface_cleanup();
+  sc_stats_disconnect();
   sc_disconnect_vpp();
   SC_LOG_DBG_MSG("plugin disconnect vpp ok.");
   SC_INVOKE_END;
@@ -159,6 +188,13 @@ main(int argc, char **argv)
   if (NULL != connection) {
     sr_disconnect(connection);
   }
+  sc_reconcile_cleanup();
+  sc_link_events_cleanup();
+  sc_push_cleanup();
+  sc_notify_stop();
+  sc_telemetry_cleanup();
+  sc_interface_cleanup();
+  sc_stats_disconnect();
   sc_disconnect_vpp();
   return rc;
 }
@@ -0,0 +1,561 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "sc_push.h"
+#include "sc_interface.h"
+#include "sc_notify.h"
+#include "sc_values.h"
+#include "sc_vpp_history.h"
+#include <sysrepo/plugins.h>
+#include <sysrepo/values.h>
+#include <sysrepo/xpath.h>
+
+#define SC_PUSH_XPATH "/sweetcomb-telemetry:telemetry/push"
+#define SC_PUSH_UPDATE_XPATH "/sweetcomb-telemetry:push-update"
+#define SC_PUSH_APP_NAME "sweetcomb_push"
+
+/* name and counters of an interface entry of push-update */
+#define SC_PUSH_INTERFACE_LEAVES 7
+
+typedef struct
+{
+    u32 id;
+    u32 period_ms;
+    u64 next_ms;                /* CLOCK_MONOTONIC time of the next push */
+    char (*interfaces)[VPP_INTFC_NAME_LEN];     /* pushed, all if none */
+    u32 n_interfaces;
+} sc_push_sub_t;
+
+typedef struct
+{
+    sc_push_sub_t *subs;
+    u32 n_subs;
+} sc_push_set_t;
+
+static struct
+{
+    pthread_mutex_t lock;       /* everything up to the thread-only part */
+    pthread_cond_t wakeup;
+    pthread_t thread;
+    bool running;
+    bool stop;
+
+    sc_push_set_t config;       /* handed over to the push thread */
+    bool reconfigured;
+    bool active;                /* any subscription, samples are kept */
+    sc_if_stats_t pending;      /* last read of the sampler */
+    bool has_pending;
+
+    /* only touched by the push thread */
+    sc_push_set_t set;
+    sc_if_stats_t sample;
+    u64 last_ms;
+    sr_conn_ctx_t *connection;
+    sr_session_ctx_t *session;
+} g_push = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static void
+sc_push_set_free(sc_push_set_t *set)
+{
+    u32 i;
+
+    for (i = 0; i < set->n_subs; i++) {
+        free(set->subs[i].interfaces);
+    }
+    free(set->subs);
+    set->subs = NULL;
+    set->n_subs = 0;
+}
+
+static sc_push_sub_t *
+sc_push_set_find(sc_push_set_t *set, u32 id)
+{
+    u32 i;
+
+    for (i = 0; i < set->n_subs; i++) {
+        if (set->subs[i].id == id) {
+            return &set->subs[i];
+        }
+    }
+
+    return NULL;
+}
+
+static int
+sc_push_xpath_id(const char *xpath, u32 *id)
+{
+    sr_xpath_ctx_t xpath_ctx = { 0, };
+    char *key = NULL;
+
+    key = sr_xpath_key_value((char *)xpath, "subscription", "id", &xpath_ctx);
+    if (NULL != key) {
+        *id = strtoul(key, NULL, 10);
+    }
+    sr_xpath_recover(&xpath_ctx);
+
+    return NULL != key ? 0 : -1;
+}
+
+/**
+ * @brief Read the subscriptions of the running datastore into set.
+ */
+static int
+sc_push_set_read(sr_session_ctx_t *session, sc_push_set_t *set)
+{
+    sr_val_t *values = NULL;
+    size_t values_cnt = 0, i;
+    sc_push_sub_t *sub = NULL;
+    u32 id;
+    int rc;
+
+    rc = sr_get_items(session, SC_PUSH_XPATH "/subscription/period", &values, &values_cnt);
+    if (SR_ERR_NOT_FOUND == rc) {
+        return SR_ERR_OK;
+    }
+    if (SR_ERR_OK != rc) {
+        return rc;
+    }
+
+    set->subs = calloc(values_cnt, sizeof(*set->subs));
+    if (NULL == set->subs) {
+        sr_free_values(values, values_cnt);
+        return SR_ERR_NOMEM;
+    }
+    for (i = 0; i < values_cnt; i++) {
+        if (SR_UINT32_T != values[i].type ||
+            0 != sc_push_xpath_id(values[i].xpath, &id)) {
+            continue;
+        }
+        sub = &set->subs[set->n_subs++];
+        sub->id = id;
+        sub->period_ms = values[i].data.uint32_val;
+    }
+    sr_free_values(values, values_cnt);
+
+    rc = sr_get_items(session, SC_PUSH_XPATH "/subscription/interface", &values, &values_cnt);
+    if (SR_ERR_NOT_FOUND == rc) {
+        return SR_ERR_OK;
+    }
+    if (SR_ERR_OK != rc) {
+        return rc;
+    }
+
+    for (i = 0; i < values_cnt && SR_ERR_OK == rc; i++) {
+        char (*interfaces)[VPP_INTFC_NAME_LEN] = NULL;
+
+        if (SR_STRING_T != values[i].type ||
+            0 != sc_push_xpath_id(values[i].xpath, &id) ||
+            NULL == (sub = sc_push_set_find(set, id))) {
+            continue;
+        }
+        interfaces = realloc(sub->interfaces, (sub->n_interfaces + 1) * sizeof(*interfaces));
+        if (NULL == interfaces) {
+            rc = SR_ERR_NOMEM;
+            break;
+        }
+        sub->interfaces = interfaces;
+        strncpy(interfaces[sub->n_interfaces], values[i].data.string_val,
+                VPP_INTFC_NAME_LEN - 1);
+        interfaces[sub->n_interfaces][VPP_INTFC_NAME_LEN - 1] = '\0';
+        sub->n_interfaces++;
+    }
+    sr_free_values(values, values_cnt);
+
+    return rc;
+}
+
+/**
+ * @brief Callback for "/sweetcomb-telemetry:telemetry/push", hands the
+ * subscriptions over to the push thread.
+ */
+static int
+sc_push_config_cb(sr_session_ctx_t *session, const char *xpath,
+                  sr_notif_event_t event, void *private_ctx)
+{
+    sc_push_set_t set = { 0, };
+    int rc;
+
+    if (SR_EV_APPLY != event && SR_EV_ENABLED != event) {
+        return SR_ERR_OK;
+    }
+    SRP_LOG_DBG("'%s' modified, event=%d", xpath, event);
+
+    rc = sc_push_set_read(session, &set);
+    if (SR_ERR_OK != rc) {
+        SRP_LOG_ERR("Unable to read the push subscriptions: %s", sr_strerror(rc));
+        sc_push_set_free(&set);
+        return rc;
+    }
+
+    pthread_mutex_lock(&g_push.lock);
+    sc_push_set_free(&g_push.config);
+    g_push.config = set;
+    g_push.reconfigured = true;
+    g_push.active = 0 != set.n_subs;
+    pthread_cond_signal(&g_push.wakeup);
+    pthread_mutex_unlock(&g_push.lock);
+
+    return SR_ERR_OK;
+}
+
+/* sampler thread, keeps the read for the push thread */
+static void
+sc_push_sample(const sc_if_stats_t *sample, void *ctx)
+{
+    sc_if_stats_t *pending = &g_push.pending;
+
+    pthread_mutex_lock(&g_push.lock);
+    if (!g_push.active) {
+        goto out;
+    }
+
+    if (sample->n_ifs > pending->cap_ifs) {
+        sc_if_counters_t *counters = realloc(pending->counters,
+                                             sample->n_ifs * sizeof(*counters));
+        if (NULL == counters) {
+            goto out;
+        }
+        pending->counters = counters;
+        pending->cap_ifs = sample->n_ifs;
+    }
+    memcpy(pending->counters, sample->counters, sample->n_ifs * sizeof(*sample->counters));
+    pending->n_ifs = sample->n_ifs;
+    pending->timestamp_ns = sample->timestamp_ns;
+    g_push.has_pending = true;
+    pthread_cond_signal(&g_push.wakeup);
+
+out:
+    pthread_mutex_unlock(&g_push.lock);
+}
+
+/* Keep the deadlines of the subscriptions whose period did not change. */
+static void
+sc_push_adopt(sc_push_set_t *set)
+{
+    sc_push_sub_t *old = NULL;
+    u32 i;
+
+    for (i = 0; i < set->n_subs; i++) {
+        old = sc_push_set_find(&g_push.set, set->subs[i].id);
+        if (NULL != old && old->period_ms == set->subs[i].period_ms) {
+            set->subs[i].next_ms = old->next_ms;
+        }
+    }
+    sc_push_set_free(&g_push.set);
+    g_push.set = *set;
+}
+
+static bool
+sc_push_wants(const sc_push_sub_t *sub, const char *name)
+{
+    u32 i;
+
+    if (0 == sub->n_interfaces) {
+        return true;
+    }
+    for (i = 0; i < sub->n_interfaces; i++) {
+        if (0 == strcmp(sub->interfaces[i], name)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void
+sc_push_counter_leaf(sc_vals_t *vals, const char *leaf, u64 value)
+{
+    sr_val_t *val = sc_vals_leaf(vals, leaf);
+
+    if (NULL != val) {
+        val->type = SR_UINT64_T;
+        val->data.uint64_val = value;
+    }
+}
+
+/**
+ * @brief Name of an interface of the sample, -1 if unknown.
+ *
+ * Names come from the last dump of the interface state notifier. An
+ * interface created since then is looked up in the interface snapshot,
+ * acquired at most once per push-update, and the notifier is hinted to
+ * refresh its dump.
+ */
+static int
+sc_push_if_name(u32 sw_if_index, char name[VPP_INTFC_NAME_LEN],
+                sc_snapshot_ref_t **ref, const sc_sw_interface_dump_ctx **snapshot,
+                bool *acquired)
+{
+    const scVppIntfc *intfc = NULL;
+
+    if (0 == sc_notify_if_name(sw_if_index, name)) {
+        return 0;
+    }
+
+    if (!*acquired) {
+        *snapshot = sc_interface_snapshot_acquire(ref);
+        *acquired = true;
+    }
+    if (NULL == (intfc = sc_interface_snapshot_find_index(*snapshot, sw_if_index))) {
+        return -1;
+    }
+    sc_notify_hint();
+
+    memcpy(name, intfc->interface_name, VPP_INTFC_NAME_LEN);
+    name[VPP_INTFC_NAME_LEN - 1] = '\0';
+    return 0;
+}
+
+/**
+ * @brief Send the push-update of a subscription from the current sample.
+ */
+static void
+sc_push_send(const sc_push_sub_t *sub)
+{
+    const sc_if_stats_t *sample = &g_push.sample;
+    char name[VPP_INTFC_NAME_LEN];
+    sc_snapshot_ref_t *ref = NULL;
+    const sc_sw_interface_dump_ctx *snapshot = NULL;
+    bool acquired = false;
+    sr_val_t *values = NULL;
+    size_t values_cnt = 0;
+    sr_val_t *val = NULL;
+    sc_if_sample_t s;
+    sc_vals_t vals;
+    u32 i, n;
+    int rc;
+
+    n = 0 != sub->n_interfaces ? sub->n_interfaces : sample->n_ifs;
+    if (SR_ERR_OK != sc_vals_init(&vals, 1 + n * SC_PUSH_INTERFACE_LEAVES)) {
+        return;
+    }
+
+    if (NULL != (val = sc_vals_add(&vals, SC_PUSH_UPDATE_XPATH "/subscription-id"))) {
+        val->type = SR_UINT32_T;
+        val->data.uint32_val = sub->id;
+    }
+
+    for (i = 0; i < sample->n_ifs && SR_ERR_OK == vals.rc; i++) {
+        if (0 != sc_push_if_name(i, name, &ref, &snapshot, &acquired) ||
+            !sc_push_wants(sub, name)) {
+            continue;
+        }
+        sc_if_sample_fold(&sample->counters[i], &s);
+
+        if (SR_ERR_OK != sc_vals_entry(&vals, SC_PUSH_UPDATE_XPATH "/interface[name='%s']",
+                                       name)) {
+            break;
+        }
+        sc_vals_leaf_str(&vals, "name", SR_STRING_T, name);
+        sc_push_counter_leaf(&vals, "in-octets", s.rx_bytes);
+        sc_push_counter_leaf(&vals, "in-pkts", s.rx_packets);
+        sc_push_counter_leaf(&vals, "out-octets", s.tx_bytes);
+        sc_push_counter_leaf(&vals, "out-pkts", s.tx_packets);
+        sc_push_counter_leaf(&vals, "discards", s.drops);
+        sc_push_counter_leaf(&vals, "errors", s.errors);
+    }
+    sc_interface_snapshot_release(ref);
+
+    if (SR_ERR_OK != sc_vals_finish(&vals, &values, &values_cnt)) {
+        SRP_LOG_ERR("Unable to build the push-update of subscription %u.", sub->id);
+        return;
+    }
+
+    rc = sr_event_notif_send(g_push.session, SC_PUSH_UPDATE_XPATH, values, values_cnt,
+                             SR_EV_NOTIF_DEFAULT);
+    if (SR_ERR_OK != rc) {
+        SRP_LOG_ERR("Unable to send the push-update of subscription %u: %s",
+                    sub->id, sr_strerror(rc));
+    }
+    sr_free_values(values, values_cnt);
+}
+
+/* Push to the subscriptions due at the current sample, push thread only. */
+static void
+sc_push_fanout()
+{
+    u64 now_ms = g_push.sample.timestamp_ns / 1000000;
+    u64 slack = 0;
+    sc_push_sub_t *sub = NULL;
+    u32 i;
+
+    /* reads come at the sampler interval, give or take some jitter: a
+     * push is due at the read closest to its deadline */
+    if (0 != g_push.last_ms && now_ms > g_push.last_ms) {
+        slack = (now_ms - g_push.last_ms) / 2;
+    }
+    g_push.last_ms = now_ms;
+
+    for (i = 0; i < g_push.set.n_subs; i++) {
+        sub = &g_push.set.subs[i];
+        if (now_ms + slack < sub->next_ms) {
+            continue;
+        }
+
+        sc_push_send(sub);
+
+        sub->next_ms += sub->period_ms;
+        if (sub->next_ms <= now_ms) {
+            /* first push, or periods missed */
+            sub->next_ms = now_ms + sub->period_ms;
+        }
+    }
+}
+
+static void *
+sc_push_thread(void *arg)
+{
+    sc_push_set_t set;
+    sc_if_stats_t tmp;
+    bool adopt, fanout;
+
+    pthread_mutex_lock(&g_push.lock);
+    while (!g_push.stop) {
+        if (!g_push.reconfigured && !g_push.has_pending) {
+            pthread_cond_wait(&g_push.wakeup, &g_push.lock);
+            continue;
+        }
+
+        adopt = g_push.reconfigured;
+        if (adopt) {
+            set = g_push.config;
+            memset(&g_push.config, 0, sizeof(g_push.config));
+            g_push.reconfigured = false;
+        }
+        fanout = g_push.has_pending;
+        if (fanout) {
+            tmp = g_push.sample;
+            g_push.sample = g_push.pending;
+            g_push.pending = tmp;
+            g_push.has_pending = false;
+        }
+        pthread_mutex_unlock(&g_push.lock);
+
+        if (adopt) {
+            sc_push_adopt(&set);
+        }
+        if (fanout) {
+            sc_push_fanout();
+        }
+
+        pthread_mutex_lock(&g_push.lock);
+    }
+    pthread_mutex_unlock(&g_push.lock);
+
+    return NULL;
+}
+
+static void
+sc_push_session_close()
+{
+    if (NULL != g_push.session) {
+        sr_session_stop(g_push.session);
+        g_push.session = NULL;
+    }
+    if (NULL != g_push.connection) {
+        sr_disconnect(g_push.connection);
+        g_push.connection = NULL;
+    }
+}
+
+int
+sc_push_subscribe_events(sr_session_ctx_t *session,
+                         sr_subscription_ctx_t **subscription)
+{
+    int rc = SR_ERR_OK;
+
+    SRP_LOG_DBG_MSG("Initializing push subscriptions.");
+
+    /* sessions are not shared across threads, the push thread has its own */
+    rc = sr_connect(SC_PUSH_APP_NAME, SR_CONN_DEFAULT, &g_push.connection);
+    if (SR_ERR_OK == rc) {
+        rc = sr_session_start(g_push.connection, SR_DS_RUNNING, SR_SESS_DEFAULT,
+                              &g_push.session);
+    }
+    if (SR_ERR_OK != rc) {
+        SRP_LOG_ERR("Unable to open the push session: %s", sr_strerror(rc));
+        sc_push_session_close();
+        return rc;
+    }
+
+    pthread_cond_init(&g_push.wakeup, NULL);
+    g_push.stop = false;
+    if (0 != pthread_create(&g_push.thread, NULL, sc_push_thread, NULL)) {
+        SRP_LOG_ERR_MSG("Unable to start the push thread.");
+        pthread_cond_destroy(&g_push.wakeup);
+        sc_push_session_close();
+        return SR_ERR_INTERNAL;
+    }
+    g_push.running = true;
+
+    if (0 != sc_rates_listen(sc_push_sample, NULL)) {
+        rc = SR_ERR_INTERNAL;
+        goto error;
+    }
+
+    rc = sr_subtree_change_subscribe(session, SC_PUSH_XPATH,
+            sc_push_config_cb, NULL, 0, SR_SUBSCR_CTX_REUSE | SR_SUBSCR_EV_ENABLED, subscription);
+    if (SR_ERR_OK != rc) {
+        goto error;
+    }
+
+    SRP_LOG_INF_MSG("push subscriptions initialized successfully.");
+
+    return SR_ERR_OK;
+
+error:
+    SRP_LOG_ERR_MSG("Error by initialization of the push subscriptions.");
+    sc_push_cleanup();
+    return rc;
+}
+
+void
+sc_push_cleanup()
+{
+    /* no sample is handed over once unlisten returned */
+    sc_rates_unlisten(sc_push_sample, NULL);
+
+    pthread_mutex_lock(&g_push.lock);
+    if (!g_push.running) {
+        pthread_mutex_unlock(&g_push.lock);
+        return;
+    }
+    g_push.stop = true;
+    pthread_cond_signal(&g_push.wakeup);
+    pthread_mutex_unlock(&g_push.lock);
+
+    pthread_join(g_push.thread, NULL);
+
+    pthread_mutex_lock(&g_push.lock);
+    g_push.running = false;
+    g_push.active = false;
+    g_push.has_pending = false;
+    g_push.reconfigured = false;
+    g_push.last_ms = 0;
+    pthread_cond_destroy(&g_push.wakeup);
+    sc_push_set_free(&g_push.config);
+    sc_push_set_free(&g_push.set);
+    sc_if_stats_free(&g_push.pending);
+    sc_if_stats_free(&g_push.sample);
+    sc_push_session_close();
+    pthread_mutex_unlock(&g_push.lock);
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SC_PUSH_H
+#define SC_PUSH_H
+
+#include <sysrepo.h>
+
+/**
+ * @brief Serve "/sweetcomb-telemetry:telemetry/push" subscriptions.
+ *
+ * Each configured subscription gets a "push-update" notification with the
+ * counters of its interfaces every period. All of them are built from the
+ * reads of the rates sampler, so any number of subscribers cost no VPP
+ * request of their own.
+ */
+int
+sc_push_subscribe_events(sr_session_ctx_t *session,
+                         sr_subscription_ctx_t **subscription);
+
+/**
+ * @brief Stop pushing, before the rates sampler is stopped.
+ */
+void sc_push_cleanup();
+
+#endif /* SC_PUSH_H */
@@ -0,0 +1,692 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+#include <arpa/inet.h>
+
+#include "sc_reconcile.h"
+#include "sc_interface.h"
+#include "sc_values.h"
+#include <sysrepo/plugins.h>
+#include <sysrepo/values.h>
+#include <sysrepo/xpath.h>
+
+#define SC_RECONCILE_CONFIG_XPATH "/ietf-interfaces:interfaces/interface//*"
+#define SC_RECONCILE_IF_XPATH "/ietf-interfaces:interfaces/interface[name='%s']"
+#define SC_RECONCILE_RPC "/sweetcomb-telemetry:reconcile"
+#define SC_RECONCILE_APP_NAME "sweetcomb_reconcile"
+
+/* interfaces the desired configuration is sized for, it grows past them */
+#define SC_RECONCILE_IFS_HINT 16
+/* longest xpath reported for a request */
+#define SC_RECONCILE_XPATH_LEN 256
+/* number of leaves of the RPC output */
+#define SC_RECONCILE_OUTPUT_LEAVES 4
+/* delay before a failed run is tried again */
+#define SC_RECONCILE_RETRY_MS 5000
+/* diffs a run makes while change sets keep being committed */
+#define SC_RECONCILE_ATTEMPTS 3
+
+/* Configuration of one interface. */
+typedef struct
+{
+    char name[VPP_INTFC_NAME_LEN];
+    bool enabled;
+    sc_if_addrs_t addrs;        /* arrays indexed by is_ipv6 */
+} sc_reconcile_if_t;
+
+static const char *sc_reconcile_if_name(const void *ctx, unsigned int entry);
+
+static struct
+{
+    pthread_mutex_t lock;       /* thread life cycle and runs */
+    pthread_cond_t wakeup;      /* for the thread, a run was requested */
+    pthread_cond_t done;        /* for the waiters, a run completed */
+    pthread_t thread;
+    bool running;
+    bool stop;
+    u64 requested;              /* tickets given so far */
+    u64 completed;              /* tickets served so far */
+    u64 retry_ms;               /* time of the retry of a failed run, 0 if none */
+    int last_rc;
+    sc_reconcile_stats_t last;
+
+    /* only touched by the reconcile thread */
+    vapi_ctx_t vapi_ctx;
+    sr_conn_ctx_t *connection;
+    sr_session_ctx_t *session;
+    sc_reconcile_if_t *ifs;
+    u32 n_ifs;
+    u32 cap_ifs;
+    sc_name_index_t if_names;   /* ifs by name */
+    sc_if_addrs_t actual;
+    sc_interface_txn_t txn;
+} g_reconcile = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+    .if_names = SC_NAME_INDEX_INIT(sc_reconcile_if_name, NULL),
+};
+
+static u64
+sc_reconcile_now_ms()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int
+sc_reconcile_addr_push(sc_if_addrs_t *addrs, u8 af, const u8 *address, u8 prefix_length)
+{
+    sc_ip_addr_t *array = NULL;
+    u32 cap;
+
+    if (addrs->n_addrs[af] == addrs->cap_addrs[af]) {
+        cap = addrs->cap_addrs[af] ? addrs->cap_addrs[af] * 2 : 4;
+        array = realloc(addrs->addrs[af], cap * sizeof(*array));
+        if (NULL == array) {
+            return -1;
+        }
+        addrs->addrs[af] = array;
+        addrs->cap_addrs[af] = cap;
+    }
+
+    memset(&addrs->addrs[af][addrs->n_addrs[af]], 0, sizeof(sc_ip_addr_t));
+    memcpy(addrs->addrs[af][addrs->n_addrs[af]].address, address,
+           af ? VPP_IP6_ADDRESS_LEN : VPP_IP4_ADDRESS_LEN);
+    addrs->addrs[af][addrs->n_addrs[af]].prefix_length = prefix_length;
+    addrs->n_addrs[af]++;
+
+    return 0;
+}
+
+static const char *
+sc_reconcile_if_name(const void *ctx, unsigned int entry)
+{
+    return g_reconcile.ifs[entry].name;
+}
+
+/**
+ * @brief Entry of the interface name, the last one when the values of an
+ * interface follow each other as they do. NULL when out of memory.
+ */
+static sc_reconcile_if_t *
+sc_reconcile_if(const char *name)
+{
+    sc_reconcile_if_t *ifs = NULL, *e = NULL;
+    u32 cap;
+    int i;
+
+    if (0 != g_reconcile.n_ifs &&
+        0 == strcmp(g_reconcile.ifs[g_reconcile.n_ifs - 1].name, name)) {
+        return &g_reconcile.ifs[g_reconcile.n_ifs - 1];
+    }
+    i = sc_name_index_find(&g_reconcile.if_names, name);
+    if (i >= 0) {
+        return &g_reconcile.ifs[i];
+    }
+
+    if (g_reconcile.n_ifs == g_reconcile.cap_ifs) {
+        cap = g_reconcile.cap_ifs ? 2 * g_reconcile.cap_ifs : SC_RECONCILE_IFS_HINT;
+        ifs = realloc(g_reconcile.ifs, cap * sizeof(*ifs));
+        if (NULL == ifs) {
+            return NULL;
+        }
+        /* the address arrays of the entries past n_ifs are kept for reuse */
+        memset(&ifs[g_reconcile.cap_ifs], 0, (cap - g_reconcile.cap_ifs) * sizeof(*ifs));
+        g_reconcile.ifs = ifs;
+        g_reconcile.cap_ifs = cap;
+    }
+
+    e = &g_reconcile.ifs[g_reconcile.n_ifs];
+    strncpy(e->name, name, VPP_INTFC_NAME_LEN - 1);
+    e->name[VPP_INTFC_NAME_LEN - 1] = '\0';
+    if (0 != sc_name_index_add(&g_reconcile.if_names, g_reconcile.n_ifs)) {
+        return NULL;
+    }
+    g_reconcile.n_ifs++;
+    /* default of ietf-interfaces */
+    e->enabled = true;
+    e->addrs.n_addrs[0] = e->addrs.n_addrs[1] = 0;
+
+    return e;
+}
+
+/**
+ * @brief Fold one configuration value into the entry of its interface.
+ */
+static int
+sc_reconcile_value(const sr_val_t *val)
+{
+    sr_xpath_ctx_t xpath_ctx = { 0, };
+    char name[VPP_INTFC_NAME_LEN] = { 0, };
+    u8 address[VPP_IP6_ADDRESS_LEN] = { 0, };
+    struct in_addr netmask;
+    sc_reconcile_if_t *e = NULL;
+    const char *ip = NULL;
+    const char *key = NULL;
+    bool is_ipv6, is_ip;
+    int prefix = -1;
+
+    key = sr_xpath_key_value(val->xpath, "interface", "name", &xpath_ctx);
+    if (NULL != key) {
+        strncpy(name, key, sizeof(name) - 1);
+    }
+    sr_xpath_recover(&xpath_ctx);
+    if (NULL == key) {
+        return 0;
+    }
+
+    e = sc_reconcile_if(name);
+    if (NULL == e) {
+        return -1;
+    }
+
+    is_ip = NULL != strstr(val->xpath, "/ietf-ip:");
+    if (!is_ip) {
+        if (sr_xpath_node_name_eq(val->xpath, "enabled") && SR_BOOL_T == val->type) {
+            e->enabled = val->data.bool_val;
+        }
+        return 0;
+    }
+
+    if (sr_xpath_node_name_eq(val->xpath, "prefix-length")) {
+        prefix = val->data.uint8_val;
+    } else if (sr_xpath_node_name_eq(val->xpath, "netmask") &&
+               1 == inet_pton(AF_INET, val->data.string_val, &netmask)) {
+        prefix = __builtin_popcount(netmask.s_addr);
+    }
+    if (prefix < 0) {
+        return 0;
+    }
+
+    is_ipv6 = NULL != strstr(val->xpath, "/ietf-ip:ipv6/");
+    ip = sr_xpath_key_value(val->xpath, "address", "ip", &xpath_ctx);
+    if (NULL == ip || 1 != inet_pton(is_ipv6 ? AF_INET6 : AF_INET, ip, address)) {
+        sr_xpath_recover(&xpath_ctx);
+        return 0;
+    }
+    sr_xpath_recover(&xpath_ctx);
+
+    return sc_reconcile_addr_push(&e->addrs, is_ipv6, address, prefix);
+}
+
+/**
+ * @brief Read the configuration of the interfaces, in one pass.
+ */
+static int
+sc_reconcile_read_config()
+{
+    sr_val_iter_t *iter = NULL;
+    sr_val_t *val = NULL;
+    int rc;
+
+    g_reconcile.n_ifs = 0;
+    sc_name_index_reset(&g_reconcile.if_names);
+
+    rc = sr_get_items_iter(g_reconcile.session, SC_RECONCILE_CONFIG_XPATH, &iter);
+    if (SR_ERR_NOT_FOUND == rc) {
+        return SR_ERR_OK;
+    }
+    if (SR_ERR_OK != rc) {
+        return rc;
+    }
+
+    while (SR_ERR_OK == (rc = sr_get_item_next(g_reconcile.session, iter, &val))) {
+        if (0 != sc_reconcile_value(val)) {
+            sr_free_val(val);
+            sr_free_val_iter(iter);
+            return SR_ERR_NOMEM;
+        }
+        sr_free_val(val);
+    }
+    sr_free_val_iter(iter);
+
+    return SR_ERR_NOT_FOUND == rc ? SR_ERR_OK : rc;
+}
+
+static bool
+sc_reconcile_addr_find(const sc_if_addrs_t *addrs, u8 af, const sc_ip_addr_t *addr)
+{
+    size_t len = af ? VPP_IP6_ADDRESS_LEN : VPP_IP4_ADDRESS_LEN;
+    u32 i;
+
+    for (i = 0; i < addrs->n_addrs[af]; i++) {
+        if (addrs->addrs[af][i].prefix_length == addr->prefix_length &&
+            0 == memcmp(addrs->addrs[af][i].address, addr->address, len)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static int
+sc_reconcile_addr_op(const sc_reconcile_if_t *e, u32 sw_if_index, u8 af,
+                     const sc_ip_addr_t *addr, bool add)
+{
+    char xpath[SC_RECONCILE_XPATH_LEN];
+    char ip[VPP_IP6_ADDRESS_STRING_LEN] = { 0, };
+
+    inet_ntop(af ? AF_INET6 : AF_INET, addr->address, ip, sizeof(ip));
+    snprintf(xpath, sizeof(xpath), SC_RECONCILE_IF_XPATH "/ietf-ip:%s/address[ip='%s']",
+             e->name, af ? "ipv6" : "ipv4", ip);
+
+    return sc_interface_txn_addr(&g_reconcile.txn, sw_if_index, add, af,
+                                 addr->prefix_length, addr->address, xpath);
+}
+
+/**
+ * @brief Stage the requests turning the state of VPP into the configuration
+ * of one interface: removals first, the new addresses may overlap them.
+ */
+static int
+sc_reconcile_diff(const sc_reconcile_if_t *e, const scVppIntfc *intfc)
+{
+    char xpath[SC_RECONCILE_XPATH_LEN];
+    const sc_if_addrs_t *actual = &g_reconcile.actual;
+    const sc_ip_addr_t *addr = NULL;
+    int rc = SR_ERR_OK;
+    u32 i;
+    u8 af;
+
+    if (0 != sc_interface_addr_dump(g_reconcile.vapi_ctx, intfc->sw_if_index,
+                                    &g_reconcile.actual)) {
+        return SR_ERR_DISCONNECT;
+    }
+
+    for (af = 0; af <= 1 && SR_ERR_OK == rc; af++) {
+        for (i = 0; i < actual->n_addrs[af] && SR_ERR_OK == rc; i++) {
+            addr = &actual->addrs[af][i];
+            /* link local addresses are VPP's own */
+            if (af && 0xfe == addr->address[0] && 0x80 == (addr->address[1] & 0xc0)) {
+                continue;
+            }
+            if (!sc_reconcile_addr_find(&e->addrs, af, addr)) {
+                rc = sc_reconcile_addr_op(e, intfc->sw_if_index, af, addr, false);
+            }
+        }
+    }
+    for (af = 0; af <= 1 && SR_ERR_OK == rc; af++) {
+        for (i = 0; i < e->addrs.n_addrs[af] && SR_ERR_OK == rc; i++) {
+            addr = &e->addrs.addrs[af][i];
+            if (!sc_reconcile_addr_find(actual, af, addr)) {
+                rc = sc_reconcile_addr_op(e, intfc->sw_if_index, af, addr, true);
+            }
+        }
+    }
+
+    if (SR_ERR_OK == rc && intfc->admin_up_down != e->enabled) {
+        snprintf(xpath, sizeof(xpath), SC_RECONCILE_IF_XPATH "/enabled", e->name);
+        rc = sc_interface_txn_flags(&g_reconcile.txn, intfc->sw_if_index, e->enabled, xpath);
+    }
+
+    return rc;
+}
+
+/**
+ * @brief Stage the requests turning VPP into the running configuration.
+ */
+static int
+sc_reconcile_stage(sc_reconcile_stats_t *stats)
+{
+    sc_sw_interface_dump_ctx dctx = { 0, };
+    const scVppIntfc *intfc = NULL;
+    int rc;
+    u32 i;
+
+    memset(stats, 0, sizeof(*stats));
+
+    rc = sr_session_refresh(g_reconcile.session);
+    if (SR_ERR_OK == rc) {
+        rc = sc_reconcile_read_config();
+    }
+    if (SR_ERR_OK != rc) {
+        SRP_LOG_ERR("Unable to read the interfaces configuration: %s", sr_strerror(rc));
+        return rc;
+    }
+
+    /* the state of VPP, not what a reader saw a moment ago, on a connection
+     * of our own: the requests of the shared one are not serialized */
+    if (NULL == g_reconcile.vapi_ctx &&
+        0 != sc_connect_vpp_private(SC_RECONCILE_APP_NAME, &g_reconcile.vapi_ctx)) {
+        SRP_LOG_ERR_MSG("Unable to connect to VPP for the reconciliation.");
+        return SR_ERR_DISCONNECT;
+    }
+    if (0 != sc_interface_dump(g_reconcile.vapi_ctx, &dctx)) {
+        rc = SR_ERR_DISCONNECT;
+    }
+
+    for (i = 0; i < g_reconcile.n_ifs && SR_ERR_OK == rc; i++) {
+        stats->interfaces++;
+        intfc = sc_interface_snapshot_find(&dctx, g_reconcile.ifs[i].name);
+        if (NULL == intfc) {
+            SRP_LOG_ERR("Configured interface '%s' is unknown to VPP.",
+                        g_reconcile.ifs[i].name);
+            stats->missing++;
+            continue;
+        }
+        rc = sc_reconcile_diff(&g_reconcile.ifs[i], intfc);
+    }
+    sc_freeSwInterfaceDumpCTX(&dctx);
+
+    if (SR_ERR_DISCONNECT == rc) {
+        /* VPP went away, reconnect on the next run */
+        SRP_LOG_ERR_MSG("Unable to read the state of VPP for the reconciliation.");
+        sc_disconnect_vpp_private(g_reconcile.vapi_ctx);
+        g_reconcile.vapi_ctx = NULL;
+    }
+    if (SR_ERR_OK != rc) {
+        sc_interface_txn_clear(&g_reconcile.txn);
+    }
+
+    return rc;
+}
+
+/**
+ * @brief One reconciliation, reconcile thread only. The batch is applied
+ * only if no change set was committed while it was built, the change
+ * callback applying its own changes next.
+ */
+static int
+sc_reconcile_run(sc_reconcile_stats_t *stats)
+{
+    u32 attempt;
+    u64 generation;
+    int rc, failed;
+
+    for (attempt = 0; attempt < SC_RECONCILE_ATTEMPTS; attempt++) {
+        generation = sc_interface_config_mark();
+        rc = sc_reconcile_stage(stats);
+        if (SR_ERR_OK != rc) {
+            return rc;
+        }
+        if (0 == sc_interface_config_hold(generation)) {
+            break;
+        }
+        /* built from a configuration changed since, diff again */
+        sc_interface_txn_clear(&g_reconcile.txn);
+    }
+    if (SC_RECONCILE_ATTEMPTS == attempt) {
+        SRP_LOG_WRN_MSG("The interfaces configuration keeps changing, reconciling later.");
+        return SR_ERR_LOCKED;
+    }
+
+    stats->changes = g_reconcile.txn.n_ops;
+    if (0 != stats->changes) {
+        SRP_LOG_INF("Repairing %u differences between the configuration and VPP.",
+                    stats->changes);
+    }
+    failed = sc_interface_txn_commit(&g_reconcile.txn);
+    sc_interface_config_release();
+    stats->failed = failed < 0 ? stats->changes : failed;
+
+    return SR_ERR_OK;
+}
+
+static void *
+sc_reconcile_thread(void *arg)
+{
+    sc_reconcile_stats_t stats;
+    struct timespec deadline;
+    u64 target;
+    int rc;
+
+    pthread_mutex_lock(&g_reconcile.lock);
+    while (!g_reconcile.stop) {
+        if (g_reconcile.completed == g_reconcile.requested) {
+            if (0 == g_reconcile.retry_ms) {
+                pthread_cond_wait(&g_reconcile.wakeup, &g_reconcile.lock);
+                continue;
+            }
+            if (sc_reconcile_now_ms() < g_reconcile.retry_ms) {
+                deadline.tv_sec = g_reconcile.retry_ms / 1000;
+                deadline.tv_nsec = (g_reconcile.retry_ms % 1000) * 1000000L;
+                pthread_cond_timedwait(&g_reconcile.wakeup, &g_reconcile.lock, &deadline);
+                continue;
+            }
+            /* the last run failed, a run of our own */
+            g_reconcile.requested++;
+        }
+        /* one run serves all the requests made so far */
+        target = g_reconcile.requested;
+        g_reconcile.retry_ms = 0;
+        pthread_mutex_unlock(&g_reconcile.lock);
+
+        rc = sc_reconcile_run(&stats);
+
+        pthread_mutex_lock(&g_reconcile.lock);
+        if (SR_ERR_OK != rc) {
+            g_reconcile.retry_ms = sc_reconcile_now_ms() + SC_RECONCILE_RETRY_MS;
+        }
+        g_reconcile.last_rc = rc;
+        g_reconcile.last = stats;
+        g_reconcile.completed = target;
+        pthread_cond_broadcast(&g_reconcile.done);
+    }
+    pthread_mutex_unlock(&g_reconcile.lock);
+
+    return NULL;
+}
+
+u64
+sc_reconcile_request()
+{
+    u64 ticket = 0;
+
+    pthread_mutex_lock(&g_reconcile.lock);
+    if (g_reconcile.running && !g_reconcile.stop) {
+        ticket = ++g_reconcile.requested;
+        pthread_cond_signal(&g_reconcile.wakeup);
+    }
+    pthread_mutex_unlock(&g_reconcile.lock);
+
+    return ticket;
+}
+
+int
+sc_reconcile_wait(u64 ticket, sc_reconcile_stats_t *stats)
+{
+    int rc = -1;
+
+    pthread_mutex_lock(&g_reconcile.lock);
+    while (0 != ticket && g_reconcile.running && g_reconcile.completed < ticket) {
+        pthread_cond_wait(&g_reconcile.done, &g_reconcile.lock);
+    }
+    if (0 != ticket && g_reconcile.completed >= ticket && SR_ERR_OK == g_reconcile.last_rc) {
+        *stats = g_reconcile.last;
+        rc = 0;
+    }
+    pthread_mutex_unlock(&g_reconcile.lock);
+
+    return rc;
+}
+
+static void
+sc_reconcile_count_leaf(sc_vals_t *vals, const char *leaf, u32 value)
+{
+    sr_val_t *val = sc_vals_leaf(vals, leaf);
+
+    if (NULL != val) {
+        val->type = SR_UINT32_T;
+        val->data.uint32_val = value;
+    }
+}
+
+/**
+ * @brief RPC "/sweetcomb-telemetry:reconcile", waits for the run it requested.
+ */
+static int
+sc_reconcile_rpc_cb(const char *xpath, const sr_val_t *input, const size_t input_cnt,
+                    sr_val_t **output, size_t *output_cnt, void *private_ctx)
+{
+    sc_reconcile_stats_t stats;
+    sc_vals_t vals;
+
+    *output = NULL;
+    *output_cnt = 0;
+
+    if (0 != sc_reconcile_wait(sc_reconcile_request(), &stats)) {
+        return SR_ERR_OPERATION_FAILED;
+    }
+
+    if (SR_ERR_OK != sc_vals_init(&vals, SC_RECONCILE_OUTPUT_LEAVES)) {
+        return vals.rc;
+    }
+    sc_vals_entry(&vals, SC_RECONCILE_RPC);
+    sc_reconcile_count_leaf(&vals, "interfaces", stats.interfaces);
+    sc_reconcile_count_leaf(&vals, "missing", stats.missing);
+    sc_reconcile_count_leaf(&vals, "changes", stats.changes);
+    sc_reconcile_count_leaf(&vals, "failed", stats.failed);
+
+    return sc_vals_finish(&vals, output, output_cnt);
+}
+
+static int
+sc_reconcile_start(u64 *ticket)
+{
+    pthread_condattr_t attr;
+    int rc = SR_ERR_OK;
+
+    *ticket = 0;
+
+    pthread_mutex_lock(&g_reconcile.lock);
+    if (g_reconcile.running) {
+        goto out;
+    }
+
+    /* sessions are not shared across threads, the reconciler has its own */
+    rc = sr_connect(SC_RECONCILE_APP_NAME, SR_CONN_DEFAULT, &g_reconcile.connection);
+    if (SR_ERR_OK == rc) {
+        rc = sr_session_start(g_reconcile.connection, SR_DS_RUNNING, SR_SESS_DEFAULT,
+                              &g_reconcile.session);
+    }
+    if (SR_ERR_OK != rc) {
+        SRP_LOG_ERR("Unable to open the reconciliation session: %s", sr_strerror(rc));
+        goto error;
+    }
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&g_reconcile.wakeup, &attr);
+    pthread_condattr_destroy(&attr);
+    g_reconcile.retry_ms = 0;
+    g_reconcile.stop = false;
+    /* the first run applies the startup configuration, and repairs what
+     * changed while we were away */
+    g_reconcile.requested = g_reconcile.completed + 1;
+    if (0 != pthread_create(&g_reconcile.thread, NULL, sc_reconcile_thread, NULL)) {
+        SRP_LOG_ERR_MSG("Unable to start the reconciler.");
+        pthread_cond_destroy(&g_reconcile.wakeup);
+        g_reconcile.requested = g_reconcile.completed;
+        rc = SR_ERR_INTERNAL;
+        goto error;
+    }
+    g_reconcile.running = true;
+    *ticket = g_reconcile.requested;
+    goto out;
+
+error:
+    if (NULL != g_reconcile.session) {
+        sr_session_stop(g_reconcile.session);
+        g_reconcile.session = NULL;
+    }
+    if (NULL != g_reconcile.connection) {
+        sr_disconnect(g_reconcile.connection);
+        g_reconcile.connection = NULL;
+    }
+out:
+    pthread_mutex_unlock(&g_reconcile.lock);
+    return rc;
+}
+
+int
+sc_reconcile_subscribe_events(sr_session_ctx_t *session,
+                              sr_subscription_ctx_t **subscription)
+{
+    sc_reconcile_stats_t stats;
+    u64 ticket;
+    int rc;
+
+    rc = sc_reconcile_start(&ticket);
+    if (SR_ERR_OK != rc) {
+        return rc;
+    }
+
+    /* as the replay of SR_SUBSCR_EV_ENABLED did, configure VPP before the
+     * plugin is up; a failed run is retried until VPP answers */
+    if (0 != ticket && 0 == sc_reconcile_wait(ticket, &stats)) {
+        SRP_LOG_INF("Startup configuration of %u interfaces synced, %u requests, %u failed.",
+                    stats.interfaces, stats.changes, stats.failed);
+    } else if (0 != ticket) {
+        SRP_LOG_WRN_MSG("Startup configuration not synced yet, retrying.");
+    }
+
+    rc = sr_rpc_subscribe(session, SC_RECONCILE_RPC, sc_reconcile_rpc_cb, NULL,
+                          SR_SUBSCR_CTX_REUSE, subscription);
+    if (SR_ERR_OK != rc) {
+        SRP_LOG_ERR("Unable to subscribe to %s: %s", SC_RECONCILE_RPC, sr_strerror(rc));
+        sc_reconcile_cleanup();
+    }
+
+    return rc;
+}
+
+void
+sc_reconcile_cleanup()
+{
+    u32 i;
+
+    pthread_mutex_lock(&g_reconcile.lock);
+    if (!g_reconcile.running) {
+        pthread_mutex_unlock(&g_reconcile.lock);
+        return;
+    }
+    g_reconcile.stop = true;
+    pthread_cond_signal(&g_reconcile.wakeup);
+    pthread_mutex_unlock(&g_reconcile.lock);
+
+    pthread_join(g_reconcile.thread, NULL);
+
+    pthread_mutex_lock(&g_reconcile.lock);
+    g_reconcile.running = false;
+    /* waiters give up */
+    pthread_cond_broadcast(&g_reconcile.done);
+    pthread_cond_destroy(&g_reconcile.wakeup);
+    sr_session_stop(g_reconcile.session);
+    g_reconcile.session = NULL;
+    sr_disconnect(g_reconcile.connection);
+    g_reconcile.connection = NULL;
+    if (NULL != g_reconcile.vapi_ctx) {
+        sc_disconnect_vpp_private(g_reconcile.vapi_ctx);
+        g_reconcile.vapi_ctx = NULL;
+    }
+    for (i = 0; i < g_reconcile.cap_ifs; i++) {
+        sc_interface_addrs_free(&g_reconcile.ifs[i].addrs);
+    }
+    free(g_reconcile.ifs);
+    g_reconcile.ifs = NULL;
+    g_reconcile.n_ifs = g_reconcile.cap_ifs = 0;
+    sc_name_index_free(&g_reconcile.if_names);
+    sc_interface_addrs_free(&g_reconcile.actual);
+    sc_interface_txn_free(&g_reconcile.txn);
+    pthread_mutex_unlock(&g_reconcile.lock);
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SC_RECONCILE_H
+#define SC_RECONCILE_H
+
+#include <sysrepo.h>
+#include <vppinfra/types.h>
+
+/* Outcome of a reconciliation. */
+typedef struct
+{
+    u32 interfaces;             /* configured interfaces compared */
+    u32 missing;                /* of them unknown to VPP */
+    u32 changes;                /* requests sent to repair the drift */
+    u32 failed;                 /* of them refused by VPP */
+} sc_reconcile_stats_t;
+
+/**
+ * @brief Reconcile VPP with the running configuration of ietf-interfaces.
+ *
+ * A thread compares the enabled leaves and the ietf-ip addresses of the
+ * configured interfaces with what it dumps from VPP, on a connection of its
+ * own, and applies only the difference, as one batch: the addresses VPP
+ * has but the configuration lacks are removed, the missing ones added. A
+ * batch built while a change set was committed is built again, change sets
+ * wait at verify while a batch is applied (sc_interface_config_hold()).
+ * Its first run applies the startup configuration
+ * and completes before this returns: the interface subscriptions do not
+ * replay it leaf by leaf. It runs again whenever
+ * sc_reconcile_request() is called and on the RPC
+ * "/sweetcomb-telemetry:reconcile". A run that could not read the
+ * configuration or VPP fails and is retried a few seconds later.
+ * Interfaces that are not configured are left alone.
+ */
+int
+sc_reconcile_subscribe_events(sr_session_ctx_t *session,
+                              sr_subscription_ctx_t **subscription);
+
+/**
+ * @brief Ask for a reconciliation, when VPP came back for instance.
+ *
+ * Requests made while one runs are served by a single next run. Returns
+ * the ticket sc_reconcile_wait() waits for, 0 when the reconciler is not
+ * running.
+ */
+u64 sc_reconcile_request();
+
+/**
+ * @brief Wait for the run serving ticket, -1 if the reconciler stopped or the
+ * run failed.
+ */
+int sc_reconcile_wait(u64 ticket, sc_reconcile_stats_t *stats);
+
+/**
+ * @brief Stop the reconciler, before the interfaces are cleaned up.
+ */
+void sc_reconcile_cleanup();
+
+#endif /* SC_RECONCILE_H */
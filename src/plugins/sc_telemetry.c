@@ -0,0 +1,723 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sc_telemetry.h"
+#include "sc_interface.h"
+#include "sc_notify.h"
+#include "sc_values.h"
+#include "sc_snapshot.h"
+#include "sc_vpp_stats.h"
+#include "sc_vpp_rates.h"
+#include "sc_vpp_history.h"
+#include <sysrepo/plugins.h>
+#include <sysrepo/values.h>
+#include <sysrepo/xpath.h>
+
+#define SC_TELEMETRY_RATES_XPATH "/sweetcomb-telemetry:telemetry/rates"
+#define SC_TELEMETRY_HISTORY_XPATH "/sweetcomb-telemetry:telemetry/history"
+#define SC_TELEMETRY_REFRESH_XPATH "/sweetcomb-telemetry:telemetry/refresh"
+#define SC_TELEMETRY_STATE_XPATH "/sweetcomb-telemetry:telemetry-state"
+#define SC_TELEMETRY_HISTORY_RPC "/sweetcomb-telemetry:get-counter-history"
+#define SC_TELEMETRY_RUNTIME_XPATH SC_TELEMETRY_STATE_XPATH "/runtime"
+
+#define SC_TELEMETRY_RUNTIME_KEY "runtime_read"
+/* the stat, node and thread lists of one poll share a read */
+#define SC_TELEMETRY_RUNTIME_TTL_MS 1000
+
+/* yang:date-and-time with milliseconds, in UTC */
+#define SC_TELEMETRY_TIME_LEN sizeof("1970-01-01T00:00:00.000Z")
+
+/* number of leaves of the rates and rates/average containers */
+#define SC_TELEMETRY_RATES_LEAVES 4
+/* number of leaves of a get-counter-history sample */
+#define SC_TELEMETRY_SAMPLE_LEAVES 6
+/* samples the output is sized for, it grows past them */
+#define SC_TELEMETRY_SAMPLES_HINT 64
+/* number of leaves of a runtime node or thread entry, index included */
+#define SC_TELEMETRY_RUNTIME_LEAVES 7
+/* number of leaves of the refresh state container */
+#define SC_TELEMETRY_REFRESH_LEAVES 3
+
+/**
+ * @brief Read an uint32 configuration leaf, value is left as is when unset.
+ */
+static int
+sc_telemetry_get_u32(sr_session_ctx_t *session, const char *xpath, u32 *value)
+{
+    sr_val_t *val = NULL;
+    int rc;
+
+    rc = sr_get_item(session, xpath, &val);
+    if (SR_ERR_NOT_FOUND == rc) {
+        return SR_ERR_OK;
+    }
+    if (SR_ERR_OK != rc) {
+        return rc;
+    }
+    if (SR_UINT32_T == val->type) {
+        *value = val->data.uint32_val;
+    }
+    sr_free_val(val);
+
+    return SR_ERR_OK;
+}
+
+/**
+ * @brief Callback for "/sweetcomb-telemetry:telemetry/rates", reconfigures the sampler.
+ */
+static int
+sc_telemetry_rates_config_cb(sr_session_ctx_t *session, const char *xpath,
+                             sr_notif_event_t event, void *private_ctx)
+{
+    sc_rates_config_t config = {
+        .interval_ms = SC_RATES_INTERVAL_MS,
+        .average_ms = SC_RATES_AVERAGE_MS,
+    };
+    int rc;
+
+    /* ranges are checked by sysrepo, the new values are read once applied */
+    if (SR_EV_APPLY != event && SR_EV_ENABLED != event) {
+        return SR_ERR_OK;
+    }
+    SRP_LOG_DBG("'%s' modified, event=%d", xpath, event);
+
+    rc = sc_telemetry_get_u32(session, SC_TELEMETRY_RATES_XPATH "/sample-interval",
+                              &config.interval_ms);
+    if (SR_ERR_OK == rc) {
+        rc = sc_telemetry_get_u32(session, SC_TELEMETRY_RATES_XPATH "/average-interval",
+                                  &config.average_ms);
+    }
+    if (SR_ERR_OK != rc) {
+        SRP_LOG_ERR("Unable to read the rates configuration: %s", sr_strerror(rc));
+        return rc;
+    }
+
+    if (0 != sc_rates_configure(&config)) {
+        return SR_ERR_INVAL_ARG;
+    }
+
+    return SR_ERR_OK;
+}
+
+/**
+ * @brief Callback for "/sweetcomb-telemetry:telemetry/refresh", bounds the refresh period.
+ */
+static int
+sc_telemetry_refresh_config_cb(sr_session_ctx_t *session, const char *xpath,
+                               sr_notif_event_t event, void *private_ctx)
+{
+    u32 min_ms = SC_NOTIFY_MIN_MS, max_ms = SC_NOTIFY_MAX_MS;
+    int rc;
+
+    if (SR_EV_APPLY != event && SR_EV_ENABLED != event) {
+        return SR_ERR_OK;
+    }
+    SRP_LOG_DBG("'%s' modified, event=%d", xpath, event);
+
+    rc = sc_telemetry_get_u32(session, SC_TELEMETRY_REFRESH_XPATH "/min-interval",
+                              &min_ms);
+    if (SR_ERR_OK == rc) {
+        rc = sc_telemetry_get_u32(session, SC_TELEMETRY_REFRESH_XPATH "/max-interval",
+                                  &max_ms);
+    }
+    if (SR_ERR_OK != rc) {
+        SRP_LOG_ERR("Unable to read the refresh configuration: %s", sr_strerror(rc));
+        return rc;
+    }
+
+    sc_notify_configure(min_ms, max_ms);
+
+    return SR_ERR_OK;
+}
+
+/* size of the history rings, reallocated only when it changes */
+static sc_history_config_t g_history_config = {
+    .depth = SC_HISTORY_DEPTH,
+    .max_ifs = SC_HISTORY_MAX_IFS,
+};
+
+/**
+ * @brief Callback for "/sweetcomb-telemetry:telemetry/history", resizes the rings.
+ */
+static int
+sc_telemetry_history_config_cb(sr_session_ctx_t *session, const char *xpath,
+                               sr_notif_event_t event, void *private_ctx)
+{
+    sc_history_config_t config = {
+        .depth = SC_HISTORY_DEPTH,
+        .max_ifs = SC_HISTORY_MAX_IFS,
+    };
+    int rc;
+
+    if (SR_EV_APPLY != event && SR_EV_ENABLED != event) {
+        return SR_ERR_OK;
+    }
+    SRP_LOG_DBG("'%s' modified, event=%d", xpath, event);
+
+    rc = sc_telemetry_get_u32(session, SC_TELEMETRY_HISTORY_XPATH "/depth",
+                              &config.depth);
+    if (SR_ERR_OK == rc) {
+        rc = sc_telemetry_get_u32(session, SC_TELEMETRY_HISTORY_XPATH "/max-interfaces",
+                                  &config.max_ifs);
+    }
+    if (SR_ERR_OK != rc) {
+        SRP_LOG_ERR("Unable to read the history configuration: %s", sr_strerror(rc));
+        return rc;
+    }
+
+    if (config.depth == g_history_config.depth &&
+        config.max_ifs == g_history_config.max_ifs) {
+        return SR_ERR_OK;
+    }
+
+    if (0 != sc_history_start(&config)) {
+        SRP_LOG_ERR_MSG("Unable to allocate the counter history.");
+        return SR_ERR_NOMEM;
+    }
+    g_history_config = config;
+
+    return SR_ERR_OK;
+}
+
+/**
+ * @brief Milliseconds since the epoch of a yang:date-and-time, -1 if malformed.
+ */
+static int64_t
+sc_telemetry_time_parse(const char *str)
+{
+    struct tm tm = { 0, };
+    int64_t ms = 0;
+    int digits = 0, len = 0, hh, mm;
+    time_t t;
+
+    if (6 != sscanf(str, "%4d-%2d-%2dT%2d:%2d:%2d%n", &tm.tm_year, &tm.tm_mon,
+                    &tm.tm_mday, &tm.tm_hour, &tm.tm_min, &tm.tm_sec, &len)) {
+        return -1;
+    }
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    str += len;
+
+    if ('.' == *str) {
+        for (str++; *str >= '0' && *str <= '9'; str++) {
+            if (digits < 3) {
+                ms = ms * 10 + (*str - '0');
+                digits++;
+            }
+        }
+        for (; digits < 3; digits++) {
+            ms *= 10;
+        }
+    }
+
+    t = timegm(&tm);
+    if ('Z' == *str || 'z' == *str) {
+        str++;
+    } else if (('+' == *str || '-' == *str) &&
+               2 == sscanf(str + 1, "%2d:%2d%n", &hh, &mm, &len)) {
+        t -= ('-' == *str ? -1 : 1) * (hh * 3600 + mm * 60);
+        str += 1 + len;
+    } else {
+        return -1;
+    }
+
+    return '\0' == *str ? (int64_t)t * 1000 + ms : -1;
+}
+
+static void
+sc_telemetry_time_format(u64 time_ms, char *buf, size_t size)
+{
+    time_t t = time_ms / 1000;
+    struct tm tm;
+    size_t len;
+
+    gmtime_r(&t, &tm);
+    len = strftime(buf, size, "%Y-%m-%dT%H:%M:%S", &tm);
+    snprintf(buf + len, size - len, ".%03uZ", (unsigned)(time_ms % 1000));
+}
+
+static void
+sc_telemetry_counter_leaf(sc_vals_t *vals, const char *leaf, u64 value)
+{
+    sr_val_t *val = sc_vals_leaf(vals, leaf);
+
+    if (NULL != val) {
+        val->type = SR_UINT64_T;
+        val->data.uint64_val = value;
+    }
+}
+
+static int
+sc_telemetry_history_add(u64 time_ms, const sc_if_sample_t *sample, void *ctx)
+{
+    sc_vals_t *vals = ctx;
+    char time_str[SC_TELEMETRY_TIME_LEN];
+
+    sc_telemetry_time_format(time_ms, time_str, sizeof(time_str));
+    if (SR_ERR_OK != sc_vals_entry(vals, SC_TELEMETRY_HISTORY_RPC "/sample[time='%s']",
+                                   time_str)) {
+        return -1;
+    }
+
+    sc_telemetry_counter_leaf(vals, "in-octets", sample->rx_bytes);
+    sc_telemetry_counter_leaf(vals, "in-pkts", sample->rx_packets);
+    sc_telemetry_counter_leaf(vals, "out-octets", sample->tx_bytes);
+    sc_telemetry_counter_leaf(vals, "out-pkts", sample->tx_packets);
+    sc_telemetry_counter_leaf(vals, "discards", sample->drops);
+    sc_telemetry_counter_leaf(vals, "errors", sample->errors);
+
+    return SR_ERR_OK == vals->rc ? 0 : -1;
+}
+
+/**
+ * @brief RPC "/sweetcomb-telemetry:get-counter-history", served from the rings.
+ */
+static int
+sc_telemetry_history_rpc_cb(const char *xpath, const sr_val_t *input,
+                            const size_t input_cnt, sr_val_t **output,
+                            size_t *output_cnt, void *private_ctx)
+{
+    const char *if_name = NULL;
+    int64_t from_ms = 0, to_ms = INT64_MAX;
+    sc_snapshot_ref_t *ref = NULL;
+    const scVppIntfc *intfc = NULL;
+    sc_vals_t vals;
+    u32 sw_if_index;
+    size_t i;
+
+    *output = NULL;
+    *output_cnt = 0;
+
+    for (i = 0; i < input_cnt; i++) {
+        if (SR_STRING_T != input[i].type) {
+            continue;
+        }
+        if (sr_xpath_node_name_eq(input[i].xpath, "interface")) {
+            if_name = input[i].data.string_val;
+        } else if (sr_xpath_node_name_eq(input[i].xpath, "start-time")) {
+            from_ms = sc_telemetry_time_parse(input[i].data.string_val);
+        } else if (sr_xpath_node_name_eq(input[i].xpath, "end-time")) {
+            to_ms = sc_telemetry_time_parse(input[i].data.string_val);
+        }
+    }
+    if (NULL == if_name || from_ms < 0 || to_ms < 0) {
+        return SR_ERR_INVAL_ARG;
+    }
+
+    intfc = sc_interface_snapshot_find(sc_interface_snapshot_acquire(&ref), if_name);
+    if (NULL == intfc) {
+        sc_interface_snapshot_release(ref);
+        return SR_ERR_NOT_FOUND;
+    }
+    sw_if_index = intfc->sw_if_index;
+    sc_interface_snapshot_release(ref);
+
+    if (SR_ERR_OK != sc_vals_init(&vals, SC_TELEMETRY_SAMPLES_HINT * SC_TELEMETRY_SAMPLE_LEAVES)) {
+        return vals.rc;
+    }
+
+    if (-1 == sc_history_walk(sw_if_index, from_ms, to_ms,
+                              sc_telemetry_history_add, &vals) &&
+        SR_ERR_OK == vals.rc) {
+        /* an interface above max-interfaces, nothing recorded */
+        sc_vals_free(&vals);
+        return SR_ERR_OK;
+    }
+
+    return sc_vals_finish(&vals, output, output_cnt);
+}
+
+static void
+sc_telemetry_rate_leaf(sc_vals_t *vals, const char *leaf, f64 rate)
+{
+    sr_val_t *val = sc_vals_leaf(vals, leaf);
+
+    if (NULL != val) {
+        val->type = SR_UINT64_T;
+        val->data.uint64_val = (u64)(rate + 0.5);
+    }
+}
+
+/**
+ * @brief Build the "rates" or "rates/average" container of an interface.
+ */
+static int
+sc_telemetry_rates_state(const char *xpath, bool average, sr_val_t **values,
+                         size_t *values_cnt)
+{
+    sr_xpath_ctx_t xpath_ctx = { 0, };
+    char if_name[VPP_INTFC_NAME_LEN] = { 0, };
+    sc_snapshot_ref_t *ref = NULL;
+    const scVppIntfc *intfc = NULL;
+    sc_if_rates_t rates;
+    sc_vals_t vals;
+    char *key = NULL;
+
+    key = sr_xpath_key_value((char *)xpath, "interface", "name", &xpath_ctx);
+    if (NULL != key) {
+        strncpy(if_name, key, sizeof(if_name) - 1);
+    }
+    sr_xpath_recover(&xpath_ctx);
+    if (NULL == key) {
+        return SR_ERR_INVAL_ARG;
+    }
+
+    intfc = sc_interface_snapshot_find(sc_interface_snapshot_acquire(&ref), if_name);
+    if (NULL == intfc || 0 != sc_rates_get(intfc->sw_if_index, &rates)) {
+        /* unknown interface, or not sampled twice yet */
+        sc_interface_snapshot_release(ref);
+        return SR_ERR_OK;
+    }
+    sc_interface_snapshot_release(ref);
+
+    if (SR_ERR_OK != sc_vals_init(&vals, SC_TELEMETRY_RATES_LEAVES)) {
+        return vals.rc;
+    }
+
+    sc_vals_entry(&vals, SC_TELEMETRY_STATE_XPATH "/interface[name='%s']/rates%s",
+                  if_name, average ? "/average" : "");
+    if (average) {
+        sc_telemetry_rate_leaf(&vals, "in-bps", rates.rx_bps_avg);
+        sc_telemetry_rate_leaf(&vals, "in-pps", rates.rx_pps_avg);
+        sc_telemetry_rate_leaf(&vals, "out-bps", rates.tx_bps_avg);
+        sc_telemetry_rate_leaf(&vals, "out-pps", rates.tx_pps_avg);
+    } else {
+        sc_telemetry_rate_leaf(&vals, "in-bps", rates.rx_bps);
+        sc_telemetry_rate_leaf(&vals, "in-pps", rates.rx_pps);
+        sc_telemetry_rate_leaf(&vals, "out-bps", rates.tx_bps);
+        sc_telemetry_rate_leaf(&vals, "out-pps", rates.tx_pps);
+    }
+
+    return sc_vals_finish(&vals, values, values_cnt);
+}
+
+static int runtime_load(void **data)
+{
+    sc_runtime_stats_t *rt = calloc(1, sizeof(*rt));
+
+    if (NULL == rt) {
+        return -1;
+    }
+
+    *data = rt;
+    return sc_stats_runtime_read(rt);
+}
+
+static void runtime_free(void *data)
+{
+    sc_runtime_stats_free(data);
+    free(data);
+}
+
+static sc_snapshot_t g_runtime_snapshot =
+    SC_SNAPSHOT_INIT(SC_TELEMETRY_RUNTIME_KEY, runtime_load, runtime_free,
+                     SC_TELEMETRY_RUNTIME_TTL_MS);
+
+static void
+sc_telemetry_ratio_leaf(sc_vals_t *vals, const char *leaf, u64 num, u64 den)
+{
+    sr_val_t *val = sc_vals_leaf(vals, leaf);
+
+    if (NULL != val) {
+        val->type = SR_DECIMAL64_T;
+        val->data.decimal64_val = 0 != den ? (double)num / den : 0;
+    }
+}
+
+static void
+sc_telemetry_runtime_entry(sc_vals_t *vals, const char *list, u32 index,
+                           const sc_node_counters_t *c)
+{
+    sr_val_t *val = NULL;
+
+    if (SR_ERR_OK != sc_vals_entry(vals, SC_TELEMETRY_RUNTIME_XPATH "/%s[index='%u']",
+                                   list, index)) {
+        return;
+    }
+
+    if (NULL != (val = sc_vals_leaf(vals, "index"))) {
+        val->type = SR_UINT32_T;
+        val->data.uint32_val = index;
+    }
+    sc_telemetry_counter_leaf(vals, "calls", c->calls);
+    sc_telemetry_counter_leaf(vals, "vectors", c->vectors);
+    sc_telemetry_counter_leaf(vals, "suspends", c->suspends);
+    sc_telemetry_counter_leaf(vals, "clocks", c->clocks);
+    sc_telemetry_ratio_leaf(vals, "vectors-per-call", c->vectors, c->calls);
+    sc_telemetry_ratio_leaf(vals, "clocks-per-vector", c->clocks, c->vectors);
+}
+
+static void
+sc_telemetry_runtime_stat(sc_vals_t *vals, const sc_stats_scalar_t *scalar)
+{
+    sr_val_t *val = NULL;
+
+    if (SR_ERR_OK != sc_vals_entry(vals, SC_TELEMETRY_RUNTIME_XPATH "/stat[name='%s']",
+                                   scalar->name)) {
+        return;
+    }
+
+    sc_vals_leaf_str(vals, "name", SR_STRING_T, scalar->name);
+    if (NULL != (val = sc_vals_leaf(vals, "value"))) {
+        val->type = SR_DECIMAL64_T;
+        val->data.decimal64_val = scalar->value;
+    }
+}
+
+/**
+ * @brief Build the "stat", "node" or "thread" list of "telemetry-state/runtime",
+ * or the entry the xpath selects.
+ */
+static int
+sc_telemetry_runtime_state(const char *xpath, const char *list,
+                           sr_val_t **values, size_t *values_cnt)
+{
+    sr_xpath_ctx_t xpath_ctx = { 0, };
+    char key_str[SC_STATS_NAME_LEN] = { 0, };
+    bool is_stat = 0 == strcmp(list, "stat");
+    sc_snapshot_ref_t *ref = NULL;
+    const sc_runtime_stats_t *rt = NULL;
+    const sc_node_counters_t *counters = NULL;
+    size_t n = 0, hint;
+    sc_vals_t vals;
+    char *key = NULL;
+    u32 i, index = ~0;
+
+    key = sr_xpath_key_value((char *)xpath, list, is_stat ? "name" : "index", &xpath_ctx);
+    if (NULL != key) {
+        strncpy(key_str, key, sizeof(key_str) - 1);
+    }
+    sr_xpath_recover(&xpath_ctx);
+    if (NULL != key && !is_stat) {
+        index = strtoul(key_str, NULL, 10);
+    }
+
+    ref = sc_snapshot_acquire(&g_runtime_snapshot);
+    rt = sc_snapshot_data(ref);
+    if (NULL == rt) {
+        SRP_LOG_ERR_MSG("Error by reading the VPP runtime statistics.");
+        sc_snapshot_release(ref);
+        return SR_ERR_INTERNAL;
+    }
+
+    if (is_stat) {
+        n = rt->n_scalars;
+    } else if (0 == strcmp(list, "node")) {
+        counters = rt->nodes;
+        n = rt->n_nodes;
+    } else {
+        counters = rt->threads;
+        n = rt->n_threads;
+    }
+
+    hint = (NULL != key ? 1 : n) * (is_stat ? 2 : SC_TELEMETRY_RUNTIME_LEAVES);
+    if (SR_ERR_OK != sc_vals_init(&vals, hint)) {
+        sc_snapshot_release(ref);
+        return vals.rc;
+    }
+
+    for (i = 0; i < n && SR_ERR_OK == vals.rc; i++) {
+        if (is_stat) {
+            if (NULL == key || 0 == strcmp(key_str, rt->scalars[i].name)) {
+                sc_telemetry_runtime_stat(&vals, &rt->scalars[i]);
+            }
+        } else if (NULL != key ? i == index :
+                   /* most nodes never run, only list those that did */
+                   counters == rt->threads || 0 != counters[i].calls ||
+                   0 != counters[i].suspends) {
+            sc_telemetry_runtime_entry(&vals, list, i, &counters[i]);
+        }
+    }
+    sc_snapshot_release(ref);
+
+    return sc_vals_finish(&vals, values, values_cnt);
+}
+
+static void
+sc_telemetry_u32_leaf(sc_vals_t *vals, const char *leaf, u32 value)
+{
+    sr_val_t *val = sc_vals_leaf(vals, leaf);
+
+    if (NULL != val) {
+        val->type = SR_UINT32_T;
+        val->data.uint32_val = value;
+    }
+}
+
+/**
+ * @brief Build the "telemetry-state/refresh" container.
+ */
+static int
+sc_telemetry_refresh_state(sr_val_t **values, size_t *values_cnt)
+{
+    sc_refresh_t refresh;
+    sc_vals_t vals;
+
+    sc_notify_refresh(&refresh);
+
+    if (SR_ERR_OK != sc_vals_init(&vals, SC_TELEMETRY_REFRESH_LEAVES)) {
+        return vals.rc;
+    }
+
+    sc_vals_entry(&vals, SC_TELEMETRY_STATE_XPATH "/refresh");
+    sc_telemetry_u32_leaf(&vals, "interval", refresh.interval_ms);
+    sc_telemetry_counter_leaf(&vals, "refreshes", refresh.refreshes);
+    sc_telemetry_counter_leaf(&vals, "changes", refresh.changes);
+
+    return sc_vals_finish(&vals, values, values_cnt);
+}
+
+/**
+ * @brief List the interfaces of "/sweetcomb-telemetry:telemetry-state/interface".
+ */
+static int
+sc_telemetry_interface_state(sr_val_t **values, size_t *values_cnt)
+{
+    const sc_sw_interface_dump_ctx *dctx = NULL;
+    sc_snapshot_ref_t *ref = NULL;
+    sc_vals_t vals;
+    size_t i;
+
+    dctx = sc_interface_snapshot_acquire(&ref);
+    if (NULL == dctx) {
+        SRP_LOG_ERR_MSG("Error by processing of a interface dump request.");
+        sc_interface_snapshot_release(ref);
+        return SR_ERR_INTERNAL;
+    }
+
+    if (SR_ERR_OK == sc_vals_init(&vals, dctx->num_ifs)) {
+        for (i = 0; i < dctx->num_ifs; i++) {
+            const char *name = dctx->intfcArray[i].interface_name;
+
+            sc_vals_add_str(&vals, SR_STRING_T, name,
+                            SC_TELEMETRY_STATE_XPATH "/interface[name='%s']/name", name);
+        }
+    }
+    sc_interface_snapshot_release(ref);
+
+    return sc_vals_finish(&vals, values, values_cnt);
+}
+
+/**
+ * @brief Callback for state data under "/sweetcomb-telemetry:telemetry-state".
+ */
+static int
+sc_telemetry_state_cb(const char *xpath, sr_val_t **values, size_t *values_cnt,
+                      uint64_t request_id, void *private_ctx)
+{
+    SRP_LOG_DBG("Requesting state data for '%s'", xpath);
+
+    *values = NULL;
+    *values_cnt = 0;
+
+    if (sr_xpath_node_name_eq(xpath, "interface")) {
+        return sc_telemetry_interface_state(values, values_cnt);
+    }
+
+    if (sr_xpath_node_name_eq(xpath, "stat")) {
+        return sc_telemetry_runtime_state(xpath, "stat", values, values_cnt);
+    }
+
+    if (sr_xpath_node_name_eq(xpath, "node")) {
+        return sc_telemetry_runtime_state(xpath, "node", values, values_cnt);
+    }
+
+    if (sr_xpath_node_name_eq(xpath, "thread")) {
+        return sc_telemetry_runtime_state(xpath, "thread", values, values_cnt);
+    }
+
+    if (sr_xpath_node_name_eq(xpath, "refresh")) {
+        return sc_telemetry_refresh_state(values, values_cnt);
+    }
+
+    if (sr_xpath_node_name_eq(xpath, "average")) {
+        return sc_telemetry_rates_state(xpath, true, values, values_cnt);
+    }
+
+    if (sr_xpath_node_name_eq(xpath, "rates")) {
+        return sc_telemetry_rates_state(xpath, false, values, values_cnt);
+    }
+
+    return SR_ERR_OK;
+}
+
+int
+sc_telemetry_subscribe_events(sr_session_ctx_t *session,
+                              sr_subscription_ctx_t **subscription)
+{
+    int rc = SR_ERR_OK;
+
+    SRP_LOG_DBG_MSG("Initializing telemetry plugin.");
+
+    /* the stats segment may come up after us, the sampler keeps retrying */
+    if (0 != sc_rates_start(NULL)) {
+        return SR_ERR_INTERNAL;
+    }
+    if (0 != sc_history_start(&g_history_config)) {
+        sc_telemetry_cleanup();
+        return SR_ERR_NOMEM;
+    }
+
+    rc = sr_subtree_change_subscribe(session, SC_TELEMETRY_RATES_XPATH,
+            sc_telemetry_rates_config_cb, NULL, 0, SR_SUBSCR_CTX_REUSE | SR_SUBSCR_EV_ENABLED, subscription);
+    if (SR_ERR_OK != rc) {
+        goto error;
+    }
+
+    rc = sr_subtree_change_subscribe(session, SC_TELEMETRY_HISTORY_XPATH,
+            sc_telemetry_history_config_cb, NULL, 0, SR_SUBSCR_CTX_REUSE | SR_SUBSCR_EV_ENABLED, subscription);
+    if (SR_ERR_OK != rc) {
+        goto error;
+    }
+
+    rc = sr_subtree_change_subscribe(session, SC_TELEMETRY_REFRESH_XPATH,
+            sc_telemetry_refresh_config_cb, NULL, 0, SR_SUBSCR_CTX_REUSE | SR_SUBSCR_EV_ENABLED, subscription);
+    if (SR_ERR_OK != rc) {
+        goto error;
+    }
+
+    rc = sr_rpc_subscribe(session, SC_TELEMETRY_HISTORY_RPC,
+            sc_telemetry_history_rpc_cb, NULL, SR_SUBSCR_CTX_REUSE, subscription);
+    if (SR_ERR_OK != rc) {
+        goto error;
+    }
+
+    rc = sr_dp_get_items_subscribe(session, SC_TELEMETRY_STATE_XPATH,
+            sc_telemetry_state_cb, NULL, SR_SUBSCR_CTX_REUSE, subscription);
+    if (SR_ERR_OK != rc) {
+        goto error;
+    }
+
+    SRP_LOG_INF_MSG("telemetry plugin initialized successfully.");
+
+    return SR_ERR_OK;
+
+error:
+    SRP_LOG_ERR_MSG("Error by initialization of the telemetry plugin.");
+    sc_telemetry_cleanup();
+    return rc;
+}
+
+void
+sc_telemetry_cleanup()
+{
+    sc_history_stop();
+    sc_rates_stop();
+}
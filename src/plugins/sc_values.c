@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "sc_values.h"
+
+int
+sc_vals_init(sc_vals_t *vals, size_t capacity_hint)
+{
+    vals->values = NULL;
+    vals->values_cnt = 0;
+    vals->values_cap = capacity_hint ? capacity_hint : 1;
+    vals->entry_len = 0;
+    vals->rc = sr_new_values(vals->values_cap, &vals->values);
+    if (SR_ERR_OK != vals->rc) {
+        vals->values_cap = 0;
+    }
+
+    return vals->rc;
+}
+
+void
+sc_vals_free(sc_vals_t *vals)
+{
+    if (NULL != vals->values) {
+        sr_free_values(vals->values, vals->values_cap);
+    }
+    vals->values = NULL;
+    vals->values_cnt = vals->values_cap = 0;
+}
+
+static sr_val_t *
+sc_vals_push(sc_vals_t *vals, const char *xpath)
+{
+    sr_val_t *val = NULL;
+
+    if (vals->values_cnt == vals->values_cap) {
+        size_t cap = vals->values_cap ? vals->values_cap * 2 : 8;
+        vals->rc = sr_realloc_values(vals->values_cap, cap, &vals->values);
+        if (SR_ERR_OK != vals->rc) {
+            return NULL;
+        }
+        vals->values_cap = cap;
+    }
+
+    /* the only copy of the xpath goes into the values context */
+    val = &vals->values[vals->values_cnt];
+    vals->rc = sr_val_set_xpath(val, xpath);
+    if (SR_ERR_OK != vals->rc) {
+        return NULL;
+    }
+    vals->values_cnt++;
+
+    return val;
+}
+
+static sr_val_t *
+sc_vals_add_va(sc_vals_t *vals, const char *xpath_fmt, va_list args)
+{
+    char xpath[SC_VALS_XPATH_LEN];
+    int len;
+
+    if (SR_ERR_OK != vals->rc) {
+        return NULL;
+    }
+
+    len = vsnprintf(xpath, sizeof(xpath), xpath_fmt, args);
+    if (len < 0 || len >= (int)sizeof(xpath)) {
+        vals->rc = SR_ERR_INVAL_ARG;
+        return NULL;
+    }
+
+    return sc_vals_push(vals, xpath);
+}
+
+sr_val_t *
+sc_vals_add(sc_vals_t *vals, const char *xpath_fmt, ...)
+{
+    sr_val_t *val;
+    va_list args;
+
+    va_start(args, xpath_fmt);
+    val = sc_vals_add_va(vals, xpath_fmt, args);
+    va_end(args);
+
+    return val;
+}
+
+int
+sc_vals_add_str(sc_vals_t *vals, sr_type_t type, const char *str,
+                const char *xpath_fmt, ...)
+{
+    sr_val_t *val;
+    va_list args;
+
+    va_start(args, xpath_fmt);
+    val = sc_vals_add_va(vals, xpath_fmt, args);
+    va_end(args);
+
+    if (NULL != val) {
+        vals->rc = sr_val_set_str_data(val, type, str);
+    }
+
+    return vals->rc;
+}
+
+int
+sc_vals_entry(sc_vals_t *vals, const char *xpath_fmt, ...)
+{
+    va_list args;
+    int len;
+
+    if (SR_ERR_OK != vals->rc) {
+        return vals->rc;
+    }
+
+    va_start(args, xpath_fmt);
+    len = vsnprintf(vals->entry, sizeof(vals->entry), xpath_fmt, args);
+    va_end(args);
+
+    if (len < 0 || len >= (int)sizeof(vals->entry)) {
+        vals->entry_len = 0;
+        vals->rc = SR_ERR_INVAL_ARG;
+        return vals->rc;
+    }
+    vals->entry_len = len;
+
+    return SR_ERR_OK;
+}
+
+sr_val_t *
+sc_vals_leaf(sc_vals_t *vals, const char *leaf)
+{
+    size_t leaf_len = strlen(leaf);
+    sr_val_t *val = NULL;
+
+    if (SR_ERR_OK != vals->rc) {
+        return NULL;
+    }
+
+    /* leaf names are appended in place after the entry prefix */
+    if (vals->entry_len + 1 + leaf_len >= sizeof(vals->entry)) {
+        vals->rc = SR_ERR_INVAL_ARG;
+        return NULL;
+    }
+    vals->entry[vals->entry_len] = '/';
+    memcpy(&vals->entry[vals->entry_len + 1], leaf, leaf_len + 1);
+
+    val = sc_vals_push(vals, vals->entry);
+    vals->entry[vals->entry_len] = '\0';
+
+    return val;
+}
+
+int
+sc_vals_leaf_str(sc_vals_t *vals, const char *leaf, sr_type_t type,
+                 const char *str)
+{
+    sr_val_t *val = sc_vals_leaf(vals, leaf);
+
+    if (NULL != val) {
+        vals->rc = sr_val_set_str_data(val, type, str);
+    }
+
+    return vals->rc;
+}
+
+int
+sc_vals_finish(sc_vals_t *vals, sr_val_t **values, size_t *values_cnt)
+{
+    int rc = vals->rc;
+
+    if (SR_ERR_OK != rc || 0 == vals->values_cnt) {
+        sc_vals_free(vals);
+        *values = NULL;
+        *values_cnt = 0;
+        return rc;
+    }
+
+    *values = vals->values;
+    *values_cnt = vals->values_cnt;
+    vals->values = NULL;
+    vals->values_cnt = vals->values_cap = 0;
+
+    return SR_ERR_OK;
+}
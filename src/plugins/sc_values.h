@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SC_VALUES_H
+#define SC_VALUES_H
+
+#include <sysrepo.h>
+#include <sysrepo/values.h>
+
+#define SC_VALS_XPATH_LEN 1024
+
+/**
+ * @brief Per-request builder of the sr_val_t array returned to sysrepo.
+ *
+ * The whole response lives in a single sr_new_values() array. sysrepo keeps
+ * that array, the xpaths and the string data set through sr_val_* in one
+ * memory context, so a response costs a few block allocations instead of
+ * two mallocs per leaf, and sysrepo releases it as a whole with
+ * sr_free_values(). The array grows in place with sr_realloc_values(),
+ * which keeps the same context.
+ */
+typedef struct _sc_vals
+{
+    sr_val_t *values;
+    size_t values_cnt;
+    size_t values_cap;
+    int rc;                     /* first error hit while building */
+    char entry[SC_VALS_XPATH_LEN];  /* xpath of the current list entry */
+    size_t entry_len;
+} sc_vals_t;
+
+int sc_vals_init(sc_vals_t *vals, size_t capacity_hint);
+void sc_vals_free(sc_vals_t *vals);
+
+/**
+ * @brief Append a value with the given xpath, NULL on failure (vals->rc is set).
+ */
+sr_val_t *sc_vals_add(sc_vals_t *vals, const char *xpath_fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief Append a string-typed value (string, enum, identityref, ...).
+ */
+int sc_vals_add_str(sc_vals_t *vals, sr_type_t type, const char *str,
+                    const char *xpath_fmt, ...)
+    __attribute__((format(printf, 4, 5)));
+
+/**
+ * @brief Start a list entry (or container), its xpath is formatted only once.
+ *
+ * sysrepo 0.7 data providers can only return sr_val_t arrays, so the leaves
+ * still carry their full xpath. The entry prefix is kept here and leaves
+ * added with sc_vals_leaf() only append their name to it.
+ */
+int sc_vals_entry(sc_vals_t *vals, const char *xpath_fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief Append the leaf of the current entry, NULL on failure (vals->rc is set).
+ */
+sr_val_t *sc_vals_leaf(sc_vals_t *vals, const char *leaf);
+
+/**
+ * @brief Append a string-typed leaf of the current entry.
+ */
+int sc_vals_leaf_str(sc_vals_t *vals, const char *leaf, sr_type_t type,
+                     const char *str);
+
+/**
+ * @brief Hand the built values over to sysrepo, or free them on error.
+ */
+int sc_vals_finish(sc_vals_t *vals, sr_val_t **values, size_t *values_cnt);
+
+#endif /* SC_VALUES_H */
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arpa/inet.h>
+
+#include "sc_batch.h"
+#include "sc_vpp_operation.h"
+
+/* reply of a batched request, in network order */
+typedef struct __attribute__((packed))
+{
+	vapi_type_msg_header1_t header;
+	i32 retval;
+} sc_batch_reply_t;
+
+/* contexts of the requests, a late reply of a broken batch matches no other */
+static uint32_t g_batch_context = 0;
+
+int sc_batch_connect(const char *name, vapi_ctx_t *ctx)
+{
+	return sc_connect_vpp_queue(name, SC_BATCH_WINDOW, ctx);
+}
+
+int sc_batch_run(vapi_ctx_t ctx, uint32_t n, sc_batch_send_fn send, void *arg,
+		 sc_batch_result_t *results)
+{
+	const sc_batch_reply_t *reply = NULL;
+	uint32_t base, sent = 0, done = 0, i;
+	int failed = 0;
+	vapi_error_e rv;
+	size_t size;
+
+	for (i = 0; i < n; i++) {
+		results[i].rv = VAPI_ENORESP;
+		results[i].retval = 0;
+	}
+	base = __sync_fetch_and_add(&g_batch_context, n);
+
+	while (done < n) {
+		/* keep the window full */
+		while (sent < n && sent - done < SC_BATCH_WINDOW) {
+			rv = send(ctx, sent, base + sent, arg);
+			if (VAPI_OK != rv) {
+				SC_LOG_ERR("Unable to send request %u of a batch, rv=%d",
+					   sent, rv);
+				results[sent].rv = rv;
+				return -1;
+			}
+			sent++;
+		}
+
+		rv = vapi_recv(ctx, (void **)&reply, &size, SVM_Q_TIMEDWAIT,
+			       SC_BATCH_TIMEOUT_S);
+		if (VAPI_OK != rv) {
+			SC_LOG_ERR("No reply to %u requests of a batch, rv=%d",
+				   sent - done, rv);
+			return -1;
+		}
+
+		/* anything but a reply of this batch is dropped */
+		i = size >= sizeof(*reply) ? ntohl(reply->header.context) - base : n;
+		if (i < sent && VAPI_ENORESP == results[i].rv) {
+			results[i].rv = VAPI_OK;
+			results[i].retval = ntohl(reply->retval);
+			if (0 != results[i].retval)
+				failed++;
+			done++;
+		}
+		vapi_msg_free(ctx, (void *)reply);
+	}
+
+	return failed;
+}
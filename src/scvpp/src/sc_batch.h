@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __SWEETCOMB_BATCH__
+#define __SWEETCOMB_BATCH__
+
+#include <stdint.h>
+#include <vapi/vapi.h>
+
+/*
+ * Pipelined execution of VPP requests.
+ *
+ * Up to SC_BATCH_WINDOW requests are sent ahead of their replies, so a
+ * batch costs about one round trip per window instead of one per request.
+ * The replies are matched to the requests by their context. Only requests
+ * whose reply is the usual header followed by an i32 retval may be
+ * batched, the set and add_del requests for instance.
+ */
+
+/* requests in flight, the response queue of the connection holds them all */
+#define SC_BATCH_WINDOW 64
+/* longest wait for a reply before the connection is deemed broken */
+#define SC_BATCH_TIMEOUT_S 5
+
+/* Outcome of one request of a batch. */
+typedef struct
+{
+	vapi_error_e rv;	/* VAPI_ENORESP until the reply is received */
+	i32 retval;		/* retval of the reply */
+} sc_batch_result_t;
+
+/*
+ * Allocate request i of a batch on ctx, fill it in, set its header context
+ * to context, convert it to network order and send it.
+ */
+typedef vapi_error_e (*sc_batch_send_fn)(vapi_ctx_t ctx, uint32_t i,
+					 uint32_t context, void *arg);
+
+/*
+ * Connection a batch can run on, released with sc_disconnect_vpp_private().
+ * -1 on failure.
+ */
+int sc_batch_connect(const char *name, vapi_ctx_t *ctx);
+
+/*
+ * Run the n requests built by send in order, results[i] being the outcome
+ * of request i. Returns the number of requests that failed, or -1 when
+ * the connection broke and must be dropped, results then tell which
+ * requests got no reply.
+ */
+int sc_batch_run(vapi_ctx_t ctx, uint32_t n, sc_batch_send_fn send, void *arg,
+		 sc_batch_result_t *results);
+
+#endif //__SWEETCOMB_BATCH__
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "sc_name_index.h"
+
+#define SC_NAME_INDEX_MIN_SLOTS 16
+
+/* FNV-1a, 32 bits */
+static unsigned int name_hash(const char *name)
+{
+	unsigned int hash = 2166136261u;
+
+	while (*name != '\0')
+	{
+		hash ^= (unsigned char)*name++;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+/* Slot holding name, or the free slot ending its probe sequence. */
+static unsigned int *name_slot(const sc_name_index_t *index, const char *name)
+{
+	unsigned int mask = index->n_slots - 1;
+	unsigned int i = name_hash(name) & mask;
+
+	while (index->slots[i] != 0 &&
+	       strcmp(index->key(index->ctx, index->slots[i] - 1), name) != 0)
+		i = (i + 1) & mask;
+
+	return &index->slots[i];
+}
+
+static int name_index_grow(sc_name_index_t *index)
+{
+	unsigned int *old = index->slots;
+	unsigned int n_old = index->n_slots;
+	unsigned int n_slots = n_old ? n_old * 2 : SC_NAME_INDEX_MIN_SLOTS;
+	unsigned int *slots = calloc(n_slots, sizeof(*slots));
+	unsigned int i;
+
+	if (slots == NULL)
+		return -1;
+
+	index->slots = slots;
+	index->n_slots = n_slots;
+	for (i = 0; i < n_old; i++)
+	{
+		if (old[i] != 0)
+			*name_slot(index, index->key(index->ctx, old[i] - 1)) = old[i];
+	}
+	free(old);
+
+	return 0;
+}
+
+void sc_name_index_init(sc_name_index_t *index, sc_name_index_key_fn key,
+			const void *ctx)
+{
+	index->slots = NULL;
+	index->n_slots = 0;
+	index->count = 0;
+	index->key = key;
+	index->ctx = ctx;
+}
+
+void sc_name_index_reset(sc_name_index_t *index)
+{
+	if (index->slots != NULL)
+		memset(index->slots, 0, index->n_slots * sizeof(*index->slots));
+	index->count = 0;
+}
+
+void sc_name_index_free(sc_name_index_t *index)
+{
+	free(index->slots);
+	sc_name_index_init(index, index->key, index->ctx);
+}
+
+int sc_name_index_add(sc_name_index_t *index, unsigned int entry)
+{
+	unsigned int *slot;
+
+	if (2 * (index->count + 1) > index->n_slots && name_index_grow(index) != 0)
+		return -1;
+
+	/* a later entry of the same name replaces the earlier one */
+	slot = name_slot(index, index->key(index->ctx, entry));
+	if (*slot == 0)
+		index->count++;
+	*slot = entry + 1;
+
+	return 0;
+}
+
+int sc_name_index_find(const sc_name_index_t *index, const char *name)
+{
+	unsigned int slot;
+
+	if (index->count == 0)
+		return -1;
+
+	slot = *name_slot(index, name);
+	return (int)slot - 1;
+}
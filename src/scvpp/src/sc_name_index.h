@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __SWEETCOMB_NAME_INDEX__
+#define __SWEETCOMB_NAME_INDEX__
+
+/*
+ * Hash index of the entries of an array by name.
+ *
+ * The index stores positions in the array, not the entries, so the array
+ * may be reallocated while indexed. The name of an entry is read back
+ * through the key callback. Open addressing, kept at most half full.
+ * Not thread safe.
+ */
+
+/* Name of the entry at position entry of the array ctx. */
+typedef const char *(*sc_name_index_key_fn)(const void *ctx, unsigned int entry);
+
+typedef struct _sc_name_index
+{
+	unsigned int *slots;	/* position + 1, 0 when free */
+	unsigned int n_slots;	/* power of two, 0 until the first add */
+	unsigned int count;
+	sc_name_index_key_fn key;
+	const void *ctx;
+} sc_name_index_t;
+
+#define SC_NAME_INDEX_INIT(_key, _ctx) \
+	{ .slots = NULL, .n_slots = 0, .count = 0, .key = (_key), .ctx = (_ctx) }
+
+void sc_name_index_init(sc_name_index_t *index, sc_name_index_key_fn key,
+			const void *ctx);
+/* Forget the entries, keeps the slots for the next ones. */
+void sc_name_index_reset(sc_name_index_t *index);
+void sc_name_index_free(sc_name_index_t *index);
+
+/* Index the entry under its current name, -1 on no memory. */
+int sc_name_index_add(sc_name_index_t *index, unsigned int entry);
+/* Position of the last entry added with the name, -1 if none. */
+int sc_name_index_find(const sc_name_index_t *index, const char *name);
+
+#endif //__SWEETCOMB_NAME_INDEX__
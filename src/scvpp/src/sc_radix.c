@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "sc_radix.h"
+
+/* a node stands for the prefix key/len, children continue with bit len */
+struct _sc_radix_node
+{
+	uint8_t key[SC_RADIX_KEY_LEN];
+	uint8_t len;
+	bool has_value;
+	void *value;
+	sc_radix_node_t *child[2];
+};
+
+static inline int key_bit(const uint8_t *key, unsigned int bit)
+{
+	return (key[bit >> 3] >> (7 - (bit & 7))) & 1;
+}
+
+/* number of leading bits key a and b have in common, at most max */
+static unsigned int common_bits(const uint8_t *a, const uint8_t *b,
+				unsigned int max)
+{
+	unsigned int i = 0;
+
+	while (i + 8 <= max && a[i >> 3] == b[i >> 3])
+		i += 8;
+	while (i < max && key_bit(a, i) == key_bit(b, i))
+		i++;
+
+	return i;
+}
+
+static sc_radix_node_t *node_new(const uint8_t *key, uint8_t len)
+{
+	sc_radix_node_t *node = calloc(1, sizeof(*node));
+	unsigned int i;
+
+	if (node == NULL)
+		return NULL;
+
+	/* keep only the prefix bits so that equal prefixes compare equal */
+	for (i = 0; i < (unsigned int)(len + 7) / 8; i++)
+		node->key[i] = key[i];
+	if (len & 7)
+		node->key[len >> 3] &= (uint8_t)(0xff << (8 - (len & 7)));
+	node->len = len;
+
+	return node;
+}
+
+void sc_radix_init(sc_radix_t *radix)
+{
+	radix->root = NULL;
+	radix->count = 0;
+}
+
+static void node_free(sc_radix_node_t *node, void (*free_value)(void *value))
+{
+	if (node == NULL)
+		return;
+
+	node_free(node->child[0], free_value);
+	node_free(node->child[1], free_value);
+	if (node->has_value && free_value != NULL)
+		free_value(node->value);
+	free(node);
+}
+
+void sc_radix_clear(sc_radix_t *radix, void (*free_value)(void *value))
+{
+	node_free(radix->root, free_value);
+	sc_radix_init(radix);
+}
+
+int sc_radix_insert(sc_radix_t *radix, const uint8_t *key, uint8_t len,
+		    void *value, void **replaced)
+{
+	sc_radix_node_t **link;
+	sc_radix_node_t *node, *split, *leaf;
+	unsigned int common;
+
+	if (replaced != NULL)
+		*replaced = NULL;
+
+	if (radix->root == NULL && (radix->root = node_new(key, 0)) == NULL)
+		return -1;
+
+	node = radix->root;
+	while (node->len < len)
+	{
+		link = &node->child[key_bit(key, node->len)];
+		if (*link == NULL)
+		{
+			if ((leaf = node_new(key, len)) == NULL)
+				return -1;
+			*link = leaf;
+			node = leaf;
+			break;
+		}
+
+		common = common_bits((*link)->key, key,
+				     (*link)->len < len ? (*link)->len : len);
+		if (common == (*link)->len)
+		{
+			node = *link;
+			continue;
+		}
+
+		/* key leaves the compressed path of the child, split it */
+		if ((split = node_new(key, common)) == NULL)
+			return -1;
+		split->child[key_bit((*link)->key, common)] = *link;
+		if (common < len)
+		{
+			if ((leaf = node_new(key, len)) == NULL)
+			{
+				free(split);
+				return -1;
+			}
+			split->child[key_bit(key, common)] = leaf;
+			*link = split;
+			node = leaf;
+		}
+		else
+		{
+			*link = split;
+			node = split;
+		}
+		break;
+	}
+
+	if (node->has_value)
+	{
+		if (replaced != NULL)
+			*replaced = node->value;
+	}
+	else
+	{
+		radix->count++;
+	}
+	node->has_value = true;
+	node->value = value;
+
+	return 0;
+}
+
+void *sc_radix_remove(sc_radix_t *radix, const uint8_t *key, uint8_t len)
+{
+	sc_radix_node_t **link = &radix->root, **parent_link = NULL;
+	sc_radix_node_t *node, *parent;
+	void *value;
+
+	while (*link != NULL && (*link)->len < len)
+	{
+		if (common_bits((*link)->key, key, (*link)->len) != (*link)->len)
+			return NULL;
+		parent_link = link;
+		link = &(*link)->child[key_bit(key, (*link)->len)];
+	}
+
+	node = *link;
+	if (node == NULL || node->len != len ||
+	    common_bits(node->key, key, len) != len || !node->has_value)
+		return NULL;
+
+	value = node->value;
+	node->has_value = false;
+	node->value = NULL;
+	radix->count--;
+
+	if (node == radix->root)
+		return value;
+
+	/* drop the node if it no longer branches, then its parent likewise */
+	if (node->child[0] == NULL || node->child[1] == NULL)
+	{
+		*link = node->child[0] != NULL ? node->child[0] : node->child[1];
+		free(node);
+
+		parent = *parent_link;
+		if (parent != radix->root && !parent->has_value &&
+		    (parent->child[0] == NULL || parent->child[1] == NULL))
+		{
+			*parent_link = parent->child[0] != NULL ?
+				parent->child[0] : parent->child[1];
+			free(parent);
+		}
+	}
+
+	return value;
+}
+
+void *sc_radix_exact(const sc_radix_t *radix, const uint8_t *key, uint8_t len)
+{
+	const sc_radix_node_t *node = radix->root;
+
+	while (node != NULL && node->len < len)
+		node = node->child[key_bit(key, node->len)];
+
+	if (node == NULL || node->len != len || !node->has_value ||
+	    common_bits(node->key, key, len) != len)
+		return NULL;
+
+	return node->value;
+}
+
+void *sc_radix_longest(const sc_radix_t *radix, const uint8_t *key, uint8_t len,
+		       uint8_t *matched)
+{
+	const sc_radix_node_t *node = radix->root;
+	const sc_radix_node_t *best = NULL;
+
+	while (node != NULL && node->len <= len &&
+	       common_bits(node->key, key, node->len) == node->len)
+	{
+		if (node->has_value)
+			best = node;
+		if (node->len == len)
+			break;
+		node = node->child[key_bit(key, node->len)];
+	}
+
+	if (best == NULL)
+		return NULL;
+	if (matched != NULL)
+		*matched = best->len;
+
+	return best->value;
+}
+
+static int node_walk(const sc_radix_node_t *node,
+		     int (*fn)(const uint8_t *key, uint8_t len, void *value, void *ctx),
+		     void *ctx)
+{
+	int rc;
+
+	if (node == NULL)
+		return 0;
+	if (node->has_value && (rc = fn(node->key, node->len, node->value, ctx)) != 0)
+		return rc;
+	if ((rc = node_walk(node->child[0], fn, ctx)) != 0)
+		return rc;
+
+	return node_walk(node->child[1], fn, ctx);
+}
+
+int sc_radix_walk(const sc_radix_t *radix,
+		  int (*fn)(const uint8_t *key, uint8_t len, void *value, void *ctx),
+		  void *ctx)
+{
+	return node_walk(radix->root, fn, ctx);
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __SWEETCOMB_RADIX__
+#define __SWEETCOMB_RADIX__
+
+#include <stdint.h>
+
+/*
+ * Path-compressed binary (Patricia) trie of IP prefixes.
+ *
+ * Keys are up to 128 bits in network byte order, the key length is the
+ * prefix length in bits. Lookups walk at most one node per distinct
+ * prefix length on the way, independently of the number of prefixes.
+ * The trie does not own the values and is not thread safe.
+ */
+
+#define SC_RADIX_KEY_LEN 16
+
+typedef struct _sc_radix_node sc_radix_node_t;
+
+typedef struct _sc_radix
+{
+	sc_radix_node_t *root;
+	unsigned int count;
+} sc_radix_t;
+
+void sc_radix_init(sc_radix_t *radix);
+/* Frees the nodes, calls free_value (if not NULL) on every value. */
+void sc_radix_clear(sc_radix_t *radix, void (*free_value)(void *value));
+
+/* Insert or replace, returns the replaced value or NULL. -1 on no memory. */
+int sc_radix_insert(sc_radix_t *radix, const uint8_t *key, uint8_t len,
+		    void *value, void **replaced);
+/* Remove the exact prefix, returns its value or NULL. */
+void *sc_radix_remove(sc_radix_t *radix, const uint8_t *key, uint8_t len);
+
+/* Value of the exact prefix or NULL. */
+void *sc_radix_exact(const sc_radix_t *radix, const uint8_t *key, uint8_t len);
+/* Value of the longest prefix covering key/len or NULL, its length into *matched. */
+void *sc_radix_longest(const sc_radix_t *radix, const uint8_t *key, uint8_t len,
+		       uint8_t *matched);
+
+/* Visit every value, stops at the first non-zero return of fn. */
+int sc_radix_walk(const sc_radix_t *radix,
+		  int (*fn)(const uint8_t *key, uint8_t len, void *value, void *ctx),
+		  void *ctx);
+
+#endif //__SWEETCOMB_RADIX__
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "sc_refresh.h"
+
+void sc_refresh_init(sc_refresh_t *r, uint32_t min_ms, uint32_t max_ms,
+		     uint64_t now_ms)
+{
+	memset(r, 0, sizeof(*r));
+	sc_refresh_bounds(r, min_ms, max_ms);
+	r->interval_ms = r->min_ms;
+	r->last_ms = now_ms;
+	r->next_ms = now_ms;
+}
+
+void sc_refresh_bounds(sc_refresh_t *r, uint32_t min_ms, uint32_t max_ms)
+{
+	r->min_ms = min_ms ? min_ms : 1;
+	r->max_ms = max_ms > r->min_ms ? max_ms : r->min_ms;
+
+	if (r->interval_ms < r->min_ms)
+		r->interval_ms = r->min_ms;
+	if (r->interval_ms > r->max_ms)
+		r->interval_ms = r->max_ms;
+	if (r->next_ms > r->last_ms + r->interval_ms)
+		r->next_ms = r->last_ms + r->interval_ms;
+}
+
+bool sc_refresh_due(const sc_refresh_t *r, uint64_t now_ms)
+{
+	return now_ms >= r->next_ms;
+}
+
+void sc_refresh_done(sc_refresh_t *r, uint64_t now_ms, bool changed)
+{
+	uint64_t interval = r->interval_ms;
+
+	r->refreshes++;
+	if (changed) {
+		r->changes++;
+		interval /= 2;
+	} else {
+		interval += interval / 4 ? interval / 4 : 1;
+	}
+
+	if (interval < r->min_ms)
+		interval = r->min_ms;
+	if (interval > r->max_ms)
+		interval = r->max_ms;
+	r->interval_ms = interval;
+	r->last_ms = now_ms;
+	r->next_ms = now_ms + interval;
+}
+
+void sc_refresh_soon(sc_refresh_t *r, uint64_t now_ms)
+{
+	uint64_t next = r->last_ms + r->min_ms;
+
+	if (next < now_ms)
+		next = now_ms;
+	if (next < r->next_ms)
+		r->next_ms = next;
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __SWEETCOMB_REFRESH__
+#define __SWEETCOMB_REFRESH__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Adaptive refresh period of a class of data.
+ *
+ * The period is halved by every refresh that found a change and grows by
+ * a quarter with every refresh that found none, within [min_ms, max_ms].
+ * Volatile data is then refreshed at min_ms while data that never changes
+ * settles at max_ms after a couple of minutes. Times are CLOCK_MONOTONIC
+ * milliseconds, the caller serializes the calls.
+ */
+typedef struct
+{
+	uint32_t min_ms;
+	uint32_t max_ms;
+	uint32_t interval_ms;	/* current period */
+	uint64_t last_ms;	/* time of the last refresh */
+	uint64_t next_ms;	/* time of the next refresh */
+	uint64_t refreshes;
+	uint64_t changes;	/* refreshes that found a change */
+} sc_refresh_t;
+
+/* Start at min_ms, the first refresh is due right away. */
+void sc_refresh_init(sc_refresh_t *r, uint32_t min_ms, uint32_t max_ms,
+		     uint64_t now_ms);
+/* Change the bounds, max_ms is raised to min_ms if lower. */
+void sc_refresh_bounds(sc_refresh_t *r, uint32_t min_ms, uint32_t max_ms);
+
+bool sc_refresh_due(const sc_refresh_t *r, uint64_t now_ms);
+
+/* Record a refresh and schedule the next one. */
+void sc_refresh_done(sc_refresh_t *r, uint64_t now_ms, bool changed);
+/*
+ * Bring the next refresh forward, the data is known to have changed. It
+ * stays at least min_ms after the last one, so a burst of hints costs one
+ * refresh per min_ms.
+ */
+void sc_refresh_soon(sc_refresh_t *r, uint64_t now_ms);
+
+#endif //__SWEETCOMB_REFRESH__
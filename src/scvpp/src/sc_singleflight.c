@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "sc_singleflight.h"
+
+struct _sc_singleflight_call
+{
+	char *key;
+	bool done;
+	int rc;
+	void *result;
+	sc_singleflight_free_fn free_fn;
+	unsigned int refcnt;
+	pthread_cond_t cond;
+	struct _sc_singleflight_call *next;
+};
+
+/* calls currently in flight, a finished call is unlinked before waking up waiters */
+static sc_singleflight_call_t *g_inflight = NULL;
+static pthread_mutex_t g_inflight_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static sc_singleflight_call_t *inflight_find(const char *key)
+{
+	sc_singleflight_call_t *call = g_inflight;
+
+	while (call != NULL && strcmp(call->key, key) != 0)
+		call = call->next;
+
+	return call;
+}
+
+static void inflight_unlink(sc_singleflight_call_t *call)
+{
+	sc_singleflight_call_t **pp = &g_inflight;
+
+	while (*pp != NULL && *pp != call)
+		pp = &(*pp)->next;
+	if (*pp != NULL)
+		*pp = call->next;
+	call->next = NULL;
+}
+
+int sc_singleflight_do(const char *key, sc_singleflight_fn fn, void *arg,
+		       sc_singleflight_free_fn free_fn,
+		       sc_singleflight_call_t **call)
+{
+	sc_singleflight_call_t *c = NULL;
+	void *result = NULL;
+	int rc;
+
+	if (key == NULL || fn == NULL || call == NULL)
+		return -1;
+
+	pthread_mutex_lock(&g_inflight_lock);
+	c = inflight_find(key);
+	if (c != NULL)
+	{
+		/* identical request in flight, wait for it and share its result */
+		c->refcnt++;
+		while (!c->done)
+			pthread_cond_wait(&c->cond, &g_inflight_lock);
+		pthread_mutex_unlock(&g_inflight_lock);
+		*call = c;
+		return c->rc;
+	}
+
+	c = calloc(1, sizeof(*c));
+	if (c == NULL || (c->key = strdup(key)) == NULL)
+	{
+		pthread_mutex_unlock(&g_inflight_lock);
+		free(c);
+		*call = NULL;
+		return -1;
+	}
+	c->free_fn = free_fn;
+	c->refcnt = 1;
+	pthread_cond_init(&c->cond, NULL);
+	c->next = g_inflight;
+	g_inflight = c;
+	pthread_mutex_unlock(&g_inflight_lock);
+
+	rc = fn(arg, &result);
+
+	pthread_mutex_lock(&g_inflight_lock);
+	c->rc = rc;
+	c->result = result;
+	c->done = true;
+	inflight_unlink(c);
+	pthread_cond_broadcast(&c->cond);
+	pthread_mutex_unlock(&g_inflight_lock);
+
+	*call = c;
+	return rc;
+}
+
+void *sc_singleflight_result(sc_singleflight_call_t *call)
+{
+	return call != NULL ? call->result : NULL;
+}
+
+void *sc_singleflight_steal(sc_singleflight_call_t *call)
+{
+	void *result = NULL;
+
+	if (call == NULL)
+		return NULL;
+
+	/* a finished call is unlinked, so its refcnt can only go down */
+	pthread_mutex_lock(&g_inflight_lock);
+	if (call->done && call->refcnt == 1)
+	{
+		result = call->result;
+		call->result = NULL;
+	}
+	pthread_mutex_unlock(&g_inflight_lock);
+
+	return result;
+}
+
+unsigned int sc_singleflight_callers(const char *key)
+{
+	sc_singleflight_call_t *c = NULL;
+	unsigned int callers = 0;
+
+	pthread_mutex_lock(&g_inflight_lock);
+	c = inflight_find(key);
+	if (c != NULL)
+		callers = c->refcnt;
+	pthread_mutex_unlock(&g_inflight_lock);
+
+	return callers;
+}
+
+void sc_singleflight_release(sc_singleflight_call_t *call)
+{
+	bool last;
+
+	if (call == NULL)
+		return;
+
+	pthread_mutex_lock(&g_inflight_lock);
+	last = (--call->refcnt == 0);
+	pthread_mutex_unlock(&g_inflight_lock);
+
+	if (!last)
+		return;
+
+	if (call->free_fn != NULL && call->result != NULL)
+		call->free_fn(call->result);
+	pthread_cond_destroy(&call->cond);
+	free(call->key);
+	free(call);
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __SWEETCOMB_SINGLEFLIGHT__
+#define __SWEETCOMB_SINGLEFLIGHT__
+
+/*
+ * Single-flight coalescing of identical VPP requests.
+ *
+ * The first caller of sc_singleflight_do() for a given key runs the request,
+ * callers arriving with the same key while it is in flight block and share
+ * its result instead of sending their own copy to VPP. The result is
+ * reference counted: every caller gets a handle and must release it with
+ * sc_singleflight_release(), the last release frees the result.
+ */
+
+/* Runs the request for the key, stores what it produced into *result. */
+typedef int (*sc_singleflight_fn)(void *arg, void **result);
+/* Frees a result produced by sc_singleflight_fn. */
+typedef void (*sc_singleflight_free_fn)(void *result);
+
+typedef struct _sc_singleflight_call sc_singleflight_call_t;
+
+/*
+ * Run fn(arg) under key, or wait for the identical in-flight call.
+ * Returns what fn returned for the call that was actually executed and
+ * stores the shared call handle into *call (also on failure).
+ */
+int sc_singleflight_do(const char *key, sc_singleflight_fn fn, void *arg,
+		       sc_singleflight_free_fn free_fn,
+		       sc_singleflight_call_t **call);
+
+/* Result of a finished call, shared read-only by all its callers. */
+void *sc_singleflight_result(sc_singleflight_call_t *call);
+
+/*
+ * Take over the result when the caller holds the only reference, so the
+ * uncontended case needs no copy. Returns NULL while the result is shared,
+ * the caller must then copy what it needs from sc_singleflight_result().
+ */
+void *sc_singleflight_steal(sc_singleflight_call_t *call);
+
+/*
+ * Number of callers sharing the call of key in flight, its runner included,
+ * 0 when none is in flight.
+ */
+unsigned int sc_singleflight_callers(const char *key);
+
+/* Drop the reference held by the caller, frees the result on last release. */
+void sc_singleflight_release(sc_singleflight_call_t *call);
+
+#endif //__SWEETCOMB_SINGLEFLIGHT__
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdlib.h>
+#include <time.h>
+
+#include "sc_snapshot.h"
+#include "sc_singleflight.h"
+
+struct _sc_snapshot_ref
+{
+	unsigned int refcnt;
+	uint64_t loaded_ms;
+	sc_snapshot_free_fn free;
+	void *data;
+};
+
+static uint64_t now_ms()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static sc_snapshot_ref_t *ref_get(sc_snapshot_ref_t *ref)
+{
+	__sync_fetch_and_add(&ref->refcnt, 1);
+	return ref;
+}
+
+void sc_snapshot_release(sc_snapshot_ref_t *ref)
+{
+	if (ref == NULL || __sync_sub_and_fetch(&ref->refcnt, 1) != 0)
+		return;
+
+	if (ref->free != NULL && ref->data != NULL)
+		ref->free(ref->data);
+	free(ref);
+}
+
+static int snapshot_load(void *arg, void **result)
+{
+	sc_snapshot_t *snap = arg;
+	sc_snapshot_ref_t *ref = calloc(1, sizeof(*ref));
+	int rc;
+
+	if (ref == NULL)
+		return -1;
+	ref->refcnt = 1;	/* owned by the single-flight call */
+	ref->free = snap->free;
+	*result = ref;
+
+	rc = snap->load(&ref->data);
+	ref->loaded_ms = now_ms();
+
+	return rc;
+}
+
+static void snapshot_load_free(void *result)
+{
+	sc_snapshot_release(result);
+}
+
+sc_snapshot_ref_t *sc_snapshot_acquire(sc_snapshot_t *snap)
+{
+	sc_singleflight_call_t *call = NULL;
+	sc_snapshot_ref_t *ref = NULL;
+
+	pthread_mutex_lock(&snap->lock);
+	if (snap->current != NULL &&
+	    now_ms() - snap->current->loaded_ms < snap->ttl_ms)
+		ref = ref_get(snap->current);
+	pthread_mutex_unlock(&snap->lock);
+
+	if (ref != NULL)
+		return ref;
+
+	if (0 == sc_singleflight_do(snap->key, snapshot_load, snap,
+				    snapshot_load_free, &call))
+	{
+		ref = ref_get(sc_singleflight_result(call));
+
+		pthread_mutex_lock(&snap->lock);
+		if (snap->current == NULL ||
+		    snap->current->loaded_ms <= ref->loaded_ms)
+		{
+			if (snap->current != ref)
+			{
+				sc_snapshot_release(snap->current);
+				snap->current = ref_get(ref);
+			}
+		}
+		pthread_mutex_unlock(&snap->lock);
+	}
+	sc_singleflight_release(call);
+
+	return ref;
+}
+
+void *sc_snapshot_data(sc_snapshot_ref_t *ref)
+{
+	return ref != NULL ? ref->data : NULL;
+}
+
+uint64_t sc_snapshot_age_ms(sc_snapshot_ref_t *ref)
+{
+	return ref != NULL ? now_ms() - ref->loaded_ms : 0;
+}
+
+void sc_snapshot_invalidate(sc_snapshot_t *snap)
+{
+	sc_snapshot_ref_t *ref;
+
+	pthread_mutex_lock(&snap->lock);
+	ref = snap->current;
+	snap->current = NULL;
+	pthread_mutex_unlock(&snap->lock);
+
+	sc_snapshot_release(ref);
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __SWEETCOMB_SNAPSHOT__
+#define __SWEETCOMB_SNAPSHOT__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+
+/*
+ * Read-only snapshot of VPP state reused for a short window.
+ *
+ * The first reader after the window expired reloads the snapshot, readers
+ * arriving meanwhile share that single load (see sc_singleflight.h). A
+ * snapshot stays valid for its readers until they release it, even when
+ * a newer one was loaded in between.
+ */
+
+/* Loads the snapshot data, stores it into *data. */
+typedef int (*sc_snapshot_load_fn)(void **data);
+/* Frees data produced by sc_snapshot_load_fn. */
+typedef void (*sc_snapshot_free_fn)(void *data);
+
+typedef struct _sc_snapshot_ref sc_snapshot_ref_t;
+
+typedef struct _sc_snapshot
+{
+	const char *key;		/* single-flight key of the load */
+	sc_snapshot_load_fn load;
+	sc_snapshot_free_fn free;
+	uint64_t ttl_ms;		/* how long a loaded snapshot is reused */
+	pthread_mutex_t lock;
+	sc_snapshot_ref_t *current;
+} sc_snapshot_t;
+
+#define SC_SNAPSHOT_INIT(_key, _load, _free, _ttl_ms) \
+	{ .key = (_key), .load = (_load), .free = (_free), .ttl_ms = (_ttl_ms), \
+	  .lock = PTHREAD_MUTEX_INITIALIZER, .current = NULL }
+
+/*
+ * Current snapshot, loaded when missing or older than ttl_ms.
+ * Returns NULL when the load failed, otherwise the reference must be
+ * released with sc_snapshot_release().
+ */
+sc_snapshot_ref_t *sc_snapshot_acquire(sc_snapshot_t *snap);
+
+/* Data of an acquired snapshot, shared read-only by all its readers. */
+void *sc_snapshot_data(sc_snapshot_ref_t *ref);
+
+/* Milliseconds since the snapshot was loaded. */
+uint64_t sc_snapshot_age_ms(sc_snapshot_ref_t *ref);
+
+void sc_snapshot_release(sc_snapshot_ref_t *ref);
+
+/* Drop the current snapshot, the next sc_snapshot_acquire() reloads it. */
+void sc_snapshot_invalidate(sc_snapshot_t *snap);
+
+#endif //__SWEETCOMB_SNAPSHOT__
@@ -0,0 +1,486 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "sc_vpp_fib.h"
+#include "sc_radix.h"
+#include "sc_singleflight.h"
+
+#include <vapi/ip.api.vapi.h>
+DEFINE_VAPI_MSG_IDS_IP_API_JSON;
+
+#define SC_FIB_DUMP_KEY "ip_fib_dump"
+#define SC_FIB_INIT_CAPACITY 64
+/* one dump serves all route state reads of a request */
+#define SC_FIB_REFRESH_MS 1000
+
+/* Result of ip_fib_dump and ip6_fib_dump before it is merged into the cache. */
+typedef struct
+{
+	sc_fib_route_t *entries;
+	size_t n_entries;
+	size_t entries_cap;
+	sc_fib_path_t *paths;
+	size_t n_paths;
+	size_t paths_cap;
+} sc_fib_dump_t;
+
+/*
+ * Routes of one address family. The trie maps a prefix to its position in
+ * the array plus one, so that a route is never NULL.
+ */
+typedef struct
+{
+	sc_radix_t index;
+	sc_fib_route_t *routes;
+	size_t n_routes;
+	size_t routes_cap;
+} sc_fib_table_t;
+
+static struct
+{
+	pthread_rwlock_t lock;
+	sc_fib_table_t tables[2];	/* indexed by is_ipv6 */
+	u32 generation;
+	u64 refreshed_ms;	/* 0 forces a refresh */
+	u64 dumped_ms;		/* last dump merged, 0 if none */
+} g_fib = { .lock = PTHREAD_RWLOCK_INITIALIZER };
+
+static u64 now_ms()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u64)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int fib_dump_reserve(sc_fib_dump_t *dump, u32 n_paths)
+{
+	if (dump->n_entries == dump->entries_cap)
+	{
+		size_t cap = dump->entries_cap ? dump->entries_cap * 2 : SC_FIB_INIT_CAPACITY;
+		sc_fib_route_t *entries = realloc(dump->entries, cap * sizeof(*entries));
+		if (entries == NULL)
+			return -1;
+		dump->entries = entries;
+		dump->entries_cap = cap;
+	}
+
+	if (dump->n_paths + n_paths > dump->paths_cap)
+	{
+		size_t cap = dump->paths_cap ? dump->paths_cap : SC_FIB_INIT_CAPACITY;
+		while (cap < dump->n_paths + n_paths)
+			cap *= 2;
+		sc_fib_path_t *paths = realloc(dump->paths, cap * sizeof(*paths));
+		if (paths == NULL)
+			return -1;
+		dump->paths = paths;
+		dump->paths_cap = cap;
+	}
+
+	return 0;
+}
+
+/* common part of the ip_fib_details and ip6_fib_details callbacks */
+static int fib_dump_add(sc_fib_dump_t *dump, bool is_ipv6, u32 table_id,
+			u8 address_length, const u8 *address, u32 count,
+			const vapi_type_fib_path *fib_paths)
+{
+	sc_fib_route_t *entry;
+	u32 i;
+
+	if (fib_dump_reserve(dump, count) != 0)
+	{
+		SC_LOG_ERR_MSG("Out of memory while dumping FIB");
+		return -1;
+	}
+
+	/* paths are stored by offset until the dump is complete */
+	entry = &dump->entries[dump->n_entries++];
+	memset(entry, 0, sizeof(*entry));
+	entry->table_id = table_id;
+	entry->is_ipv6 = is_ipv6;
+	entry->address_length = address_length;
+	memcpy(entry->address, address,
+	       is_ipv6 ? VPP_IP6_ADDRESS_LEN : VPP_IP4_ADDRESS_LEN);
+	entry->n_paths = count;
+	entry->paths = (sc_fib_path_t *)(uintptr_t)dump->n_paths;
+
+	for (i = 0; i < count; i++)
+	{
+		sc_fib_path_t *path = &dump->paths[dump->n_paths++];
+		path->sw_if_index = fib_paths[i].sw_if_index;
+		path->weight = fib_paths[i].weight;
+		memcpy(path->next_hop, fib_paths[i].next_hop, VPP_IP6_ADDRESS_LEN);
+	}
+
+	return 0;
+}
+
+static vapi_error_e
+sc_ip_fib_dump_cb(struct vapi_ctx_s *ctx, void *callback_ctx,
+		  vapi_error_e rv, bool is_last,
+		  vapi_payload_ip_fib_details *reply)
+{
+	if (is_last)
+		return VAPI_OK;
+
+	if (fib_dump_add(callback_ctx, false, reply->table_id,
+			 reply->address_length, reply->address, reply->count,
+			 reply->path) != 0)
+		return VAPI_ENOMEM;
+
+	return VAPI_OK;
+}
+
+static vapi_error_e
+sc_ip6_fib_dump_cb(struct vapi_ctx_s *ctx, void *callback_ctx,
+		   vapi_error_e rv, bool is_last,
+		   vapi_payload_ip6_fib_details *reply)
+{
+	if (is_last)
+		return VAPI_OK;
+
+	if (fib_dump_add(callback_ctx, true, reply->table_id,
+			 reply->address_length, reply->address, reply->count,
+			 reply->path) != 0)
+		return VAPI_ENOMEM;
+
+	return VAPI_OK;
+}
+
+static inline void *route_slot(size_t pos)
+{
+	return (void *)(uintptr_t)(pos + 1);
+}
+
+/* called with the write lock held */
+static sc_fib_route_t *route_find(sc_fib_table_t *table, const u8 *address,
+				  u8 address_length)
+{
+	uintptr_t slot = (uintptr_t)sc_radix_exact(&table->index, address,
+						   address_length);
+
+	return slot ? &table->routes[slot - 1] : NULL;
+}
+
+/*
+ * Called with the write lock held. The route is only valid until the next
+ * route is added or removed, the array may move.
+ */
+static sc_fib_route_t *route_get(bool is_ipv6, const u8 *address,
+				  u8 address_length)
+{
+	sc_fib_table_t *table = &g_fib.tables[is_ipv6];
+	sc_fib_route_t *route = route_find(table, address, address_length);
+
+	if (route != NULL)
+		return route;
+
+	if (table->n_routes == table->routes_cap)
+	{
+		size_t cap = table->routes_cap ? table->routes_cap * 2 : SC_FIB_INIT_CAPACITY;
+		sc_fib_route_t *routes = realloc(table->routes, cap * sizeof(*routes));
+		if (routes == NULL)
+			return NULL;
+		table->routes = routes;
+		table->routes_cap = cap;
+	}
+
+	if (sc_radix_insert(&table->index, address, address_length,
+			    route_slot(table->n_routes), NULL) != 0)
+		return NULL;
+
+	route = &table->routes[table->n_routes++];
+	memset(route, 0, sizeof(*route));
+	route->is_ipv6 = is_ipv6;
+	route->address_length = address_length;
+	memcpy(route->address, address,
+	       is_ipv6 ? VPP_IP6_ADDRESS_LEN : VPP_IP4_ADDRESS_LEN);
+
+	return route;
+}
+
+/* called with the write lock held, the last route takes the freed slot */
+static void route_remove(sc_fib_table_t *table, size_t pos)
+{
+	sc_fib_route_t *route = &table->routes[pos];
+	size_t last = table->n_routes - 1;
+
+	sc_radix_remove(&table->index, route->address, route->address_length);
+	free(route->paths);
+
+	if (pos != last)
+	{
+		*route = table->routes[last];
+		/* the prefix is in the trie already, this cannot allocate */
+		sc_radix_insert(&table->index, route->address,
+				route->address_length, route_slot(pos), NULL);
+	}
+	table->n_routes--;
+}
+
+/* called with the write lock held */
+static int route_set_paths(sc_fib_route_t *route, const sc_fib_path_t *paths,
+			   u32 n_paths)
+{
+	sc_fib_path_t *copy = NULL;
+
+	if (n_paths > 0)
+	{
+		copy = malloc(n_paths * sizeof(*copy));
+		if (copy == NULL)
+			return -1;
+		memcpy(copy, paths, n_paths * sizeof(*copy));
+	}
+	free(route->paths);
+	route->paths = copy;
+	route->n_paths = n_paths;
+
+	return 0;
+}
+
+/* merge a complete dump of both families, called with the write lock held */
+static int fib_merge(sc_fib_dump_t *dump)
+{
+	size_t i;
+	int af;
+
+	g_fib.generation++;
+	for (i = 0; i < dump->n_entries; i++)
+	{
+		const sc_fib_route_t *entry = &dump->entries[i];
+		sc_fib_route_t *route = route_get(entry->is_ipv6, entry->address,
+						  entry->address_length);
+
+		if (route == NULL)
+			return -1;
+
+		/* the same prefix in several tables, keep the lowest table id */
+		if (route->generation == g_fib.generation &&
+		    route->table_id <= entry->table_id)
+			continue;
+
+		if (route_set_paths(route, &dump->paths[(uintptr_t)entry->paths],
+				    entry->n_paths) != 0)
+			return -1;
+		route->table_id = entry->table_id;
+		route->generation = g_fib.generation;
+	}
+
+	/*
+	 * Drop the routes VPP no longer has. Going backwards, the route moved
+	 * into a freed slot has already been checked.
+	 */
+	for (af = 0; af < 2; af++)
+	{
+		sc_fib_table_t *table = &g_fib.tables[af];
+
+		for (i = table->n_routes; i-- > 0;)
+		{
+			if (table->routes[i].generation != g_fib.generation)
+				route_remove(table, i);
+		}
+	}
+
+	return 0;
+}
+
+static int sc_fib_refresh(void *arg, void **result)
+{
+	sc_fib_dump_t dump = { 0 };
+	vapi_msg_ip_fib_dump *mp;
+	vapi_msg_ip6_fib_dump *mp6;
+	vapi_error_e rv;
+	int rc = -1;
+
+	/* both families in one pass, they are merged under a single lock */
+	mp = vapi_alloc_ip_fib_dump(g_vapi_ctx_instance);
+	while (VAPI_EAGAIN ==
+	       (rv = vapi_ip_fib_dump(g_vapi_ctx_instance, mp, sc_ip_fib_dump_cb,
+				      &dump)));
+	if (VAPI_OK != rv)
+	{
+		SC_LOG_ERR("ip_fib_dump failed, with return %d", rv);
+		goto done;
+	}
+
+	mp6 = vapi_alloc_ip6_fib_dump(g_vapi_ctx_instance);
+	while (VAPI_EAGAIN ==
+	       (rv = vapi_ip6_fib_dump(g_vapi_ctx_instance, mp6,
+				       sc_ip6_fib_dump_cb, &dump)));
+	if (VAPI_OK != rv)
+	{
+		SC_LOG_ERR("ip6_fib_dump failed, with return %d", rv);
+		goto done;
+	}
+
+	pthread_rwlock_wrlock(&g_fib.lock);
+	rc = fib_merge(&dump);
+	if (rc == 0)
+		g_fib.refreshed_ms = g_fib.dumped_ms = now_ms();
+	pthread_rwlock_unlock(&g_fib.lock);
+	SC_LOG_DBG("FIB dumps returned %zu entries", dump.n_entries);
+
+done:
+	free(dump.entries);
+	free(dump.paths);
+	return rc;
+}
+
+static int fib_read_lock(u32 pinned)
+{
+	sc_singleflight_call_t *call = NULL;
+	u64 refreshed_ms;
+	int rc = 0;
+
+	pthread_rwlock_rdlock(&g_fib.lock);
+	refreshed_ms = g_fib.refreshed_ms;
+	if (refreshed_ms != 0 &&
+	    ((pinned != 0 && pinned == g_fib.generation) ||
+	     now_ms() - refreshed_ms < SC_FIB_REFRESH_MS))
+		return 0;
+	pthread_rwlock_unlock(&g_fib.lock);
+
+	/* concurrent readers of an expired cache share one dump */
+	rc = sc_singleflight_do(SC_FIB_DUMP_KEY, sc_fib_refresh, NULL, NULL, &call);
+	sc_singleflight_release(call);
+
+	pthread_rwlock_rdlock(&g_fib.lock);
+	if (rc != 0)
+	{
+		/* an older dump beats no answer, fail only without one */
+		if (g_fib.dumped_ms == 0)
+		{
+			pthread_rwlock_unlock(&g_fib.lock);
+			return -1;
+		}
+		SC_LOG_WRN("FIB refresh failed, serving the dump of %llu ms ago",
+			   (unsigned long long)(now_ms() - g_fib.dumped_ms));
+	}
+	return 0;
+}
+
+int sc_fib_read_lock()
+{
+	return fib_read_lock(0);
+}
+
+int sc_fib_read_lock_pinned(u32 *generation)
+{
+	if (fib_read_lock(*generation) != 0)
+		return -1;
+
+	*generation = g_fib.generation;
+	return 0;
+}
+
+void sc_fib_read_unlock()
+{
+	pthread_rwlock_unlock(&g_fib.lock);
+}
+
+const sc_fib_route_t *sc_fib_lookup(bool is_ipv6,
+				    const u8 address[VPP_IP6_ADDRESS_LEN],
+				    u8 address_length)
+{
+	const sc_fib_table_t *table = &g_fib.tables[is_ipv6];
+	uintptr_t slot = (uintptr_t)sc_radix_exact(&table->index, address,
+						   address_length);
+
+	return slot ? &table->routes[slot - 1] : NULL;
+}
+
+const sc_fib_route_t *sc_fib_longest_match(bool is_ipv6,
+					   const u8 address[VPP_IP6_ADDRESS_LEN],
+					   u8 address_length)
+{
+	const sc_fib_table_t *table = &g_fib.tables[is_ipv6];
+	uintptr_t slot = (uintptr_t)sc_radix_longest(&table->index, address,
+						     address_length, NULL);
+
+	return slot ? &table->routes[slot - 1] : NULL;
+}
+
+int sc_fib_route_add(bool is_ipv6, const u8 address[VPP_IP6_ADDRESS_LEN],
+		     u8 address_length, const sc_fib_path_t *path)
+{
+	sc_fib_route_t *route;
+	sc_fib_path_t *paths;
+	int rc = -1;
+
+	pthread_rwlock_wrlock(&g_fib.lock);
+	route = route_get(is_ipv6, address, address_length);
+	if (route != NULL)
+	{
+		paths = realloc(route->paths, (route->n_paths + 1) * sizeof(*paths));
+		if (paths != NULL)
+		{
+			paths[route->n_paths++] = *path;
+			route->paths = paths;
+			route->generation = g_fib.generation;
+			rc = 0;
+		}
+	}
+	pthread_rwlock_unlock(&g_fib.lock);
+
+	return rc;
+}
+
+static bool path_match(const sc_fib_path_t *a, const sc_fib_path_t *b)
+{
+	static const u8 unset[VPP_IP6_ADDRESS_LEN] = { 0 };
+
+	if (memcmp(b->next_hop, unset, sizeof(unset)) != 0)
+		return memcmp(a->next_hop, b->next_hop, sizeof(a->next_hop)) == 0;
+
+	return a->sw_if_index == b->sw_if_index;
+}
+
+int sc_fib_route_del(bool is_ipv6, const u8 address[VPP_IP6_ADDRESS_LEN],
+		     u8 address_length, const sc_fib_path_t *path)
+{
+	sc_fib_table_t *table = &g_fib.tables[is_ipv6];
+	sc_fib_route_t *route;
+	u32 i;
+	int rc = -1;
+
+	pthread_rwlock_wrlock(&g_fib.lock);
+	route = route_find(table, address, address_length);
+	for (i = 0; route != NULL && i < route->n_paths; i++)
+	{
+		if (path_match(&route->paths[i], path))
+		{
+			route->paths[i] = route->paths[--route->n_paths];
+			rc = 0;
+			break;
+		}
+	}
+	if (route != NULL && route->n_paths == 0)
+		route_remove(table, route - table->routes);
+	pthread_rwlock_unlock(&g_fib.lock);
+
+	return rc;
+}
+
+void sc_fib_invalidate()
+{
+	pthread_rwlock_wrlock(&g_fib.lock);
+	g_fib.refreshed_ms = 0;
+	pthread_rwlock_unlock(&g_fib.lock);
+}
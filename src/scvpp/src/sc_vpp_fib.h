@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __SWEETCOMB_VPP_FIB__
+#define __SWEETCOMB_VPP_FIB__
+
+#include <stdbool.h>
+
+#include "sc_vpp_operation.h"
+
+typedef struct
+{
+	u32 sw_if_index;
+	u32 weight;
+	u8 next_hop[VPP_IP6_ADDRESS_LEN];
+} sc_fib_path_t;
+
+typedef struct
+{
+	u32 table_id;
+	bool is_ipv6;
+	u8 address_length;
+	u8 address[VPP_IP6_ADDRESS_LEN];	/* IPv4 in the first 4 bytes */
+	u32 n_paths;
+	sc_fib_path_t *paths;
+	u32 generation;		/* last refresh that saw the route */
+} sc_fib_route_t;
+
+/*
+ * Cache of the IPv4 and IPv6 FIBs.
+ *
+ * Each address family keeps its routes in one contiguous array, indexed
+ * by a radix trie with 128-bit keys (see sc_radix.h), so reads are the
+ * same for both families. The cache is refreshed from ip_fib_dump and
+ * ip6_fib_dump together at most once per window, both dumps are merged
+ * in one pass and routes they no longer list are dropped.
+ * Routes we add or delete ourselves are applied right away, so they are
+ * visible before the next refresh.
+ *
+ * Routes are only valid between sc_fib_read_lock() and sc_fib_read_unlock().
+ */
+
+/*
+ * Refresh the cache if the window expired and take the read lock. A failed
+ * refresh leaves the last dump in use, -1 only if no dump ever succeeded.
+ */
+int sc_fib_read_lock();
+/*
+ * Same, but keeps reading the cache as long as it holds the routes of
+ * *generation, whatever their age. *generation (0 at first) is set to the
+ * generation read, so a sequence of reads sees a single dump.
+ */
+int sc_fib_read_lock_pinned(u32 *generation);
+void sc_fib_read_unlock();
+
+/* Route of the exact prefix, the one of the lowest table id if several. */
+const sc_fib_route_t *sc_fib_lookup(bool is_ipv6,
+				    const u8 address[VPP_IP6_ADDRESS_LEN],
+				    u8 address_length);
+/* Route of the longest prefix covering address/address_length. */
+const sc_fib_route_t *sc_fib_longest_match(bool is_ipv6,
+					   const u8 address[VPP_IP6_ADDRESS_LEN],
+					   u8 address_length);
+
+/* Record a path we added to VPP. */
+int sc_fib_route_add(bool is_ipv6, const u8 address[VPP_IP6_ADDRESS_LEN],
+		     u8 address_length, const sc_fib_path_t *path);
+/*
+ * Record a path we removed from VPP, matched by next hop, or by interface
+ * when the next hop is unset. The route goes away with its last path.
+ */
+int sc_fib_route_del(bool is_ipv6, const u8 address[VPP_IP6_ADDRESS_LEN],
+		     u8 address_length, const sc_fib_path_t *path);
+
+/* Refresh the whole cache on the next read. */
+void sc_fib_invalidate();
+
+#endif //__SWEETCOMB_VPP_FIB__
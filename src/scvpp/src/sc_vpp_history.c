@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "sc_vpp_history.h"
+
+static struct
+{
+	pthread_rwlock_t lock;
+	bool running;
+	sc_history_config_t config;
+	/* block[sw_if_index * depth + slot], one allocation for all rings */
+	sc_if_sample_t *block;
+	u64 *time_ms;		/* wall clock time of each slot */
+	u32 *n_ifs;		/* interfaces present in each slot */
+	u32 head;		/* next slot written */
+	u32 count;		/* slots written, up to depth */
+} g_history = {
+	.lock = PTHREAD_RWLOCK_INITIALIZER,
+};
+
+static u64 history_now_ms()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (u64)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+void sc_if_sample_fold(const sc_if_counters_t *c, sc_if_sample_t *s)
+{
+	s->rx_bytes = c->rx_bytes;
+	s->rx_packets = c->rx_packets;
+	s->tx_bytes = c->tx_bytes;
+	s->tx_packets = c->tx_packets;
+	s->drops = c->drops + c->rx_no_buf + c->rx_miss;
+	s->errors = c->rx_errors + c->tx_errors;
+}
+
+/* sampler thread, records one slot */
+static void history_record(const sc_if_stats_t *sample, void *ctx)
+{
+	u32 depth, slot, i, n;
+
+	pthread_rwlock_wrlock(&g_history.lock);
+	if (!g_history.running) {
+		pthread_rwlock_unlock(&g_history.lock);
+		return;
+	}
+
+	depth = g_history.config.depth;
+	slot = g_history.head;
+	n = sample->n_ifs < g_history.config.max_ifs ?
+		sample->n_ifs : g_history.config.max_ifs;
+	for (i = 0; i < n; i++)
+		sc_if_sample_fold(&sample->counters[i],
+				  &g_history.block[(size_t)i * depth + slot]);
+	g_history.time_ms[slot] = history_now_ms();
+	g_history.n_ifs[slot] = n;
+
+	g_history.head = (slot + 1) % depth;
+	if (g_history.count < depth)
+		g_history.count++;
+	pthread_rwlock_unlock(&g_history.lock);
+}
+
+int sc_history_start(const sc_history_config_t *config)
+{
+	sc_history_config_t defaults = {
+		.depth = SC_HISTORY_DEPTH,
+		.max_ifs = SC_HISTORY_MAX_IFS,
+	};
+	sc_if_sample_t *block;
+	u64 *time_ms;
+	u32 *n_ifs;
+
+	if (NULL == config)
+		config = &defaults;
+	if (0 == config->depth || 0 == config->max_ifs)
+		return -1;
+
+	block = calloc((size_t)config->depth * config->max_ifs, sizeof(*block));
+	time_ms = calloc(config->depth, sizeof(*time_ms));
+	n_ifs = calloc(config->depth, sizeof(*n_ifs));
+	if (NULL == block || NULL == time_ms || NULL == n_ifs) {
+		free(block);
+		free(time_ms);
+		free(n_ifs);
+		return -1;
+	}
+
+	sc_history_stop();
+
+	pthread_rwlock_wrlock(&g_history.lock);
+	g_history.config = *config;
+	g_history.block = block;
+	g_history.time_ms = time_ms;
+	g_history.n_ifs = n_ifs;
+	g_history.head = g_history.count = 0;
+	g_history.running = true;
+	pthread_rwlock_unlock(&g_history.lock);
+
+	if (0 != sc_rates_listen(history_record, NULL)) {
+		sc_history_stop();
+		return -1;
+	}
+
+	return 0;
+}
+
+void sc_history_stop()
+{
+	/* no record runs once unlisten returned */
+	sc_rates_unlisten(history_record, NULL);
+
+	pthread_rwlock_wrlock(&g_history.lock);
+	g_history.running = false;
+	free(g_history.block);
+	free(g_history.time_ms);
+	free(g_history.n_ifs);
+	g_history.block = NULL;
+	g_history.time_ms = NULL;
+	g_history.n_ifs = NULL;
+	g_history.head = g_history.count = 0;
+	pthread_rwlock_unlock(&g_history.lock);
+}
+
+int sc_history_walk(u32 sw_if_index, u64 from_ms, u64 to_ms,
+		    sc_history_walk_fn fn, void *ctx)
+{
+	const sc_if_sample_t *ring;
+	u32 depth, slot, i;
+	int rc = -1;
+
+	pthread_rwlock_rdlock(&g_history.lock);
+	if (!g_history.running || sw_if_index >= g_history.config.max_ifs)
+		goto out;
+
+	depth = g_history.config.depth;
+	ring = &g_history.block[(size_t)sw_if_index * depth];
+	rc = 0;
+	/* oldest slot first, the ring is full once count reached depth */
+	slot = (g_history.head + depth - g_history.count) % depth;
+	for (i = 0; i < g_history.count && 0 == rc;
+	     i++, slot = (slot + 1) % depth) {
+		if (g_history.time_ms[slot] < from_ms)
+			continue;
+		if (g_history.time_ms[slot] > to_ms)
+			break;
+		if (sw_if_index < g_history.n_ifs[slot])
+			rc = fn(g_history.time_ms[slot], &ring[slot], ctx);
+	}
+
+out:
+	pthread_rwlock_unlock(&g_history.lock);
+	return rc;
+}
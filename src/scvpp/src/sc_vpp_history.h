@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __SWEETCOMB_VPP_HISTORY__
+#define __SWEETCOMB_VPP_HISTORY__
+
+#include "sc_vpp_rates.h"
+
+/* Counters of one interface kept in the history. */
+typedef struct
+{
+	u64 rx_bytes;
+	u64 rx_packets;
+	u64 tx_bytes;
+	u64 tx_packets;
+	u64 drops;
+	u64 errors;		/* rx and tx */
+} sc_if_sample_t;
+
+/* Fold the counters of an interface into a sample. */
+void sc_if_sample_fold(const sc_if_counters_t *c, sc_if_sample_t *s);
+
+typedef struct
+{
+	u32 depth;		/* samples kept per interface */
+	u32 max_ifs;		/* interfaces with sw_if_index below are kept */
+} sc_history_config_t;
+
+/* the last 15 minutes at the default sample interval */
+#define SC_HISTORY_DEPTH 900
+#define SC_HISTORY_MAX_IFS 256
+
+/*
+ * Ring buffers of timestamped counter samples, fed by the rates sampler.
+ *
+ * All rings live in one block allocated at start, depth samples for each
+ * of max_ifs interfaces, so the memory used is fixed whatever the traffic
+ * or the number of queries. Every sample of the sampler is recorded, the
+ * resolution is its interval. The rings of an interface are contiguous
+ * and share one timestamp per slot with the other interfaces.
+ */
+
+/* Allocate the rings and start recording, config NULL for the defaults. */
+int sc_history_start(const sc_history_config_t *config);
+/* Stop recording and free the rings, the history is lost. */
+void sc_history_stop();
+
+typedef int (*sc_history_walk_fn)(u64 time_ms, const sc_if_sample_t *sample,
+				  void *ctx);
+
+/*
+ * Walk the samples of an interface taken between from_ms and to_ms, in
+ * milliseconds since the epoch, oldest first. The walk stops at the first
+ * non-zero return of fn, which must not call back into the history, and
+ * returns it. -1 when the interface is not recorded.
+ */
+int sc_history_walk(u32 sw_if_index, u64 from_ms, u64 to_ms,
+		    sc_history_walk_fn fn, void *ctx);
+
+#endif //__SWEETCOMB_VPP_HISTORY__
@@ -55,6 +55,41 @@ int sc_disconnect_vpp()
 	return 0;
 }
 
+int sc_connect_vpp_private(const char *name, vapi_ctx_t *ctx)
+{
+	return sc_connect_vpp_queue(name, RESPONSE_QUEUE_SIZE, ctx);
+}
+
+int sc_connect_vpp_queue(const char *name, int queue_size, vapi_ctx_t *ctx)
+{
+	vapi_error_e rv;
+
+	rv = vapi_ctx_alloc(ctx);
+	if (rv != VAPI_OK)
+		return -1;
+
+	rv = vapi_connect(*ctx, name, NULL, MAX_OUTSTANDING_REQUESTS, queue_size, VAPI_MODE_BLOCKING, true);
+	if (rv != VAPI_OK)
+	{
+		SC_LOG_ERR("*connect %s faild,with return %d", name, rv);
+		vapi_ctx_free(*ctx);
+		*ctx = NULL;
+		return -1;
+	}
+	SC_LOG_DBG("*connected %s ok", name);
+
+	return 0;
+}
+
+void sc_disconnect_vpp_private(vapi_ctx_t ctx)
+{
+	if (NULL != ctx)
+	{
+		vapi_disconnect(ctx);
+		vapi_ctx_free(ctx);
+	}
+}
+
 int sc_end_with(const char* str, const char* end)
 {
 	if (str != NULL && end != NULL)
@@ -45,14 +45,18 @@ DEFINE_VAPI_MSG_IDS_VPE_API_JSON;
 
 #ifndef SC_NOLOG
 #define SC_LOG_DBG SRP_LOG_DBG
+#define SC_LOG_WRN SRP_LOG_WRN
 #define SC_LOG_ERR SRP_LOG_ERR
 #define SC_LOG_DBG_MSG SRP_LOG_DBG_MSG
+#define SC_LOG_WRN_MSG SRP_LOG_WRN_MSG
 #define SC_LOG_ERR_MSG SRP_LOG_ERR_MSG
 #else
 #define SC_LOG_DBG //printf
 #define SC_LOG_DBG //SRP_LOG_DBG
+#define SC_LOG_WRN //SRP_LOG_WRN
 #define SC_LOG_ERR //SRP_LOG_ERR
 #define SC_LOG_DBG_MSG //SRP_LOG_DBG_MSG
+#define SC_LOG_WRN_MSG //SRP_LOG_WRN_MSG
 #define SC_LOG_ERR_MSG //SRP_LOG_ERR_MSG
 #endif
 
@@ -95,6 +99,14 @@ do { \
 //VPP接口
 int sc_connect_vpp();
 int sc_disconnect_vpp();
+/*
+ * Connection of its own for a background thread, requests on
+ * g_vapi_ctx_instance are not serialized. -1 on failure.
+ */
+int sc_connect_vpp_private(const char *name, vapi_ctx_t *ctx);
+/* Same, with room for queue_size replies not read yet. */
+int sc_connect_vpp_queue(const char *name, int queue_size, vapi_ctx_t *ctx);
+void sc_disconnect_vpp_private(vapi_ctx_t ctx);
 int sc_end_with(const char* str, const char* end);
 extern vapi_ctx_t g_vapi_ctx_instance;
 #endif //__SWEETCOMB_VPP_OPERATION__
@@ -0,0 +1,322 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "sc_vpp_rates.h"
+
+static struct
+{
+	pthread_mutex_t lock;	/* config and thread life cycle */
+	pthread_cond_t wakeup;
+	pthread_t thread;
+	bool running;
+	bool stop;
+	bool reconfigured;	/* wakes the sampler up before its deadline */
+	sc_rates_config_t config;
+
+	pthread_rwlock_t rates_lock;
+	sc_if_rates_t *rates;	/* indexed by sw_if_index */
+	u32 n_rates;
+
+	pthread_mutex_t listeners_lock;
+	struct
+	{
+		sc_rates_sample_fn fn;
+		void *ctx;
+	} listeners[SC_RATES_LISTENERS_MAX];
+	u32 n_listeners;
+
+	/* only touched by the sampler thread */
+	sc_if_stats_t samples[2];
+	u32 current;		/* index of the last read in samples */
+	bool have_previous;
+} g_rates = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.rates_lock = PTHREAD_RWLOCK_INITIALIZER,
+	.listeners_lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static int rates_config_check(const sc_rates_config_t *config)
+{
+	if (0 == config->interval_ms || 0 == config->average_ms)
+		return -1;
+
+	return 0;
+}
+
+/* called with rates_lock held for writing */
+static int rates_reserve(u32 n_ifs)
+{
+	sc_if_rates_t *rates;
+
+	if (n_ifs <= g_rates.n_rates)
+		return 0;
+
+	rates = realloc(g_rates.rates, n_ifs * sizeof(*rates));
+	if (NULL == rates)
+		return -1;
+	memset(&rates[g_rates.n_rates], 0,
+	       (n_ifs - g_rates.n_rates) * sizeof(*rates));
+	g_rates.rates = rates;
+	g_rates.n_rates = n_ifs;
+
+	return 0;
+}
+
+static f64 rate(u64 now, u64 before, f64 dt)
+{
+	return (f64)(now - before) / dt;
+}
+
+static void rates_update(sc_if_rates_t *r, const sc_if_counters_t *now,
+			 const sc_if_counters_t *before, f64 dt, f64 alpha,
+			 u64 timestamp_ns)
+{
+	if (now->rx_bytes < before->rx_bytes ||
+	    now->tx_bytes < before->tx_bytes ||
+	    now->rx_packets < before->rx_packets ||
+	    now->tx_packets < before->tx_packets) {
+		/* counters cleared, start over from this sample */
+		memset(r, 0, sizeof(*r));
+		return;
+	}
+
+	r->rx_bps = 8 * rate(now->rx_bytes, before->rx_bytes, dt);
+	r->rx_pps = rate(now->rx_packets, before->rx_packets, dt);
+	r->tx_bps = 8 * rate(now->tx_bytes, before->tx_bytes, dt);
+	r->tx_pps = rate(now->tx_packets, before->tx_packets, dt);
+
+	if (0 == r->updated_ns) {
+		r->rx_bps_avg = r->rx_bps;
+		r->rx_pps_avg = r->rx_pps;
+		r->tx_bps_avg = r->tx_bps;
+		r->tx_pps_avg = r->tx_pps;
+	} else {
+		r->rx_bps_avg += alpha * (r->rx_bps - r->rx_bps_avg);
+		r->rx_pps_avg += alpha * (r->rx_pps - r->rx_pps_avg);
+		r->tx_bps_avg += alpha * (r->tx_bps - r->tx_bps_avg);
+		r->tx_pps_avg += alpha * (r->tx_pps - r->tx_pps_avg);
+	}
+	r->updated_ns = timestamp_ns;
+}
+
+/* Read the counters once and fold them into the rates, sampler thread only. */
+static void rates_sample(u32 average_ms)
+{
+	sc_if_stats_t *now = &g_rates.samples[g_rates.current ^ 1];
+	const sc_if_stats_t *before = &g_rates.samples[g_rates.current];
+	f64 dt, alpha;
+	u32 i, n;
+
+	if (0 != sc_stats_if_read(now)) {
+		/* the next good read only becomes the new reference */
+		g_rates.have_previous = false;
+		return;
+	}
+	g_rates.current ^= 1;
+
+	pthread_mutex_lock(&g_rates.listeners_lock);
+	for (i = 0; i < g_rates.n_listeners; i++)
+		g_rates.listeners[i].fn(now, g_rates.listeners[i].ctx);
+	pthread_mutex_unlock(&g_rates.listeners_lock);
+
+	if (!g_rates.have_previous) {
+		g_rates.have_previous = true;
+		return;
+	}
+
+	dt = (now->timestamp_ns - before->timestamp_ns) / 1e9;
+	if (dt <= 0)
+		return;
+	/* weight of the new sample for an average over average_ms */
+	alpha = 1 - exp(-dt * 1000 / average_ms);
+
+	n = now->n_ifs < before->n_ifs ? now->n_ifs : before->n_ifs;
+	pthread_rwlock_wrlock(&g_rates.rates_lock);
+	if (0 == rates_reserve(now->n_ifs)) {
+		for (i = 0; i < n; i++)
+			rates_update(&g_rates.rates[i], &now->counters[i],
+				     &before->counters[i], dt, alpha,
+				     now->timestamp_ns);
+	}
+	pthread_rwlock_unlock(&g_rates.rates_lock);
+}
+
+static void *rates_thread(void *arg)
+{
+	sc_rates_config_t config;
+	struct timespec deadline;
+
+	pthread_mutex_lock(&g_rates.lock);
+	while (!g_rates.stop) {
+		config = g_rates.config;
+		pthread_mutex_unlock(&g_rates.lock);
+
+		rates_sample(config.average_ms);
+
+		clock_gettime(CLOCK_MONOTONIC, &deadline);
+		deadline.tv_sec += config.interval_ms / 1000;
+		deadline.tv_nsec += (config.interval_ms % 1000) * 1000000L;
+		if (deadline.tv_nsec >= 1000000000L) {
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000L;
+		}
+
+		pthread_mutex_lock(&g_rates.lock);
+		while (!g_rates.stop && !g_rates.reconfigured &&
+		       0 == pthread_cond_timedwait(&g_rates.wakeup,
+						   &g_rates.lock, &deadline))
+			;
+		g_rates.reconfigured = false;
+	}
+	pthread_mutex_unlock(&g_rates.lock);
+
+	return NULL;
+}
+
+int sc_rates_start(const sc_rates_config_t *config)
+{
+	sc_rates_config_t defaults = {
+		.interval_ms = SC_RATES_INTERVAL_MS,
+		.average_ms = SC_RATES_AVERAGE_MS,
+	};
+	pthread_condattr_t attr;
+	int rc = 0;
+
+	if (NULL == config)
+		config = &defaults;
+	if (0 != rates_config_check(config))
+		return -1;
+
+	pthread_mutex_lock(&g_rates.lock);
+	if (g_rates.running)
+		goto out;
+
+	/* deadlines are computed on the monotonic clock */
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&g_rates.wakeup, &attr);
+	pthread_condattr_destroy(&attr);
+
+	g_rates.config = *config;
+	g_rates.stop = false;
+	g_rates.reconfigured = false;
+	g_rates.have_previous = false;
+	if (0 != pthread_create(&g_rates.thread, NULL, rates_thread, NULL)) {
+		SC_LOG_ERR_MSG("failed to start the interface rates sampler");
+		pthread_cond_destroy(&g_rates.wakeup);
+		rc = -1;
+		goto out;
+	}
+	g_rates.running = true;
+
+out:
+	pthread_mutex_unlock(&g_rates.lock);
+	return rc;
+}
+
+int sc_rates_configure(const sc_rates_config_t *config)
+{
+	if (0 != rates_config_check(config))
+		return -1;
+
+	pthread_mutex_lock(&g_rates.lock);
+	g_rates.config = *config;
+	if (g_rates.running) {
+		g_rates.reconfigured = true;
+		pthread_cond_signal(&g_rates.wakeup);
+	}
+	pthread_mutex_unlock(&g_rates.lock);
+
+	return 0;
+}
+
+void sc_rates_stop()
+{
+	pthread_mutex_lock(&g_rates.lock);
+	if (!g_rates.running) {
+		pthread_mutex_unlock(&g_rates.lock);
+		return;
+	}
+	g_rates.stop = true;
+	pthread_cond_signal(&g_rates.wakeup);
+	pthread_mutex_unlock(&g_rates.lock);
+
+	pthread_join(g_rates.thread, NULL);
+
+	pthread_mutex_lock(&g_rates.lock);
+	g_rates.running = false;
+	pthread_cond_destroy(&g_rates.wakeup);
+	sc_if_stats_free(&g_rates.samples[0]);
+	sc_if_stats_free(&g_rates.samples[1]);
+	pthread_mutex_unlock(&g_rates.lock);
+
+	pthread_rwlock_wrlock(&g_rates.rates_lock);
+	free(g_rates.rates);
+	g_rates.rates = NULL;
+	g_rates.n_rates = 0;
+	pthread_rwlock_unlock(&g_rates.rates_lock);
+}
+
+int sc_rates_get(u32 sw_if_index, sc_if_rates_t *rates)
+{
+	int rc = -1;
+
+	pthread_rwlock_rdlock(&g_rates.rates_lock);
+	if (sw_if_index < g_rates.n_rates &&
+	    0 != g_rates.rates[sw_if_index].updated_ns) {
+		*rates = g_rates.rates[sw_if_index];
+		rc = 0;
+	}
+	pthread_rwlock_unlock(&g_rates.rates_lock);
+
+	return rc;
+}
+
+int sc_rates_listen(sc_rates_sample_fn fn, void *ctx)
+{
+	int rc = -1;
+
+	pthread_mutex_lock(&g_rates.listeners_lock);
+	if (g_rates.n_listeners < SC_RATES_LISTENERS_MAX) {
+		g_rates.listeners[g_rates.n_listeners].fn = fn;
+		g_rates.listeners[g_rates.n_listeners].ctx = ctx;
+		g_rates.n_listeners++;
+		rc = 0;
+	}
+	pthread_mutex_unlock(&g_rates.listeners_lock);
+
+	return rc;
+}
+
+void sc_rates_unlisten(sc_rates_sample_fn fn, void *ctx)
+{
+	u32 i;
+
+	pthread_mutex_lock(&g_rates.listeners_lock);
+	for (i = 0; i < g_rates.n_listeners; i++) {
+		if (g_rates.listeners[i].fn == fn &&
+		    g_rates.listeners[i].ctx == ctx) {
+			g_rates.listeners[i] =
+				g_rates.listeners[--g_rates.n_listeners];
+			break;
+		}
+	}
+	pthread_mutex_unlock(&g_rates.listeners_lock);
+}
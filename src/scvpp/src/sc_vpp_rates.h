@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __SWEETCOMB_VPP_RATES__
+#define __SWEETCOMB_VPP_RATES__
+
+#include "sc_vpp_stats.h"
+
+/* Rates of one interface, in bits and packets per second. */
+typedef struct
+{
+	f64 rx_bps;		/* over the last sample interval */
+	f64 rx_pps;
+	f64 tx_bps;
+	f64 tx_pps;
+	f64 rx_bps_avg;		/* exponentially weighted moving average */
+	f64 rx_pps_avg;
+	f64 tx_bps_avg;
+	f64 tx_pps_avg;
+	u64 updated_ns;		/* CLOCK_MONOTONIC, 0 until two samples were read */
+} sc_if_rates_t;
+
+typedef struct
+{
+	u32 interval_ms;	/* between two counter reads */
+	u32 average_ms;		/* time constant of the moving average */
+} sc_rates_config_t;
+
+#define SC_RATES_INTERVAL_MS 1000
+#define SC_RATES_AVERAGE_MS 30000
+
+/*
+ * Background sampler of the interface counters.
+ *
+ * A single thread reads the stats segment every interval and keeps the
+ * rates of each interface in a flat array indexed by sw_if_index, so any
+ * number of readers share one read per interval. Two counter buffers are
+ * swapped between reads, nothing is allocated once the interface count
+ * is stable. A counter going backwards (cleared) restarts the rates of
+ * that interface.
+ */
+
+/* Start the sampler, config NULL for the defaults above, -1 on failure. */
+int sc_rates_start(const sc_rates_config_t *config);
+/* Apply a new configuration, effective from the next read. */
+int sc_rates_configure(const sc_rates_config_t *config);
+void sc_rates_stop();
+
+/* Copy the rates of an interface, -1 if it was not sampled twice yet. */
+int sc_rates_get(u32 sw_if_index, sc_if_rates_t *rates);
+
+/*
+ * Called by the sampler thread with every counter read, so other consumers
+ * share it instead of reading the segment themselves. sample is only
+ * valid during the call, which must not block.
+ */
+typedef void (*sc_rates_sample_fn)(const sc_if_stats_t *sample, void *ctx);
+
+#define SC_RATES_LISTENERS_MAX 8
+
+/* -1 when SC_RATES_LISTENERS_MAX listeners are registered already. */
+int sc_rates_listen(sc_rates_sample_fn fn, void *ctx);
+void sc_rates_unlisten(sc_rates_sample_fn fn, void *ctx);
+
+#endif //__SWEETCOMB_VPP_RATES__
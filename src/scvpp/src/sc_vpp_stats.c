@@ -0,0 +1,444 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "sc_vpp_stats.h"
+
+#include <vpp-api/client/stat_client.h>
+
+#ifndef STAT_SEGMENT_SOCKET_FILE
+#define STAT_SEGMENT_SOCKET_FILE "/run/vpp/stats.sock"
+#endif
+
+#define SC_STATS_NO_FIELD ((size_t)-1)
+
+/* Directory entries read together, looked up once by name patterns. */
+typedef struct
+{
+	const char *const *patterns;	/* NULL terminated */
+	u32 *indexes;
+} sc_stats_dir_t;
+
+static const char *const sc_stats_if_patterns[] = { "^/if/", NULL };
+static const char *const sc_stats_runtime_patterns[] = {
+	"^/sys/", "^/buffer-pools/", NULL
+};
+
+/* Graph node counters, vectors indexed by thread then node index. */
+static const struct
+{
+	const char *name;
+	size_t field;		/* offset in sc_node_counters_t */
+} sc_stats_node_counters[] = {
+	{ "/sys/node/calls", offsetof(sc_node_counters_t, calls) },
+	{ "/sys/node/vectors", offsetof(sc_node_counters_t, vectors) },
+	{ "/sys/node/suspends", offsetof(sc_node_counters_t, suspends) },
+	{ "/sys/node/clocks", offsetof(sc_node_counters_t, clocks) },
+};
+
+#define SC_STATS_NODE_COUNTERS \
+	(sizeof(sc_stats_node_counters) / sizeof(sc_stats_node_counters[0]))
+
+/* Interface counters of the stats segment and where they are summed. */
+static const struct
+{
+	const char *name;
+	size_t packets;		/* offset in sc_if_counters_t */
+	size_t bytes;		/* combined counters only */
+} sc_stats_if_counters[] = {
+	{ "/if/rx", offsetof(sc_if_counters_t, rx_packets),
+	  offsetof(sc_if_counters_t, rx_bytes) },
+	{ "/if/rx-unicast", offsetof(sc_if_counters_t, rx_unicast_packets),
+	  SC_STATS_NO_FIELD },
+	{ "/if/rx-multicast", offsetof(sc_if_counters_t, rx_multicast_packets),
+	  SC_STATS_NO_FIELD },
+	{ "/if/rx-broadcast", offsetof(sc_if_counters_t, rx_broadcast_packets),
+	  SC_STATS_NO_FIELD },
+	{ "/if/tx", offsetof(sc_if_counters_t, tx_packets),
+	  offsetof(sc_if_counters_t, tx_bytes) },
+	{ "/if/tx-unicast-miss", offsetof(sc_if_counters_t, tx_unicast_packets),
+	  SC_STATS_NO_FIELD },
+	{ "/if/tx-multicast", offsetof(sc_if_counters_t, tx_multicast_packets),
+	  SC_STATS_NO_FIELD },
+	{ "/if/tx-broadcast", offsetof(sc_if_counters_t, tx_broadcast_packets),
+	  SC_STATS_NO_FIELD },
+	{ "/if/drops", offsetof(sc_if_counters_t, drops), SC_STATS_NO_FIELD },
+	{ "/if/rx-no-buf", offsetof(sc_if_counters_t, rx_no_buf),
+	  SC_STATS_NO_FIELD },
+	{ "/if/rx-miss", offsetof(sc_if_counters_t, rx_miss),
+	  SC_STATS_NO_FIELD },
+	{ "/if/rx-error", offsetof(sc_if_counters_t, rx_errors),
+	  SC_STATS_NO_FIELD },
+	{ "/if/tx-error", offsetof(sc_if_counters_t, tx_errors),
+	  SC_STATS_NO_FIELD },
+};
+
+#define SC_STATS_IF_COUNTERS \
+	(sizeof(sc_stats_if_counters) / sizeof(sc_stats_if_counters[0]))
+
+/* the stat client keeps its state in globals, one caller at a time */
+static struct
+{
+	pthread_mutex_t lock;
+	bool connected;
+	time_t connected_time;
+	sc_stats_dir_t if_dir;
+	sc_stats_dir_t runtime_dir;
+} g_stats = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.if_dir = { .patterns = sc_stats_if_patterns },
+	.runtime_dir = { .patterns = sc_stats_runtime_patterns },
+};
+
+static u64 stats_now_ns()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* called with g_stats.lock held */
+static int stats_connect(const char *socket_name)
+{
+	if (g_stats.connected)
+		return 0;
+
+	if (0 != stat_segment_connect((char *)(socket_name ? socket_name :
+					STAT_SEGMENT_SOCKET_FILE))) {
+		SC_LOG_ERR("stats segment connect to %s failed",
+			   socket_name ? socket_name : STAT_SEGMENT_SOCKET_FILE);
+		return -1;
+	}
+	g_stats.connected = true;
+	g_stats.connected_time = time(NULL);
+
+	return 0;
+}
+
+static void stats_dir_free(sc_stats_dir_t *dir)
+{
+	if (NULL != dir->indexes) {
+		stat_segment_vec_free(dir->indexes);
+		dir->indexes = NULL;
+	}
+}
+
+/* called with g_stats.lock held */
+static void stats_disconnect()
+{
+	stats_dir_free(&g_stats.if_dir);
+	stats_dir_free(&g_stats.runtime_dir);
+	if (g_stats.connected) {
+		stat_segment_disconnect();
+		g_stats.connected = false;
+	}
+}
+
+/* called with g_stats.lock held, the directory moves when VPP adds counters */
+static int stats_dir_lookup(sc_stats_dir_t *dir)
+{
+	u8 **patterns = NULL;
+	int i;
+
+	stats_dir_free(dir);
+
+	for (i = 0; NULL != dir->patterns[i]; i++)
+		patterns = stat_segment_string_vector(patterns,
+						      (char *)dir->patterns[i]);
+	dir->indexes = stat_segment_ls(patterns);
+	stat_segment_vec_free(patterns);
+
+	return NULL != dir->indexes ? 0 : -1;
+}
+
+/*
+ * Copy the entries of dir out of the segment, NULL on failure.
+ * Called with g_stats.lock held, the result is freed with
+ * stat_segment_data_free().
+ */
+static stat_segment_data_t *stats_dump(sc_stats_dir_t *dir)
+{
+	stat_segment_data_t *data = NULL;
+
+	if (0 != stats_connect(NULL))
+		return NULL;
+
+	if (NULL == dir->indexes && 0 != stats_dir_lookup(dir))
+		return NULL;
+
+	data = stat_segment_dump(dir->indexes);
+	if (NULL == data) {
+		/* VPP rebuilt the directory since the lookup, once more */
+		if (0 == stats_dir_lookup(dir))
+			data = stat_segment_dump(dir->indexes);
+		if (NULL == data) {
+			SC_LOG_ERR_MSG("stats segment dump failed");
+			/* remapped by the next read, VPP may have restarted */
+			stats_disconnect();
+		}
+	}
+
+	return data;
+}
+
+/* Grow *array to hold n zeroed elements past *len, -1 on failure. */
+static int stats_array_reserve(void **array, u32 *len, u32 *cap, u32 n,
+			       size_t size)
+{
+	void *grown;
+	u32 new_cap;
+
+	if (n <= *len)
+		return 0;
+
+	if (n > *cap) {
+		new_cap = *cap ? *cap : 16;
+		while (new_cap < n)
+			new_cap *= 2;
+		grown = realloc(*array, (size_t)new_cap * size);
+		if (NULL == grown)
+			return -1;
+		*array = grown;
+		*cap = new_cap;
+	}
+
+	memset((u8 *)*array + (size_t)*len * size, 0, (size_t)(n - *len) * size);
+	*len = n;
+
+	return 0;
+}
+
+static int stats_reserve(sc_if_stats_t *stats, u32 n_ifs)
+{
+	return stats_array_reserve((void **)&stats->counters, &stats->n_ifs,
+				   &stats->cap_ifs, n_ifs,
+				   sizeof(*stats->counters));
+}
+
+#define SC_STATS_FIELD(_counters, _offset) \
+	(*(u64 *)((u8 *)(_counters) + (_offset)))
+
+/* Sum the per-thread vectors of one counter into stats. */
+static int stats_if_sum(sc_if_stats_t *stats, const stat_segment_data_t *data,
+			size_t packets, size_t bytes)
+{
+	int n_threads, n, i, j;
+
+	if (STAT_DIR_TYPE_COUNTER_VECTOR_COMBINED == data->type) {
+		n_threads = stat_segment_vec_len(data->combined_counter_vec);
+		for (i = 0; i < n_threads; i++) {
+			const vlib_counter_t *v = data->combined_counter_vec[i];
+
+			n = stat_segment_vec_len((void *)v);
+			if (0 != stats_reserve(stats, n))
+				return -1;
+			for (j = 0; j < n; j++) {
+				SC_STATS_FIELD(&stats->counters[j], packets) +=
+					v[j].packets;
+				if (SC_STATS_NO_FIELD != bytes)
+					SC_STATS_FIELD(&stats->counters[j],
+						       bytes) += v[j].bytes;
+			}
+		}
+	} else if (STAT_DIR_TYPE_COUNTER_VECTOR_SIMPLE == data->type) {
+		n_threads = stat_segment_vec_len(data->simple_counter_vec);
+		for (i = 0; i < n_threads; i++) {
+			const counter_t *v = data->simple_counter_vec[i];
+
+			n = stat_segment_vec_len((void *)v);
+			if (0 != stats_reserve(stats, n))
+				return -1;
+			for (j = 0; j < n; j++)
+				SC_STATS_FIELD(&stats->counters[j], packets) +=
+					v[j];
+		}
+	}
+
+	return 0;
+}
+
+/* Sum the per-thread vectors of one node counter into rt. */
+static int stats_node_sum(sc_runtime_stats_t *rt, const stat_segment_data_t *data,
+			  size_t field)
+{
+	int n_threads, n, i, j;
+	u64 thread_sum;
+
+	if (STAT_DIR_TYPE_COUNTER_VECTOR_SIMPLE != data->type)
+		return 0;
+
+	n_threads = stat_segment_vec_len(data->simple_counter_vec);
+	if (0 != stats_array_reserve((void **)&rt->threads, &rt->n_threads,
+				     &rt->cap_threads, n_threads,
+				     sizeof(*rt->threads)))
+		return -1;
+
+	for (i = 0; i < n_threads; i++) {
+		const counter_t *v = data->simple_counter_vec[i];
+
+		n = stat_segment_vec_len((void *)v);
+		if (0 != stats_array_reserve((void **)&rt->nodes, &rt->n_nodes,
+					     &rt->cap_nodes, n,
+					     sizeof(*rt->nodes)))
+			return -1;
+		thread_sum = 0;
+		for (j = 0; j < n; j++) {
+			SC_STATS_FIELD(&rt->nodes[j], field) += v[j];
+			thread_sum += v[j];
+		}
+		SC_STATS_FIELD(&rt->threads[i], field) += thread_sum;
+	}
+
+	return 0;
+}
+
+static int stats_scalar_add(sc_runtime_stats_t *rt, const stat_segment_data_t *data)
+{
+	sc_stats_scalar_t *scalar;
+
+	if (0 != stats_array_reserve((void **)&rt->scalars, &rt->n_scalars,
+				     &rt->cap_scalars, rt->n_scalars + 1,
+				     sizeof(*rt->scalars)))
+		return -1;
+
+	scalar = &rt->scalars[rt->n_scalars - 1];
+	strncpy(scalar->name, data->name, sizeof(scalar->name) - 1);
+	scalar->value = data->scalar_value;
+
+	return 0;
+}
+
+int sc_stats_connect(const char *socket_name)
+{
+	int rc;
+
+	pthread_mutex_lock(&g_stats.lock);
+	rc = stats_connect(socket_name);
+	pthread_mutex_unlock(&g_stats.lock);
+
+	return rc;
+}
+
+void sc_stats_disconnect()
+{
+	pthread_mutex_lock(&g_stats.lock);
+	stats_disconnect();
+	pthread_mutex_unlock(&g_stats.lock);
+}
+
+int sc_stats_if_read(sc_if_stats_t *stats)
+{
+	stat_segment_data_t *data = NULL;
+	int rc = -1, i, n;
+	size_t k;
+
+	pthread_mutex_lock(&g_stats.lock);
+	data = stats_dump(&g_stats.if_dir);
+	if (NULL == data)
+		goto out;
+
+	stats->n_ifs = 0;
+	stats->timestamp_ns = stats_now_ns();
+	n = stat_segment_vec_len(data);
+	for (i = 0; i < n; i++) {
+		for (k = 0; k < SC_STATS_IF_COUNTERS; k++) {
+			if (0 == strcmp(data[i].name, sc_stats_if_counters[k].name))
+				break;
+		}
+		if (k < SC_STATS_IF_COUNTERS &&
+		    0 != stats_if_sum(stats, &data[i],
+				      sc_stats_if_counters[k].packets,
+				      sc_stats_if_counters[k].bytes))
+			goto out;
+	}
+	rc = 0;
+
+out:
+	if (NULL != data)
+		stat_segment_data_free(data);
+	pthread_mutex_unlock(&g_stats.lock);
+
+	return rc;
+}
+
+int sc_stats_runtime_read(sc_runtime_stats_t *rt)
+{
+	stat_segment_data_t *data = NULL;
+	int rc = -1, i, n;
+	size_t k;
+
+	pthread_mutex_lock(&g_stats.lock);
+	data = stats_dump(&g_stats.runtime_dir);
+	if (NULL == data)
+		goto out;
+
+	rt->n_scalars = rt->n_nodes = rt->n_threads = 0;
+	rt->timestamp_ns = stats_now_ns();
+	n = stat_segment_vec_len(data);
+	for (i = 0; i < n; i++) {
+		if (STAT_DIR_TYPE_SCALAR_INDEX == data[i].type) {
+			if (0 != stats_scalar_add(rt, &data[i]))
+				goto out;
+			continue;
+		}
+		for (k = 0; k < SC_STATS_NODE_COUNTERS; k++) {
+			if (0 == strcmp(data[i].name, sc_stats_node_counters[k].name))
+				break;
+		}
+		if (k < SC_STATS_NODE_COUNTERS &&
+		    0 != stats_node_sum(rt, &data[i],
+					sc_stats_node_counters[k].field))
+			goto out;
+	}
+	rc = 0;
+
+out:
+	if (NULL != data)
+		stat_segment_data_free(data);
+	pthread_mutex_unlock(&g_stats.lock);
+
+	return rc;
+}
+
+void sc_runtime_stats_free(sc_runtime_stats_t *rt)
+{
+	free(rt->scalars);
+	free(rt->nodes);
+	free(rt->threads);
+	memset(rt, 0, sizeof(*rt));
+}
+
+void sc_if_stats_free(sc_if_stats_t *stats)
+{
+	free(stats->counters);
+	stats->counters = NULL;
+	stats->n_ifs = stats->cap_ifs = 0;
+}
+
+time_t sc_stats_discontinuity_time()
+{
+	time_t t;
+
+	pthread_mutex_lock(&g_stats.lock);
+	t = g_stats.connected_time;
+	pthread_mutex_unlock(&g_stats.lock);
+
+	return t;
+}
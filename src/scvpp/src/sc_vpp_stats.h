@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2018 HUACHENTEL and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __SWEETCOMB_VPP_STATS__
+#define __SWEETCOMB_VPP_STATS__
+
+#include <time.h>
+
+#include "sc_vpp_operation.h"
+
+/* Counters of one interface, summed over the VPP threads. */
+typedef struct
+{
+	u64 rx_packets;
+	u64 rx_bytes;
+	u64 rx_unicast_packets;
+	u64 rx_multicast_packets;
+	u64 rx_broadcast_packets;
+	u64 tx_packets;
+	u64 tx_bytes;
+	u64 tx_unicast_packets;
+	u64 tx_multicast_packets;
+	u64 tx_broadcast_packets;
+	u64 drops;
+	u64 rx_no_buf;
+	u64 rx_miss;
+	u64 rx_errors;
+	u64 tx_errors;
+} sc_if_counters_t;
+
+/* Interface counters of one read, indexed by sw_if_index. */
+typedef struct
+{
+	sc_if_counters_t *counters;
+	u32 n_ifs;		/* counters[0..n_ifs) are valid */
+	u32 cap_ifs;
+	u64 timestamp_ns;	/* CLOCK_MONOTONIC time of the read */
+} sc_if_stats_t;
+
+#define SC_STATS_NAME_LEN 128
+
+/* Scalar of the stats segment, e.g. "/sys/vector_rate". */
+typedef struct
+{
+	char name[SC_STATS_NAME_LEN];
+	f64 value;
+} sc_stats_scalar_t;
+
+/* Runtime counters of a graph node, or of all the nodes of a thread. */
+typedef struct
+{
+	u64 calls;
+	u64 vectors;
+	u64 suspends;
+	u64 clocks;
+} sc_node_counters_t;
+
+/* VPP runtime statistics ("/sys/...", "/buffer-pools/...") of one read. */
+typedef struct
+{
+	sc_stats_scalar_t *scalars;
+	u32 n_scalars;
+	u32 cap_scalars;
+	sc_node_counters_t *nodes;	/* by node index, summed over threads */
+	u32 n_nodes;
+	u32 cap_nodes;
+	sc_node_counters_t *threads;	/* by thread index, summed over nodes */
+	u32 n_threads;
+	u32 cap_threads;
+	u64 timestamp_ns;	/* CLOCK_MONOTONIC time of the read */
+} sc_runtime_stats_t;
+
+/*
+ * Counters are read from the VPP stats segment, the shared memory VPP
+ * publishes them in, never through the binary API. The directory entries
+ * of the interface counters are looked up once, a read then copies the
+ * per-thread vectors and sums them. The segment is mapped on first use.
+ */
+
+/* Map the stats segment, socket_name NULL for the VPP default, -1 on failure. */
+int sc_stats_connect(const char *socket_name);
+void sc_stats_disconnect();
+
+/*
+ * Read the counters of every interface into stats, reusing its array.
+ * stats must be zeroed before the first read. -1 on failure.
+ */
+int sc_stats_if_read(sc_if_stats_t *stats);
+void sc_if_stats_free(sc_if_stats_t *stats);
+
+/*
+ * Read the scalars and graph node counters into rt, reusing its arrays.
+ * rt must be zeroed before the first read. -1 on failure.
+ */
+int sc_stats_runtime_read(sc_runtime_stats_t *rt);
+void sc_runtime_stats_free(sc_runtime_stats_t *rt);
+
+/*
+ * Wall clock time the segment was mapped. A new VPP instance means a new
+ * mapping, so counters have not restarted from zero since then.
+ */
+time_t sc_stats_discontinuity_time();
+
+#endif //__SWEETCOMB_VPP_STATS__
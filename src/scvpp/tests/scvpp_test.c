@@ -17,9 +17,15 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <setjmp.h>
+#include <pthread.h>
 #include <cmocka.h>
 
 #include "sc_vpp_operation.h"
+#include "sc_singleflight.h"
+#include "sc_snapshot.h"
+#include "sc_radix.h"
+#include "sc_refresh.h"
+#include "sc_name_index.h"
 
 
 static int
@@ -42,12 +48,275 @@ scvpp_interface_test(void **state)
   //call interface functions
 }
 
+#define SF_READERS 8
+
+static int sf_calls = 0;
+static int sf_frees = 0;
+/* callers the in-flight dump waits for before it completes */
+static unsigned int sf_expected = 1;
+
+static int
+sf_slow_dump(void *arg, void **result)
+{
+    int *value = malloc(sizeof(int));
+
+    __sync_fetch_and_add(&sf_calls, 1);
+    //keep the call in flight until every reader has joined it
+    while (sc_singleflight_callers("dump") < sf_expected)
+        usleep(1000);
+    *value = 42;
+    *result = value;
+    return 0;
+}
+
+static void
+sf_free(void *result)
+{
+    __sync_fetch_and_add(&sf_frees, 1);
+    free(result);
+}
+
+typedef struct
+{
+    int rc;
+    int value;
+} sf_outcome_t;
+
+/* no cmocka assertion here, readers are not the test thread */
+static void *
+sf_reader(void *arg)
+{
+    sf_outcome_t *outcome = arg;
+    sc_singleflight_call_t *call = NULL;
+
+    outcome->rc = sc_singleflight_do("dump", sf_slow_dump, NULL, sf_free, &call);
+    outcome->value = outcome->rc == 0 ? *(int *)sc_singleflight_result(call) : -1;
+    sc_singleflight_release(call);
+    return NULL;
+}
+
+static void
+scvpp_singleflight_test(void **state)
+{
+    pthread_t readers[SF_READERS];
+    sf_outcome_t outcomes[SF_READERS];
+    int i;
+
+    sf_calls = sf_frees = 0;
+
+    /* concurrent identical requests are served by a single call */
+    sf_expected = SF_READERS;
+    for (i = 0; i < SF_READERS; i++)
+        pthread_create(&readers[i], NULL, sf_reader, &outcomes[i]);
+    for (i = 0; i < SF_READERS; i++)
+        pthread_join(readers[i], NULL);
+    for (i = 0; i < SF_READERS; i++)
+    {
+        assert_int_equal(outcomes[i].rc, 0);
+        assert_int_equal(outcomes[i].value, 42);
+    }
+    assert_int_equal(sf_calls, 1);
+    assert_int_equal(sf_frees, 1);
+    assert_int_equal(sc_singleflight_callers("dump"), 0);
+
+    /* a finished call is never reused */
+    sf_expected = 1;
+    sf_reader(&outcomes[0]);
+    assert_int_equal(outcomes[0].value, 42);
+    assert_int_equal(sf_calls, 2);
+    assert_int_equal(sf_frees, 2);
+}
+
+static int
+snap_load(void **data)
+{
+    int *value = malloc(sizeof(int));
+
+    *value = ++sf_calls;
+    *data = value;
+    return 0;
+}
+
+static void
+scvpp_snapshot_test(void **state)
+{
+    static sc_snapshot_t snap = SC_SNAPSHOT_INIT("snap", snap_load, sf_free, 60000);
+    sc_snapshot_ref_t *first, *second;
+
+    sf_calls = sf_frees = 0;
+
+    /* readers within the window share one load */
+    first = sc_snapshot_acquire(&snap);
+    second = sc_snapshot_acquire(&snap);
+    assert_int_equal(sf_calls, 1);
+    assert_ptr_equal(sc_snapshot_data(first), sc_snapshot_data(second));
+    sc_snapshot_release(second);
+
+    /* invalidation reloads, the old snapshot lives until its last reader is gone */
+    sc_snapshot_invalidate(&snap);
+    second = sc_snapshot_acquire(&snap);
+    assert_int_equal(*(int *)sc_snapshot_data(first), 1);
+    assert_int_equal(*(int *)sc_snapshot_data(second), 2);
+    assert_int_equal(sf_frees, 0);
+    sc_snapshot_release(first);
+    assert_int_equal(sf_frees, 1);
+
+    sc_snapshot_release(second);
+    sc_snapshot_invalidate(&snap);
+    assert_int_equal(sf_frees, 2);
+}
+
+static void
+scvpp_radix_test(void **state)
+{
+    const uint8_t net10[4] = { 10, 0, 0, 0 };
+    const uint8_t net10_1[4] = { 10, 1, 0, 0 };
+    const uint8_t host[4] = { 10, 1, 2, 3 };
+    const uint8_t other[4] = { 192, 168, 0, 1 };
+    sc_radix_t radix;
+    uint8_t matched = 0;
+    void *replaced = NULL;
+
+    sc_radix_init(&radix);
+    assert_int_equal(sc_radix_insert(&radix, net10, 8, "10/8", NULL), 0);
+    assert_int_equal(sc_radix_insert(&radix, net10_1, 16, "10.1/16", NULL), 0);
+    assert_int_equal(sc_radix_insert(&radix, host, 32, "host", NULL), 0);
+    assert_int_equal(sc_radix_insert(&radix, net10_1, 16, "10.1/16'", &replaced), 0);
+    assert_string_equal(replaced, "10.1/16");
+    assert_int_equal(radix.count, 3);
+
+    /* exact match only hits the stored prefix length */
+    assert_string_equal(sc_radix_exact(&radix, net10_1, 16), "10.1/16'");
+    assert_null(sc_radix_exact(&radix, net10_1, 12));
+    assert_null(sc_radix_exact(&radix, other, 32));
+
+    /* longest prefix match */
+    assert_string_equal(sc_radix_longest(&radix, host, 32, &matched), "host");
+    assert_int_equal(matched, 32);
+    assert_string_equal(sc_radix_longest(&radix, (uint8_t[]){ 10, 1, 9, 9 }, 32, &matched), "10.1/16'");
+    assert_int_equal(matched, 16);
+    assert_string_equal(sc_radix_longest(&radix, (uint8_t[]){ 10, 2, 0, 0 }, 32, NULL), "10/8");
+    assert_null(sc_radix_longest(&radix, other, 32, NULL));
+
+    /* removal falls back to the covering prefix */
+    assert_string_equal(sc_radix_remove(&radix, net10_1, 16), "10.1/16'");
+    assert_null(sc_radix_remove(&radix, net10_1, 16));
+    assert_string_equal(sc_radix_longest(&radix, (uint8_t[]){ 10, 1, 9, 9 }, 32, NULL), "10/8");
+    assert_string_equal(sc_radix_exact(&radix, host, 32), "host");
+    assert_int_equal(radix.count, 2);
+
+    sc_radix_clear(&radix, NULL);
+    assert_null(sc_radix_longest(&radix, host, 32, NULL));
+}
+
+static void
+scvpp_refresh_test(void **state)
+{
+    sc_refresh_t r;
+    uint64_t now = 0;
+    int i;
+
+    /* first refresh due right away, at the shortest period */
+    sc_refresh_init(&r, 1000, 8000, now);
+    assert_true(sc_refresh_due(&r, now));
+    assert_int_equal(r.interval_ms, 1000);
+
+    /* stable data backs off by a quarter up to max_ms */
+    sc_refresh_done(&r, now, false);
+    assert_int_equal(r.interval_ms, 1250);
+    assert_false(sc_refresh_due(&r, now + 1249));
+    assert_true(sc_refresh_due(&r, now + 1250));
+    for (i = 0; i < 20; i++) {
+        now = r.next_ms;
+        sc_refresh_done(&r, now, false);
+    }
+    assert_int_equal(r.interval_ms, 8000);
+    assert_int_equal(r.refreshes, 21);
+    assert_int_equal(r.changes, 0);
+
+    /* changes halve it down to min_ms */
+    now = r.next_ms;
+    sc_refresh_done(&r, now, true);
+    assert_int_equal(r.interval_ms, 4000);
+    for (i = 0; i < 5; i++) {
+        now = r.next_ms;
+        sc_refresh_done(&r, now, true);
+    }
+    assert_int_equal(r.interval_ms, 1000);
+    assert_int_equal(r.changes, 6);
+
+    /* a hint brings the next refresh forward, not closer than min_ms */
+    for (i = 0; i < 20; i++) {
+        now = r.next_ms;
+        sc_refresh_done(&r, now, false);
+    }
+    sc_refresh_soon(&r, now + 10);
+    assert_int_equal(r.next_ms, now + 1000);
+    sc_refresh_soon(&r, now + 5000);
+    assert_int_equal(r.next_ms, now + 1000);
+
+    /* new bounds clamp the period, max_ms is raised to min_ms */
+    sc_refresh_done(&r, now, false);
+    assert_int_equal(r.interval_ms, 8000);
+    sc_refresh_bounds(&r, 2000, 500);
+    assert_int_equal(r.min_ms, 2000);
+    assert_int_equal(r.max_ms, 2000);
+    assert_int_equal(r.interval_ms, 2000);
+    assert_int_equal(r.next_ms, now + 2000);
+}
+
+static const char *
+name_index_key(const void *ctx, unsigned int entry)
+{
+    return ((const char *const *)ctx)[entry];
+}
+
+static void
+scvpp_name_index_test(void **state)
+{
+    char names[64][16];
+    const char *keys[64];
+    sc_name_index_t index;
+    unsigned int i;
+
+    for (i = 0; i < 64; i++) {
+        snprintf(names[i], sizeof(names[i]), "eth%u", i % 48);
+        keys[i] = names[i];
+    }
+
+    sc_name_index_init(&index, name_index_key, keys);
+    assert_int_equal(sc_name_index_find(&index, "eth0"), -1);
+
+    /* grows past its first slots, the later of equal names wins */
+    for (i = 0; i < 64; i++) {
+        assert_int_equal(sc_name_index_add(&index, i), 0);
+    }
+    assert_int_equal(index.count, 48);
+    assert_int_equal(sc_name_index_find(&index, "eth3"), 51);
+    assert_int_equal(sc_name_index_find(&index, "eth47"), 47);
+    assert_int_equal(sc_name_index_find(&index, "eth48"), -1);
+
+    /* reset keeps the slots */
+    sc_name_index_reset(&index);
+    assert_int_equal(sc_name_index_find(&index, "eth3"), -1);
+    assert_int_equal(sc_name_index_add(&index, 3), 0);
+    assert_int_equal(sc_name_index_find(&index, "eth3"), 3);
+    assert_true(index.n_slots >= 128);
+
+    sc_name_index_free(&index);
+    assert_int_equal(sc_name_index_find(&index, "eth3"), -1);
+}
 
 int
 main()
 {
     const struct CMUnitTest tests[] = {
             cmocka_unit_test_setup_teardown(scvpp_interface_test, scvpp_test_setup, scvpp_test_teardown),
+            cmocka_unit_test(scvpp_singleflight_test),
+            cmocka_unit_test(scvpp_snapshot_test),
+            cmocka_unit_test(scvpp_radix_test),
+            cmocka_unit_test(scvpp_refresh_test),
+            cmocka_unit_test(scvpp_name_index_test),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);